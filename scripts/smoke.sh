@@ -12,7 +12,7 @@ rm -rf "$OUTDIR"
 mkdir -p "$OUTDIR"
 
 # Golden scenario: ambiguous cross + higher noise + wide gate, clutter off.
-EXPECTED="9c3d2602b240fd45"
+EXPECTED="d8926c3c11794ed9"
 
 GOT="$(./build/radar_tracker.exe \
   --scenario cross \
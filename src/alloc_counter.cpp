@@ -0,0 +1,63 @@
+#include "alloc_counter.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+std::atomic<uint64_t> g_count{0};
+std::atomic<uint64_t> g_bytes{0};
+
+void* counted_alloc(std::size_t n) {
+  g_count.fetch_add(1, std::memory_order_relaxed);
+  g_bytes.fetch_add(n, std::memory_order_relaxed);
+  if (void* p = std::malloc(n ? n : 1)) return p;
+  throw std::bad_alloc();
+}
+
+void* counted_alloc_aligned(std::size_t n, std::size_t align) {
+  g_count.fetch_add(1, std::memory_order_relaxed);
+  g_bytes.fetch_add(n, std::memory_order_relaxed);
+  if (n == 0) n = 1;
+#ifdef _WIN32
+  void* p = _aligned_malloc(n, align);
+#else
+  void* p = nullptr;
+  if (posix_memalign(&p, align < sizeof(void*) ? sizeof(void*) : align, n) != 0) p = nullptr;
+#endif
+  if (p) return p;
+  throw std::bad_alloc();
+}
+
+void aligned_release(void* p) {
+#ifdef _WIN32
+  _aligned_free(p);
+#else
+  std::free(p);
+#endif
+}
+} // namespace
+
+uint64_t alloc_count() { return g_count.load(std::memory_order_relaxed); }
+uint64_t alloc_bytes() { return g_bytes.load(std::memory_order_relaxed); }
+
+void* operator new(std::size_t n) { return counted_alloc(n); }
+void* operator new[](std::size_t n) { return counted_alloc(n); }
+void* operator new(std::size_t n, const std::nothrow_t&) noexcept {
+  try { return counted_alloc(n); } catch (...) { return nullptr; }
+}
+void* operator new[](std::size_t n, const std::nothrow_t&) noexcept {
+  try { return counted_alloc(n); } catch (...) { return nullptr; }
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+
+void* operator new(std::size_t n, std::align_val_t a) { return counted_alloc_aligned(n, (std::size_t)a); }
+void* operator new[](std::size_t n, std::align_val_t a) { return counted_alloc_aligned(n, (std::size_t)a); }
+void operator delete(void* p, std::align_val_t) noexcept { aligned_release(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { aligned_release(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { aligned_release(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { aligned_release(p); }
@@ -0,0 +1,8 @@
+#pragma once
+#include <cstdint>
+
+// Process-wide heap allocation counter. alloc_counter.cpp replaces the global
+// operator new/delete family; every allocation through new (and so every
+// std container growth) bumps the counter. Used by radar_bench (alloc/).
+uint64_t alloc_count();
+uint64_t alloc_bytes();
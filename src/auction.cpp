@@ -0,0 +1,193 @@
+#include "auction.h"
+#include "gate_clusters.h"
+#include "thread_pool.h"
+#include "scratch.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+void auction_min_cost(const SparseCost& g, const AuctionParams& p, bool warm,
+                      AuctionScratch& ws, std::vector<int>& row_to_col) {
+  const int n = g.rows;
+  const int m = g.cols;
+  scratch_assign(row_to_col, (size_t)n, -1);
+  ws.bids = 0;
+  if (n == 0) return;
+
+  const int num_edges = g.row_start[n];
+  double cmin = 0.0, cmax = 0.0;
+  if (num_edges > 0) {
+    cmin = cmax = g.cost[0];
+    for (int e = 1; e < num_edges; ++e) {
+      cmin = std::min(cmin, g.cost[e]);
+      cmax = std::max(cmax, g.cost[e]);
+    }
+  }
+  const double range = cmax - cmin;
+
+  // Leaving a row or column unmatched must cost more than any rearrangement
+  // of the others, so the matching keeps maximum cardinality like the
+  // Hungarian solvers.
+  const double miss_cost = cmax + (range + 1.0) * (double)(n + 1);
+
+  // Square problem so that every object ends up assigned (the plain forward
+  // auction is only optimal then). Objects are the n rows followed by one
+  // miss object per column; bidders are the m columns followed by one
+  // stand-in per row:
+  //   column j   -> row i (c_ij) for each edge, or its miss object (miss_cost)
+  //   stand-in i -> row i (miss_cost), or the miss object of any column
+  //                 adjacent to row i (0): taken when row i is matched
+  const int P = m + n;
+  std::vector<int>& start = ws.start;
+  std::vector<int>& obj = ws.obj;
+  std::vector<double>& benefit = ws.benefit;
+  scratch_assign(start, (size_t)P + 1, 0);
+  for (int e = 0; e < num_edges; ++e) start[g.col[e] + 1]++;
+  for (int j = 0; j < m; ++j) start[j + 1] += 1;
+  for (int i = 0; i < n; ++i) start[m + i + 1] = 1 + (g.row_start[i + 1] - g.row_start[i]);
+  for (int q = 0; q < P; ++q) start[q + 1] += start[q];
+  scratch_resize(obj, (size_t)start[P]);
+  scratch_resize(benefit, (size_t)start[P]);
+
+  std::vector<int>& cursor = ws.cursor;
+  scratch_reserve(cursor, (size_t)P);
+  cursor.assign(start.begin(), start.end() - 1);
+  for (int i = 0; i < n; ++i) {
+    for (int e = g.row_start[i]; e < g.row_start[i + 1]; ++e) {
+      const int j = g.col[e];
+      obj[cursor[j]] = i;
+      benefit[cursor[j]++] = -g.cost[e];
+      obj[cursor[m + i]] = n + j;
+      benefit[cursor[m + i]++] = 0.0;
+    }
+    obj[cursor[m + i]] = i;
+    benefit[cursor[m + i]++] = -miss_cost;
+  }
+  for (int j = 0; j < m; ++j) {
+    obj[cursor[j]] = n + j;
+    benefit[cursor[j]++] = -miss_cost;
+  }
+
+  const double NEG_INF = -std::numeric_limits<double>::infinity();
+  std::vector<double>& price = ws.price;
+  std::vector<int>& owner = ws.owner;
+  std::vector<int>& held = ws.held;
+  std::vector<int>& stack = ws.stack;
+  if (price.size() < (size_t)n) scratch_resize(price, (size_t)n);
+  if (!warm) std::fill(price.begin(), price.begin() + n, 0.0);
+  scratch_resize(price, (size_t)P);
+  std::fill(price.begin() + n, price.end(), 0.0);
+  scratch_resize(owner, (size_t)P);
+  scratch_resize(held, (size_t)P);
+  scratch_reserve(stack, (size_t)P);
+
+  // Epsilon-scaling: a cold start begins at the scale of the largest benefit;
+  // warm prices are assumed to be within the edge cost range of equilibrium.
+  const double eps_final = std::max(p.eps_final, 1e-12);
+  const double factor = std::max(p.eps_factor, 1.5);
+  double eps = std::max((warm ? range : miss_cost) / factor, eps_final);
+
+  for (;;) {
+    // Each phase restarts the matching but keeps the prices of the last one.
+    std::fill(owner.begin(), owner.end(), -1);
+    stack.clear();
+    for (int q = P - 1; q >= 0; --q) stack.push_back(q);
+
+    while (!stack.empty()) {
+      const int q = stack.back();
+      stack.pop_back();
+
+      // Best and second-best net value; ties keep the first one seen.
+      double best = NEG_INF, second = NEG_INF;
+      int best_obj = -1;
+      for (int k = start[q]; k < start[q + 1]; ++k) {
+        const double v = benefit[k] - price[obj[k]];
+        if (v > best) {
+          second = best;
+          best = v;
+          best_obj = obj[k];
+        } else if (v > second) {
+          second = v;
+        }
+      }
+      if (second == NEG_INF) second = best;
+
+      price[best_obj] += best - second + eps;
+      ws.bids++;
+      held[q] = best_obj;
+      const int prev = owner[best_obj];
+      owner[best_obj] = q;
+      if (prev != -1) stack.push_back(prev);
+    }
+
+    if (eps <= eps_final) break;
+    eps = std::max(eps / factor, eps_final);
+  }
+
+  for (int j = 0; j < m; ++j) {
+    if (held[j] < n) row_to_col[held[j]] = j;
+  }
+  // Only price differences matter, so rows are returned relative to the
+  // cheapest one and stay comparable between problems of different size.
+  const double base = *std::min_element(price.begin(), price.begin() + n);
+  for (int i = 0; i < n; ++i) price[i] -= base;
+}
+
+uint64_t clustered_auction(const SparseCost& g, const double* row_price, const AuctionParams& p,
+                           AssignWorkspace& ws, std::vector<int>& row_to_col,
+                           std::vector<double>& row_price_out, ThreadPool* pool) {
+  scratch_assign(row_to_col, (size_t)g.rows, -1);
+  scratch_assign(row_price_out, (size_t)g.rows, 0.0);
+
+  GateClusters& cl = ws.clusters;
+  build_gate_clusters(g, cl);
+
+  std::vector<int>& col_local = ws.col_local;
+  scratch_assign(col_local, (size_t)g.cols, -1);
+  const size_t workers = (size_t)(pool ? pool->size() : 1);
+  if (ws.sub.size() < workers) ws.sub.resize(workers);
+  if (ws.auction.size() < workers) ws.auction.resize(workers);
+  if (ws.auction_bids.size() < workers) ws.auction_bids.resize(workers);
+  std::fill(ws.auction_bids.begin(), ws.auction_bids.end(), 0);
+
+  auto solve = [&](int begin, int end, int worker) {
+    SparseCost& sc = ws.sub[worker];
+    AuctionScratch& as = ws.auction[worker];
+    for (int k = begin; k < end; ++k) {
+      const int* rows = cl.rows.data() + cl.row_start[k];
+      const int* cols = cl.cols.data() + cl.col_start[k];
+      const int nr = cl.num_rows(k);
+      const int nc = cl.num_cols(k);
+
+      for (int c = 0; c < nc; ++c) col_local[cols[c]] = c;
+
+      sc.reset(nr, nc);
+      for (int r = 0; r < nr; ++r) {
+        const int gr = rows[r];
+        for (int e = g.row_start[gr]; e < g.row_start[gr + 1]; ++e) {
+          sc.add(r, col_local[g.col[e]], g.cost[e]);
+        }
+      }
+      sc.finish();
+
+      // Rows are the auction's objects, so their prices carry over directly.
+      scratch_resize(as.price, (size_t)nr);
+      for (int r = 0; r < nr; ++r) as.price[r] = row_price ? row_price[rows[r]] : 0.0;
+
+      auction_min_cost(sc, p, row_price != nullptr, as, as.row_to_col);
+      ws.auction_bids[worker] += as.bids;
+      const std::vector<int>& a = as.row_to_col;
+      for (int r = 0; r < nr; ++r) {
+        row_price_out[rows[r]] = as.price[r];
+        if (a[r] != -1) row_to_col[rows[r]] = cols[a[r]];
+      }
+    }
+  };
+
+  if (pool) pool->parallel_for(cl.count(), 8, solve);
+  else solve(0, cl.count(), 0);
+
+  uint64_t bids = 0;
+  for (size_t w = 0; w < workers; ++w) bids += ws.auction_bids[w];
+  return bids;
+}
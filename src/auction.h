@@ -0,0 +1,49 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include "hungarian.h"
+
+class ThreadPool;
+struct AssignWorkspace;
+
+// Forward auction (Bertsekas) with epsilon-scaling.
+//
+// Columns (measurements) bid for rows (tracks) over the edges of a sparse
+// cost graph. Each row and column also has a "miss" option whose cost
+// exceeds any rearrangement, so the result has the same maximum cardinality
+// as sparse_min_cost, and the problem is made square so the auction
+// terminates with every object assigned. The result is eps-optimal: its total
+// cost is within (rows + cols) * eps_final of the optimum.
+//
+// Rows are the auction's objects, so their prices persist between scans the
+// way tracks do; clustered_auction uses them as a warm start.
+struct AuctionParams {
+  double eps_final = 1e-4;  // last epsilon of the scaling schedule
+  double eps_factor = 6.0;  // epsilon divisor between phases
+};
+
+struct AuctionScratch {
+  std::vector<double> price;  // per object: rows, then column misses
+  std::vector<int> owner;     // bidder holding each object, -1 free
+  std::vector<int> held;      // object held by each bidder
+  std::vector<int> stack;     // bidders waiting to bid
+  std::vector<int> start, obj, cursor; // bidder -> object graph (CSR)
+  std::vector<double> benefit;
+  std::vector<int> row_to_col;
+  uint64_t bids = 0;          // bids placed by the last solve
+};
+
+// Solves g. With warm = true, ws.price[0 .. rows) holds starting row prices
+// and the schedule starts at the edge cost range instead of the miss cost.
+// On return ws.price[0 .. rows) holds the final row prices, shifted so the
+// cheapest row is at 0. row_to_col[r] is the column of row r or -1.
+void auction_min_cost(const SparseCost& g, const AuctionParams& p, bool warm,
+                      AuctionScratch& ws, std::vector<int>& row_to_col);
+
+// Clustered auction over the connected components of g (see
+// clustered_min_cost). row_price[r] is row r's price from the previous solve
+// (null for a cold start); row_price_out gets the new prices. Returns the
+// total number of bids.
+uint64_t clustered_auction(const SparseCost& g, const double* row_price, const AuctionParams& p,
+                           AssignWorkspace& ws, std::vector<int>& row_to_col,
+                           std::vector<double>& row_price_out, ThreadPool* pool = nullptr);
@@ -0,0 +1,2068 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstdint>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <cstring>
+#include <thread>
+
+#include "kalman.h"
+#include "kalman_sqrt.h"
+#include "kalman_info.h"
+#include "polar.h"
+#include "tracker_nd.h"
+#include "tracker.h"
+#include "track_bank.h"
+#include "fusion.h"
+#include "hungarian.h"
+#include "sim.h"
+#include "rng.h"
+#include "checkpoint.h"
+#include "fnv1a.h"
+#include "output_hash.h"
+#include "latency_hist.h"
+#include "alloc_counter.h"
+
+// radar_bench: microbenchmarks of the tracking kernels plus end-to-end
+// scenario sweeps, reported as JSON. Every entry is one timing or quality
+// cost where lower is better, so runs can be compared against a stored
+// baseline.
+
+static bool arg_eq(const char* a, const char* b) { return std::string(a) == std::string(b); }
+static uint64_t parse_u64(const char* s) { return static_cast<uint64_t>(std::strtoull(s, nullptr, 10)); }
+static int parse_b(const char* s) { return std::atoi(s) ? 1 : 0; }
+static double parse_d(const char* s) { return std::atof(s); }
+
+using bench_clock = std::chrono::steady_clock;
+
+struct BenchResult {
+  std::string name;
+  std::string unit;   // "ns" per operation, "ms" per scan, or the unit of a cost
+  double value = 0.0; // best of the repeats
+  uint64_t iters = 0; // operations per timed repeat
+};
+
+struct BenchOptions {
+  uint64_t seed = 1;
+  bool quick = false;     // shorter timings and a smaller sweep (smoke runs)
+  std::string filter;     // substring of benchmark names to run, empty = all
+  std::string json_path;  // empty = stdout
+  std::string baseline;   // JSON from an earlier run to compare against
+  double threshold = 0.10; // relative slowdown reported as a regression
+};
+
+class BenchRunner {
+public:
+  explicit BenchRunner(const BenchOptions& opt) : opt_(opt) {}
+
+  bool enabled(const std::string& name) const {
+    return opt_.filter.empty() || name.find(opt_.filter) != std::string::npos;
+  }
+
+  // Scenario runs report several entries, run + "/" + metric, from one
+  // simulation; true if any of them passes the filter.
+  bool enabled(const std::string& run, const std::vector<std::string>& metrics) const {
+    for (const std::string& m : metrics) {
+      if (enabled(run + "/" + m)) return true;
+    }
+    return false;
+  }
+
+  // Times fn(), which performs ops operations per call. The call count is
+  // grown until one repeat lasts long enough to time; the best repeat wins.
+  template <typename Fn>
+  void run_ns(const std::string& name, uint64_t ops, Fn&& fn) {
+    if (!enabled(name)) return;
+    const double min_ms = opt_.quick ? 5.0 : 50.0;
+    const int repeats = opt_.quick ? 3 : 5;
+
+    uint64_t calls = 1;
+    for (;;) {
+      const double ms = time_calls(fn, calls);
+      if (ms >= min_ms || calls >= (1ull << 40)) break;
+      const double grow = ms > 0.0 ? std::min(100.0, 1.2 * min_ms / ms) : 100.0;
+      calls = std::max(calls + 1, (uint64_t)((double)calls * grow));
+    }
+
+    double best = 1e300;
+    for (int r = 0; r < repeats; ++r) best = std::min(best, time_calls(fn, calls));
+    add(name, "ns", best * 1e6 / (double)(calls * ops), calls * ops);
+  }
+
+  void add(const std::string& name, const std::string& unit, double value, uint64_t iters) {
+    if (!enabled(name)) return;
+    BenchResult r;
+    r.name = name;
+    r.unit = unit;
+    r.value = value;
+    r.iters = iters;
+    results_.push_back(r);
+    std::cerr << std::left << std::setw(48) << name << std::right << std::fixed
+              << std::setprecision(3) << std::setw(14) << value << " " << unit << "\n";
+  }
+
+  // Hard invariant of a benchmark run, such as two code paths that must
+  // agree. A failed check is printed and fails the whole run (exit code 3).
+  void check(const std::string& name, bool ok) {
+    if (!enabled(name) || ok) return;
+    failed_.push_back(name);
+    std::cerr << "CHECK FAILED: " << name << "\n";
+  }
+
+  const std::vector<BenchResult>& results() const { return results_; }
+  const std::vector<std::string>& failed_checks() const { return failed_; }
+  const BenchOptions& options() const { return opt_; }
+
+private:
+  BenchOptions opt_;
+  std::vector<BenchResult> results_;
+  std::vector<std::string> failed_;
+
+  template <typename Fn>
+  static double time_calls(Fn& fn, uint64_t calls) {
+    const auto t0 = bench_clock::now();
+    for (uint64_t i = 0; i < calls; ++i) fn();
+    const auto t1 = bench_clock::now();
+    return std::chrono::duration<double, std::milli>(t1 - t0).count();
+  }
+};
+
+// Keeps results observable so the timed loops are not optimized away.
+static volatile double g_sink = 0.0;
+
+static Mat4 random_spd4(Rng& rng) {
+  Mat4 A;
+  for (int r = 0; r < 4; ++r) for (int c = 0; c < 4; ++c) A(r, c) = rng.uniform(-2.0, 2.0);
+  return A * A.transpose() + Mat4::Identity();
+}
+
+static std::vector<KalmanCV2D> random_filters(Rng& rng, int n) {
+  std::vector<KalmanCV2D> kfs((size_t)n, KalmanCV2D(0.05, 1.5, 3.0));
+  for (auto& kf : kfs) {
+    for (int k = 0; k < 4; ++k) kf.x(k) = rng.uniform(-100.0, 100.0);
+    kf.P = random_spd4(rng);
+  }
+  return kfs;
+}
+
+static void bench_kalman(BenchRunner& br) {
+  const int n = 1024;
+  Rng rng(br.options().seed);
+  const std::vector<KalmanCV2D> init = random_filters(rng, n);
+  std::vector<Vec2> z((size_t)n);
+  for (int i = 0; i < n; ++i) z[i] = init[i].x.head<2>() + Vec2(rng.normal(0.0, 3.0), rng.normal(0.0, 3.0));
+
+  // Repeated predicts grow P without bound, so every call restarts from the
+  // initial covariance (a 4x4 copy, included in the timing).
+  std::vector<KalmanCV2D> kfs = init;
+  br.run_ns("kalman/predict", n, [&] {
+    for (int i = 0; i < n; ++i) {
+      kfs[i].P = init[i].P;
+      kfs[i].predict();
+    }
+    g_sink = kfs[0].P(0, 0);
+  });
+
+  br.run_ns("kalman/update", n, [&] {
+    for (int i = 0; i < n; ++i) {
+      kfs[i].x = init[i].x;
+      kfs[i].P = init[i].P;
+      kfs[i].update(z[i]);
+    }
+    g_sink = kfs[0].x(0);
+  });
+
+  const struct { CovUpdate form; const char* name; } forms[] = {
+    {CovUpdate::Standard, "kalman/update_pos/standard"},
+    {CovUpdate::Symmetric, "kalman/update_pos/symmetric"},
+    {CovUpdate::Joseph, "kalman/update_pos/joseph"},
+    {CovUpdate::SquareRoot, "kalman/update_pos/sqrt_refactor"},
+  };
+  for (const auto& f : forms) {
+    br.run_ns(f.name, n, [&] {
+      for (int i = 0; i < n; ++i) {
+        kfs[i].x = init[i].x;
+        kfs[i].P = init[i].P;
+        kfs[i].update_pos(z[i], kfs[i].innovation_cov(), f.form);
+      }
+      g_sink = kfs[0].x(0);
+    });
+  }
+
+  // Square-root form with the factor carried between calls, as the tracker
+  // keeps it; both rewrite kf.P = L L^T.
+  std::vector<Mat4> init_L((size_t)n), Ls((size_t)n);
+  for (int i = 0; i < n; ++i) cholesky4(init[i].P, init_L[i]);
+  br.run_ns("kalman/predict_sqrt", n, [&] {
+    for (int i = 0; i < n; ++i) {
+      Ls[i] = init_L[i];
+      predict_sqrt(kfs[i], Ls[i]);
+    }
+    g_sink = kfs[0].P(0, 0);
+  });
+  br.run_ns("kalman/update_pos/sqrt", n, [&] {
+    for (int i = 0; i < n; ++i) {
+      kfs[i].x = init[i].x;
+      Ls[i] = init_L[i];
+      update_pos_sqrt(kfs[i], Ls[i], z[i]);
+    }
+    g_sink = kfs[0].x(0);
+  });
+
+  // Information form: predict, and fusing four measurements then converting
+  // back to x / P (the cost of reading the estimate).
+  std::vector<InfoCV2D> init_info, infos;
+  for (int i = 0; i < n; ++i) init_info.emplace_back(init[i]);
+  infos = init_info;
+  br.run_ns("kalman/info/predict", n, [&] {
+    for (int i = 0; i < n; ++i) {
+      infos[i] = init_info[i];
+      infos[i].predict();
+    }
+    g_sink = infos[0].Y(0, 0);
+  });
+  br.run_ns("kalman/info/fuse4", n, [&] {
+    for (int i = 0; i < n; ++i) {
+      infos[i] = init_info[i];
+      const Vec2 zs[4] = {z[i], z[(i + 1) % n], z[(i + 2) % n], z[(i + 3) % n]};
+      infos[i].fuse(zs, 4, 3.0);
+      infos[i].to_kf(kfs[i]);
+    }
+    g_sink = kfs[0].x(0);
+  });
+
+  // Gating kernel: the tracker's maha2_for() is maha2() on a cached InnovCov.
+  std::vector<InnovCov> ics((size_t)n);
+  for (int i = 0; i < n; ++i) ics[i] = init[i].innovation_cov();
+  br.run_ns("kalman/maha2", n, [&] {
+    double acc = 0.0;
+    for (int i = 0; i < n; ++i) acc += maha2(ics[i], z[i] - init[i].x.head<2>());
+    g_sink = acc;
+  });
+}
+
+// Covariance forms on one long single-target stream with CV truth. "nominal"
+// is the default noise; "precise" has a sensor far better than the motion
+// noise, so P is badly conditioned and the forms start to differ. Per form:
+// ns per predict + update, how far the mean NIS over the last 10% of scans
+// is from 2 (its value when the filter is consistent), worst |P - P^T| / |P|,
+// and P's final condition number. Then fusion of several measurements of one
+// instant: sequential update_pos against one information-form fuse.
+static void bench_filter(BenchRunner& br) {
+  struct Scene {
+    const char* name;
+    double dt, sigma_a, sigma_z;
+  };
+  const Scene scenes[] = {
+    {"nominal", 0.05, 1.5, 3.0},
+    {"precise", 1.0, 100.0, 1e-6},
+  };
+  enum Form { Standard, Symmetric, Joseph, Sqrt, Info };
+  const struct { Form form; const char* name; } forms[] = {
+    {Standard, "standard"}, {Symmetric, "symmetric"}, {Joseph, "joseph"},
+    {Sqrt, "sqrt"}, {Info, "info"},
+  };
+  const std::vector<std::string> metrics = {"step", "nis_err", "max_asym", "cond"};
+  const int steps = br.options().quick ? 20000 : 200000;
+
+  for (const Scene& sc : scenes) {
+    const std::string prefix = std::string("filter/") + sc.name + "/";
+    bool wanted = false;
+    for (const auto& f : forms) wanted = wanted || br.enabled(prefix + f.name, metrics);
+    if (!wanted) continue;
+
+    // Same truth and measurements for every form.
+    Rng rng(br.options().seed);
+    std::vector<Vec4> truth((size_t)steps);
+    std::vector<Vec2> z((size_t)steps);
+    Vec4 s(0.0, 0.0, 10.0, 5.0);
+    for (int k = 0; k < steps; ++k) {
+      const double ax = rng.normal(0.0, sc.sigma_a);
+      const double ay = rng.normal(0.0, sc.sigma_a);
+      s(0) += s(2) * sc.dt + 0.5 * sc.dt * sc.dt * ax;
+      s(1) += s(3) * sc.dt + 0.5 * sc.dt * sc.dt * ay;
+      s(2) += sc.dt * ax;
+      s(3) += sc.dt * ay;
+      truth[k] = s;
+      z[k] = s.head<2>() + Vec2(rng.normal(0.0, sc.sigma_z), rng.normal(0.0, sc.sigma_z));
+    }
+
+    for (const auto& f : forms) {
+      const std::string name = prefix + f.name;
+      if (!br.enabled(name, metrics)) continue;
+      KalmanCV2D kf(sc.dt, sc.sigma_a, sc.sigma_z);
+      kf.x = truth[0];
+      kf.P = Mat4::Zero();
+      kf.P(0,0) = kf.P(1,1) = sc.sigma_z * sc.sigma_z;
+      kf.P(2,2) = kf.P(3,3) = 40.0 * 40.0;
+      Mat4 L;
+      cholesky4(kf.P, L);
+      InfoCV2D info(kf);
+
+      const int tail = steps - steps / 10;
+      double nis = 0.0;
+      double asym = 0.0;
+      double step_ns = 0.0;
+      for (int k = 1; k < steps; ++k) {
+        const auto t0 = bench_clock::now();
+        if (f.form == Sqrt) predict_sqrt(kf, L);
+        else if (f.form == Info) {
+          info.predict();
+          info.to_kf(kf);
+        } else kf.predict();
+        const InnovCov ic = kf.innovation_cov();
+        const double m2 = maha2(ic, z[k] - kf.x.head<2>());
+        if (f.form == Sqrt) update_pos_sqrt(kf, L, z[k]);
+        else if (f.form == Info) {
+          info.fuse(z[k], sc.sigma_z);
+          info.to_kf(kf);
+        } else kf.update_pos(z[k], ic, f.form == Standard ? CovUpdate::Standard
+                                       : f.form == Symmetric ? CovUpdate::Symmetric
+                                       : CovUpdate::Joseph);
+        const auto t1 = bench_clock::now();
+        step_ns += std::chrono::duration<double, std::nano>(t1 - t0).count();
+
+        if (k >= tail) nis += m2;
+        asym = std::max(asym, (kf.P - kf.P.transpose()).norm() / kf.P.norm());
+      }
+      // An indefinite P has no finite condition number.
+      const Eigen::SelfAdjointEigenSolver<Mat4> es(kf.P, Eigen::EigenvaluesOnly);
+      const double cond = es.eigenvalues()(0) > 0.0 ? es.eigenvalues()(3) / es.eigenvalues()(0)
+                                                    : std::numeric_limits<double>::max();
+
+      const uint64_t n = (uint64_t)(steps - 1);
+      br.add(name + "/step", "ns", step_ns / (double)n, n);
+      br.add(name + "/nis_err", "nis", std::abs(nis / (steps - tail) - 2.0), (uint64_t)(steps - tail));
+      br.add(name + "/max_asym", "rel", asym, n);
+      br.add(name + "/cond", "ratio", cond, n);
+    }
+  }
+
+  // n simultaneous measurements of one target (e.g. n sensors): n
+  // update_pos calls, or n information adds plus one conversion back.
+  // max_dx is the largest state difference between the two.
+  for (int n : {1, 4, 16}) {
+    const std::string run = "filter/fuse/n" + std::to_string(n);
+    if (!br.enabled(run, {"sequential", "info", "max_dx"})) continue;
+    const std::string prefix = run + "/";
+    Rng rng(br.options().seed);
+    std::vector<Vec2> zs((size_t)n);
+    for (auto& v : zs) v = Vec2(rng.normal(0.0, 3.0), rng.normal(0.0, 3.0));
+    KalmanCV2D prior(0.05, 1.5, 3.0);
+    prior.P = Mat4::Identity() * 10.0;
+    const InfoCV2D info_prior(prior);
+
+    KalmanCV2D kf = prior;
+    br.run_ns(prefix + "sequential", 1, [&] {
+      kf.x = prior.x;
+      kf.P = prior.P;
+      for (const Vec2& v : zs) kf.update_pos(v, kf.innovation_cov(), CovUpdate::Symmetric);
+      g_sink = kf.x(0);
+    });
+    KalmanCV2D kf_info = prior;
+    br.run_ns(prefix + "info", 1, [&] {
+      InfoCV2D info = info_prior;
+      info.fuse(zs.data(), n, 3.0);
+      info.to_kf(kf_info);
+      g_sink = kf_info.x(0);
+    });
+
+    kf.x = prior.x;
+    kf.P = prior.P;
+    for (const Vec2& v : zs) kf.update_pos(v, kf.innovation_cov(), CovUpdate::Symmetric);
+    InfoCV2D info = info_prior;
+    info.fuse(zs.data(), n, 3.0);
+    info.to_kf(kf_info);
+    br.add(prefix + "max_dx", "m", (kf.x - kf_info.x).cwiseAbs().maxCoeff(), 1);
+  }
+}
+
+// CV predict of N tracks: per-track KalmanCV2D::predict() over an AoS vector,
+// predict_cv_batch over a TrackBank, and the gather / batch / scatter round
+// trip (ns per track). One predict of each from the same states must agree
+// exactly, since both use the closed form on a symmetric P.
+static void bench_predict(BenchRunner& br) {
+  const int sizes[] = {10000, 100000, 1000000};
+  const double dt = 0.05, sigma_a = 1.5;
+
+  for (int n : sizes) {
+    if (br.options().quick && n > 100000) continue;
+    const std::string tag = "/t" + std::to_string(n);
+    if (!br.enabled("predict/aos" + tag) && !br.enabled("predict/soa" + tag) &&
+        !br.enabled("predict/gather_scatter" + tag) && !br.enabled("predict/soa" + tag + "/matches_aos")) {
+      continue;
+    }
+
+    Rng rng(br.options().seed);
+    const std::vector<KalmanCV2D> init = random_filters(rng, n);
+    TrackBank init_bank;
+    init_bank.resize((size_t)n);
+    for (int i = 0; i < n; ++i) init_bank.load((size_t)i, init[i]);
+
+    // Repeated calls keep predicting the same states forward; P grows, which
+    // does not change the cost of the closed form.
+    std::vector<KalmanCV2D> aos = init;
+    br.run_ns("predict/aos" + tag, (uint64_t)n, [&] {
+      for (auto& kf : aos) kf.predict();
+      g_sink = aos[0].P(0, 0);
+    });
+
+    TrackBank bank = init_bank;
+    br.run_ns("predict/soa" + tag, (uint64_t)n, [&] {
+      predict_cv_batch(bank, dt, sigma_a);
+      g_sink = bank.p00[0];
+    });
+
+    // Tracker path: gather from AoS, batched predict, scatter back.
+    std::vector<KalmanCV2D> aos2 = init;
+    TrackBank bank2;
+    br.run_ns("predict/gather_scatter" + tag, (uint64_t)n, [&] {
+      bank2.resize((size_t)n);
+      for (int i = 0; i < n; ++i) bank2.load((size_t)i, aos2[i]);
+      predict_cv_batch(bank2, dt, sigma_a);
+      for (int i = 0; i < n; ++i) bank2.store((size_t)i, aos2[i]);
+      g_sink = aos2[0].P(0, 0);
+    });
+
+    aos = init;
+    bank = init_bank;
+    for (auto& kf : aos) kf.predict();
+    predict_cv_batch(bank, dt, sigma_a);
+    bool same = true;
+    KalmanCV2D got;
+    for (int i = 0; i < n && same; ++i) {
+      bank.store((size_t)i, got);
+      same = got.x == aos[i].x;
+      for (int r = 0; r < 4; ++r) for (int c = r; c < 4; ++c) same = same && got.P(r, c) == aos[i].P(r, c);
+    }
+    br.check("predict/soa" + tag + "/matches_aos", same);
+  }
+}
+
+// Random n x n assignment problem where each cell is gated in with
+// probability density; gated-out cells are left out of the sparse graph and
+// set to BIG in the dense matrix, as the tracker does.
+static void make_problem(Rng& rng, int n, double density, std::vector<double>& dense, SparseCost& g) {
+  const double BIG = 1e9;
+  dense.assign((size_t)n * (size_t)n, BIG);
+  g.reset(n, n);
+  for (int r = 0; r < n; ++r) {
+    for (int c = 0; c < n; ++c) {
+      if (r != c && rng.uniform01() >= density) continue; // keep the diagonal: a full matching exists
+      const double w = rng.uniform(0.0, 9.21);
+      dense[(size_t)r * n + c] = w;
+      g.add(r, c, w);
+    }
+  }
+  g.finish();
+}
+
+static void bench_hungarian(BenchRunner& br) {
+  const int sizes[] = {16, 64, 256};
+  const double densities[] = {1.0, 0.25, 0.05};
+
+  for (int n : sizes) {
+    for (double density : densities) {
+      Rng rng(br.options().seed + (uint64_t)n);
+      std::vector<double> dense;
+      SparseCost g;
+      make_problem(rng, n, density, dense, g);
+
+      std::ostringstream tag;
+      tag << "/n" << n << "/d" << std::setprecision(2) << density;
+
+      HungarianScratch hws;
+      std::vector<int> out;
+      br.run_ns("hungarian/dense" + tag.str(), 1, [&] {
+        hungarian_min_cost(dense.data(), n, n, hws, out);
+        g_sink = out[0];
+      });
+
+      SparseSolverScratch sws;
+      br.run_ns("hungarian/sparse" + tag.str(), 1, [&] {
+        sparse_min_cost(g, sws, out);
+        g_sink = out[0];
+      });
+
+      AssignWorkspace aws;
+      br.run_ns("hungarian/clustered" + tag.str(), 1, [&] {
+        clustered_min_cost(g, aws, out);
+        g_sink = out[0];
+      });
+    }
+  }
+}
+
+// Benchmark scenes: static targets with about (200 m)^2 of surveillance area each.
+static double bench_area_half(int num_targets) {
+  return 100.0 * std::sqrt((double)std::max(1, num_targets));
+}
+
+static std::vector<Vec2> bench_points(Rng& rng, int n, double half) {
+  std::vector<Vec2> pts;
+  pts.reserve((size_t)std::max(0, n));
+  for (int i = 0; i < n; ++i) pts.push_back(Vec2(rng.uniform(-half, half), rng.uniform(-half, half)));
+  return pts;
+}
+
+// Noisy detections of every target plus clutter_n uniform clutter points.
+static std::vector<Vec2> bench_scan(Rng& rng, const std::vector<Vec2>& targets, int clutter_n,
+                                    double half, double sigma_z) {
+  std::vector<Vec2> z;
+  for (const auto& p : targets) z.push_back(p + Vec2(rng.normal(0.0, sigma_z), rng.normal(0.0, sigma_z)));
+  const std::vector<Vec2> clutter = bench_points(rng, clutter_n, half);
+  z.insert(z.end(), clutter.begin(), clutter.end());
+  return z;
+}
+
+static uint64_t hash_tracks(const MultiTargetTracker& trk) {
+  Fnv1a64 h;
+  for (size_t i = 0; i < trk.tracks().size(); ++i) {
+    const Track& t = trk.tracks()[i];
+    h.add_u64(trk.track_info()[i].id);
+    for (int k = 0; k < 4; ++k) {
+      uint64_t bits;
+      std::memcpy(&bits, &t.kf.x(k), sizeof(bits));
+      h.add_u64(bits);
+    }
+  }
+  return h.h;
+}
+
+// Greedy vs Hungarian association on a warmed-up tracker over a static field
+// of targets plus 50% uniform clutter. At 100 targets the clustered Hungarian
+// must match the dense solve: same number of assignments, same total cost.
+static void bench_association(BenchRunner& br) {
+  const int sizes[] = {100, 1000, 10000};
+  const double dt = 0.05, sigma_a = 1.5, sigma_z = 3.0;
+
+  for (int n : sizes) {
+    if (br.options().quick && n > 1000) continue;
+
+    Rng rng(br.options().seed);
+    const double half = bench_area_half(n);
+    const std::vector<Vec2> targets = bench_points(rng, n, half);
+    const std::vector<Vec2> z = bench_scan(rng, targets, n / 2, half, sigma_z);
+
+    int assigned[2] = {-1, -1}; // clustered, dense Hungarian
+    double cost[2] = {0.0, 0.0};
+
+    const struct { AssocMethod method; bool clustered; const char* name; } methods[] = {
+      {AssocMethod::Greedy, false, "greedy"},
+      {AssocMethod::Hungarian, true, "hungarian_clustered"},
+      {AssocMethod::Hungarian, false, "hungarian_dense"},
+      {AssocMethod::Auction, true, "auction"},
+    };
+    for (const auto& m : methods) {
+      if (!m.clustered && m.method == AssocMethod::Hungarian && n > 100) continue; // O(n^3) dense solve, seconds at 1000
+
+      TrackerConfig tcfg;
+      tcfg.assoc = m.method;
+      tcfg.cluster_assignment = m.clustered;
+      MultiTargetTracker trk(tcfg);
+      for (int s = 0; s < 4; ++s) trk.step(targets, dt, sigma_a, sigma_z);
+
+      // associate() only reads the predicted tracks, so it can be repeated.
+      br.run_ns(std::string("assoc/") + m.name + "/t" + std::to_string(n), 1, [&] {
+        const AssocResult& ar = trk.associate(z);
+        g_sink = (double)ar.track_to_meas.size();
+      });
+
+      if (m.method == AssocMethod::Hungarian) {
+        const AssocResult& ar = trk.associate(z);
+        const int k = m.clustered ? 0 : 1;
+        assigned[k] = 0;
+        for (size_t ti = 0; ti < ar.track_to_meas.size(); ++ti) {
+          if (ar.track_to_meas[ti] == -1) continue;
+          assigned[k]++;
+          cost[k] += trk.track_info()[ti].last_maha2;
+        }
+      }
+    }
+    if (assigned[1] >= 0) {
+      br.check("assoc/hungarian_clustered/t" + std::to_string(n) + "/matches_dense",
+               assigned[0] == assigned[1] && std::abs(cost[0] - cost[1]) <= 1e-9 * std::max(1.0, cost[1]));
+    }
+  }
+}
+
+// Gating: a warmed-up Greedy tracker (a dense T x M cost matrix does not fit
+// at 100k) with 1000 static targets associates scans padded with uniform
+// clutter, testing every track x measurement pair vs querying the gating
+// grid. Reports ns per associate() and the pairs evaluated; the grid only
+// prunes pairs, so the associations must be identical.
+static void bench_gating(BenchRunner& br) {
+  const int num_tracks = 1000;
+  const int meas_counts[] = {1000, 10000, 100000};
+  const double dt = 0.05, sigma_a = 1.5, sigma_z = 3.0;
+
+  Rng rng(br.options().seed);
+  const double half = bench_area_half(num_tracks);
+  const std::vector<Vec2> targets = bench_points(rng, num_tracks, half);
+
+  for (int M : meas_counts) {
+    if (br.options().quick && M > 10000) continue;
+    const std::string prefix = "gating/m" + std::to_string(M) + "/";
+    if (!br.enabled(prefix + "linear", {"associate", "pairs"}) &&
+        !br.enabled(prefix + "grid", {"associate", "pairs", "same_assoc"})) {
+      continue;
+    }
+
+    std::vector<Vec2> z(targets.begin(), targets.begin() + std::min(M, num_tracks));
+    const std::vector<Vec2> clutter = bench_points(rng, M - (int)z.size(), half);
+    z.insert(z.end(), clutter.begin(), clutter.end());
+
+    std::vector<int> linear_assoc;
+    for (int grid = 0; grid <= 1; ++grid) {
+      TrackerConfig tcfg;
+      tcfg.assoc = AssocMethod::Greedy;
+      tcfg.use_gating_grid = (grid != 0);
+      MultiTargetTracker trk(tcfg);
+      for (int s = 0; s < 4; ++s) trk.step(targets, dt, sigma_a, sigma_z);
+
+      const std::string name = prefix + (grid ? "grid" : "linear");
+      br.run_ns(name + "/associate", 1, [&] {
+        const AssocResult& ar = trk.associate(z);
+        g_sink = (double)ar.track_to_meas.size();
+      });
+      const std::vector<int> assoc = trk.associate(z).track_to_meas;
+      br.add(name + "/pairs", "pairs", (double)trk.last_pairs_evaluated(), 1);
+      if (!grid) linear_assoc = assoc;
+      else br.check(name + "/same_assoc", assoc == linear_assoc);
+    }
+  }
+}
+
+// Cartesian measurements of every scan of a TargetSim2D run.
+static std::vector<std::vector<Vec2>> sim_scans(uint64_t seed, const SimConfig& scfg) {
+  TargetSim2D sim(seed, scfg);
+  std::vector<std::vector<Vec2>> scans((size_t)scfg.steps);
+  for (auto& z : scans) {
+    sim.step();
+    for (const auto& m : sim.last_measurements()) z.push_back(m.z);
+  }
+  return scans;
+}
+
+// Optimal cost and cardinality of the last association problem of trk
+// (re-gated by brute force from its gate cache), and the same for the
+// assignment trk actually chose.
+struct AssocQuality {
+  int opt_n = 0, got_n = 0;
+  double opt_cost = 0.0, got_cost = 0.0;
+};
+
+static AssocQuality assoc_quality(const MultiTargetTracker& trk, const std::vector<Vec2>& z, double gate) {
+  const std::vector<GateCacheEntry>& gc = trk.gate_cache();
+  const AssocResult& ar = trk.last_association();
+  const int T = (int)gc.size();
+  const int M = (int)z.size();
+  auto m2_of = [&](int ti, int mi) {
+    return maha2(gc[ti].ic, Vec2(z[mi](0) - gc[ti].center(0), z[mi](1) - gc[ti].center(1)));
+  };
+
+  SparseCost g;
+  g.reset(T, M);
+  for (int ti = 0; ti < T; ++ti) {
+    for (int mi = 0; mi < M; ++mi) {
+      const double m2 = m2_of(ti, mi);
+      if (m2 <= gate) g.add(ti, mi, m2);
+    }
+  }
+  g.finish();
+  const std::vector<int> opt = clustered_min_cost(g);
+
+  AssocQuality q;
+  for (int ti = 0; ti < T; ++ti) {
+    if (opt[ti] != -1) { q.opt_n++; q.opt_cost += m2_of(ti, opt[ti]); }
+    if (ar.track_to_meas[ti] != -1) { q.got_n++; q.got_cost += m2_of(ti, ar.track_to_meas[ti]); }
+  }
+  return q;
+}
+
+// Auction vs Hungarian: the same scans through a Hungarian tracker and two
+// auction trackers (cold and warm-started prices) in lockstep. Besides the
+// step time, each scan's assignment is scored against the optimum of that
+// tracker's own problem: summed cost gap (maha2 per scan), worst single-scan
+// gap, scans that lost an assignment, and auction bids per scan. The assign
+// stage time is reported when the tracker is built with RADAR_STATS.
+static void bench_auction(BenchRunner& br) {
+  const bool quick = br.options().quick;
+  const double sigma_a = 1.5;
+  struct Scene {
+    const char* name;
+    SimConfig sim;
+    double gate_maha2;
+  };
+  Scene scenes[2];
+  scenes[0].name = "cross";
+  scenes[0].sim.scenario_cross = true;
+  scenes[0].sim.steps = quick ? 100 : 400;
+  scenes[0].sim.sigma_z = 15.0;
+  scenes[0].sim.p_detect = 1.0;
+  scenes[0].sim.enable_clutter = false;
+  scenes[0].gate_maha2 = 50.0;
+  scenes[1].name = "dense_clutter";
+  scenes[1].sim.num_targets = 60;
+  scenes[1].sim.steps = quick ? 20 : 300;
+  scenes[1].sim.clutter_per_step = 2000;
+  scenes[1].sim.clutter_area_half = 300.0;
+  scenes[1].gate_maha2 = 9.21;
+
+  const char* const solvers[3] = {"hungarian", "auction_cold", "auction_warm"};
+  const std::vector<std::string> metrics = {"step", "assign", "gap", "max_gap", "lost", "bids"};
+
+  for (const Scene& sc : scenes) {
+    // The three solvers run in lockstep, so a scene runs all or nothing.
+    const std::string prefix = std::string("auction/") + sc.name + "/";
+    bool wanted = false;
+    for (const char* solver : solvers) wanted = wanted || br.enabled(prefix + solver, metrics);
+    if (!wanted) continue;
+    const std::vector<std::vector<Vec2>> scans = sim_scans(br.options().seed, sc.sim);
+
+    struct Run {
+      const char* name;
+      std::unique_ptr<MultiTargetTracker> trk;
+      double step_us = 0.0;
+      uint64_t bids = 0;
+      double gap = 0.0;
+      double max_gap = 0.0;
+      int lost = 0;
+    };
+    Run runs[3];
+    for (int r = 0; r < 3; ++r) {
+      TrackerConfig tcfg;
+      tcfg.gate_maha2 = sc.gate_maha2;
+      tcfg.assoc = r == 0 ? AssocMethod::Hungarian : AssocMethod::Auction;
+      tcfg.auction_warm_start = (r == 2);
+      runs[r].name = solvers[r];
+      runs[r].trk = std::make_unique<MultiTargetTracker>(tcfg);
+    }
+
+    for (const auto& z : scans) {
+      for (Run& run : runs) {
+        const auto t0 = bench_clock::now();
+        run.trk->step(z, sc.sim.dt, sigma_a, sc.sim.sigma_z);
+        const auto t1 = bench_clock::now();
+        run.step_us += std::chrono::duration<double, std::micro>(t1 - t0).count();
+        run.bids += run.trk->last_auction_bids();
+        const AssocQuality q = assoc_quality(*run.trk, z, sc.gate_maha2);
+        run.gap += q.got_cost - q.opt_cost;
+        run.max_gap = std::max(run.max_gap, q.got_cost - q.opt_cost);
+        if (q.got_n < q.opt_n) run.lost++;
+      }
+    }
+
+    const uint64_t steps = (uint64_t)sc.sim.steps;
+    for (const Run& run : runs) {
+      const std::string name = prefix + run.name;
+      br.add(name + "/step", "us", run.step_us / (double)steps, steps);
+      if (TrackerStats::kEnabled) {
+        br.add(name + "/assign", "us", run.trk->stats().stage(TrackerStage::Assign).mean() * 1e-3, steps);
+      }
+      br.add(name + "/gap", "maha2", run.gap / (double)steps, steps);
+      br.add(name + "/max_gap", "maha2", run.max_gap, steps);
+      br.add(name + "/lost", "scans", run.lost, steps);
+      if (&run != &runs[0]) {
+        br.add(name + "/bids", "bids", (double)run.bids / (double)steps, steps);
+      }
+    }
+  }
+}
+
+// End-to-end: tracker.step() over pre-generated scans, no logging or
+// snapshots. Reports the mean tracker time per scan. The simulator spawns all
+// targets inside +-120 m, so target counts stay where tracks still separate.
+static void bench_scenarios(BenchRunner& br) {
+  const int targets[] = {10, 50, 200};
+  const int clutter[] = {0, 100, 1000};
+  const double p_detect[] = {0.7, 0.9, 1.0};
+  const int steps = br.options().quick ? 40 : 200;
+  const double sigma_a = 1.5;
+
+  for (int nt : targets) {
+    for (int nc : clutter) {
+      for (double pd : p_detect) {
+        std::ostringstream name;
+        name << "scenario/t" << nt << "/c" << nc << "/pd" << std::setprecision(2) << pd;
+        if (!br.enabled(name.str())) continue;
+
+        SimConfig scfg;
+        scfg.num_targets = nt;
+        scfg.steps = steps;
+        scfg.p_detect = pd;
+        scfg.enable_clutter = nc > 0;
+        scfg.clutter_per_step = nc;
+
+        TargetSim2D sim(br.options().seed, scfg);
+        std::vector<std::vector<Vec2>> scans((size_t)steps);
+        for (int s = 0; s < steps; ++s) {
+          sim.step();
+          for (const auto& m : sim.last_measurements()) scans[s].push_back(m.z);
+        }
+
+        MultiTargetTracker trk{TrackerConfig{}};
+        const auto t0 = bench_clock::now();
+        for (int s = 0; s < steps; ++s) trk.step(scans[s], scfg.dt, sigma_a, scfg.sigma_z);
+        const auto t1 = bench_clock::now();
+        g_sink = (double)trk.tracks().size();
+
+        const double ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
+        br.add(name.str(), "ms", ms / steps, (uint64_t)steps);
+      }
+    }
+  }
+}
+
+// Thread scaling: 10 scans of N static targets plus 20% clutter through a
+// tracker warmed up at 1..32 threads (ms per scan). Every thread count must
+// leave the same tracks as the serial run.
+static void bench_threads(BenchRunner& br) {
+  const int num_tracks = br.options().quick ? 1000 : 10000;
+  const int num_scans = 10;
+  const double dt = 0.05, sigma_a = 1.5, sigma_z = 3.0;
+  const int thread_counts[] = {1, 2, 4, 8, 16, 32};
+  const std::string prefix = "threads/t" + std::to_string(num_tracks) + "/";
+  bool wanted = false;
+  for (int j : thread_counts) wanted = wanted || br.enabled(prefix + "j" + std::to_string(j), {"step", "identical"});
+  if (!wanted) return;
+
+  Rng rng(br.options().seed);
+  const double half = bench_area_half(num_tracks);
+  const std::vector<Vec2> targets = bench_points(rng, num_tracks, half);
+  std::vector<std::vector<Vec2>> scans;
+  for (int s = 0; s < num_scans; ++s) scans.push_back(bench_scan(rng, targets, num_tracks / 5, half, sigma_z));
+
+  uint64_t serial_hash = 0;
+  for (int threads : thread_counts) {
+    const std::string name = prefix + "j" + std::to_string(threads);
+    if (threads > 1 && !br.enabled(name, {"step", "identical"})) continue;
+
+    TrackerConfig tcfg;
+    tcfg.num_threads = threads;
+    MultiTargetTracker trk(tcfg);
+    for (int s = 0; s < 4; ++s) trk.step(targets, dt, sigma_a, sigma_z);
+
+    const auto t0 = bench_clock::now();
+    for (const auto& z : scans) trk.step(z, dt, sigma_a, sigma_z);
+    const auto t1 = bench_clock::now();
+    const double ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
+    br.add(name + "/step", "ms", ms / num_scans, (uint64_t)num_scans);
+
+    const uint64_t h = hash_tracks(trk);
+    if (threads == 1) serial_hash = h;
+    else br.check(name + "/identical", h == serial_hash);
+  }
+}
+
+// Track layout: step time with N live tracks and the storage each one costs
+// (hot Track + cold TrackInfo, no per-track heap).
+static void bench_layout(BenchRunner& br) {
+  const int sizes[] = {10000, 100000};
+  const int num_scans = 10;
+  const double dt = 0.05, sigma_a = 1.5, sigma_z = 3.0;
+
+  for (int n : sizes) {
+    if (br.options().quick && n > 10000) continue;
+    const std::string name = "layout/t" + std::to_string(n);
+    if (!br.enabled(name, {"step", "bytes_per_track"})) continue;
+
+    Rng rng(br.options().seed);
+    const double half = bench_area_half(n);
+    const std::vector<Vec2> targets = bench_points(rng, n, half);
+    std::vector<std::vector<Vec2>> scans;
+    for (int s = 0; s < num_scans; ++s) scans.push_back(bench_scan(rng, targets, 0, half, sigma_z));
+
+    MultiTargetTracker trk{TrackerConfig{}};
+    for (int s = 0; s < 4; ++s) trk.step(targets, dt, sigma_a, sigma_z);
+
+    const auto t0 = bench_clock::now();
+    for (const auto& z : scans) trk.step(z, dt, sigma_a, sigma_z);
+    const auto t1 = bench_clock::now();
+    g_sink = (double)trk.tracks().size();
+
+    const double ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
+    br.add(name + "/step", "ms", ms / num_scans, (uint64_t)num_scans);
+    br.add(name + "/bytes_per_track", "bytes", (double)(sizeof(Track) + sizeof(TrackInfo)), 1);
+  }
+}
+
+// Track initiation: pure uniform clutter at rising density over +-2 km, so
+// nearly every measurement goes through candidate matching. Linear candidate
+// search vs the init grid (ms per scan after 3 warm-up scans); both must
+// leave the same tracks.
+static void bench_init(BenchRunner& br) {
+  const double half = 2000.0;
+  const int warm = 3;
+  const int timed = br.options().quick ? 4 : 10;
+  const double dt = 0.05, sigma_a = 1.5, sigma_z = 3.0;
+
+  for (int clutter : {250, 1000, 4000, 16000}) {
+    if (br.options().quick && clutter > 4000) continue;
+    const std::string prefix = "init/c" + std::to_string(clutter) + "/";
+    if (!br.enabled(prefix + "linear") && !br.enabled(prefix + "grid", {"step", "identical"})) continue;
+
+    Rng rng(br.options().seed);
+    std::vector<std::vector<Vec2>> scans((size_t)(warm + timed));
+    for (auto& z : scans) z = bench_points(rng, clutter, half);
+
+    uint64_t linear_hash = 0;
+    for (int grid : {0, 1}) {
+      TrackerConfig tcfg;
+      tcfg.use_init_grid = (grid != 0);
+      MultiTargetTracker trk(tcfg);
+      for (int k = 0; k < warm; ++k) trk.step(scans[k], dt, sigma_a, sigma_z);
+
+      const auto t0 = bench_clock::now();
+      for (int k = warm; k < warm + timed; ++k) trk.step(scans[k], dt, sigma_a, sigma_z);
+      const auto t1 = bench_clock::now();
+      const double ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
+
+      const std::string name = prefix + (grid ? "grid" : "linear");
+      br.add(name + "/step", "ms", ms / timed, (uint64_t)timed);
+      const uint64_t h = hash_tracks(trk);
+      if (!grid) linear_hash = h;
+      else br.check(name + "/identical", h == linear_hash);
+    }
+  }
+}
+
+// Heap allocations in steady state: sim scans with clutter, births and
+// deaths through one tracker per association method. After a warm-up of a
+// quarter of the scans, every global operator new inside step() is counted
+// (alloc_counter.h). Reports allocations per scan, the worst scan, and the
+// p50 / p99 step time.
+static void bench_alloc(BenchRunner& br) {
+  SimConfig scfg;
+  scfg.num_targets = 50;
+  scfg.clutter_per_step = 100;
+  scfg.steps = br.options().quick ? 1000 : 4000;
+  const double sigma_a = 1.5;
+  const std::vector<std::string> metrics = {"allocs_per_step", "max_step_allocs", "step_p50", "step_p99"};
+
+  const struct { AssocMethod method; const char* name; } methods[] = {
+    {AssocMethod::Greedy, "greedy"},
+    {AssocMethod::Hungarian, "hungarian"},
+    {AssocMethod::Auction, "auction"},
+  };
+  std::vector<std::vector<Vec2>> scans;
+  for (const auto& m : methods) {
+    const std::string name = std::string("alloc/") + m.name;
+    if (!br.enabled(name, metrics)) continue;
+    if (scans.empty()) scans = sim_scans(br.options().seed, scfg);
+
+    TrackerConfig tcfg;
+    tcfg.assoc = m.method;
+    MultiTargetTracker trk(tcfg);
+    const int warm = scfg.steps / 4;
+    for (int k = 0; k < warm; ++k) trk.step(scans[k], scfg.dt, sigma_a, scfg.sigma_z);
+
+    LatencyHistogram lat;
+    uint64_t steady_allocs = 0, max_step_allocs = 0;
+    for (int k = warm; k < scfg.steps; ++k) {
+      const uint64_t c0 = alloc_count();
+      const auto t0 = bench_clock::now();
+      trk.step(scans[k], scfg.dt, sigma_a, scfg.sigma_z);
+      const auto t1 = bench_clock::now();
+      const uint64_t n = alloc_count() - c0;
+      lat.record((uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+      steady_allocs += n;
+      max_step_allocs = std::max(max_step_allocs, n);
+    }
+
+    const uint64_t measured = (uint64_t)(scfg.steps - warm);
+    br.add(name + "/allocs_per_step", "allocs", (double)steady_allocs / (double)measured, measured);
+    br.add(name + "/max_step_allocs", "allocs", (double)max_step_allocs, measured);
+    br.add(name + "/step_p50", "us", lat.percentile(0.50) * 1e-3, measured);
+    br.add(name + "/step_p99", "us", lat.percentile(0.99) * 1e-3, measured);
+  }
+}
+
+// Confirmed tracks scored against truth, scan by scan: a target is covered
+// by the nearest confirmed track within radius, an id switch is a change of
+// that track's id, and a false track is a confirmed track near no target.
+struct TruthScore {
+  double radius2;
+  std::vector<uint32_t> last_id;
+  int targets = 0, covered = 0, switches = 0, false_tracks = 0;
+  double err2 = 0.0; // squared position error of covered targets
+
+  TruthScore(size_t num_targets, double radius2_) : radius2(radius2_), last_id(num_targets, 0) {}
+
+  // Any tracker with tracks() / track_info(): MultiTargetTracker, TrackerND.
+  template <typename Tracker, typename Pos>
+  void add(const Tracker& trk, const std::vector<Pos>& truth) {
+    constexpr int D = Pos::RowsAtCompileTime;
+    const auto& tr = trk.tracks();
+    for (size_t g = 0; g < truth.size(); ++g) {
+      int best = -1;
+      double best_d2 = radius2;
+      for (size_t i = 0; i < tr.size(); ++i) {
+        if (!tr[i].confirmed) continue;
+        const double d2 = (Pos(tr[i].kf.x.template head<D>()) - truth[g]).squaredNorm();
+        if (d2 <= best_d2) { best_d2 = d2; best = (int)i; }
+      }
+      targets++;
+      if (best == -1) continue;
+      covered++;
+      err2 += best_d2;
+      const uint32_t id = trk.track_info()[(size_t)best].id;
+      if (last_id[g] != 0 && last_id[g] != id) switches++;
+      last_id[g] = id;
+    }
+    for (const auto& t : tr) {
+      if (!t.confirmed) continue;
+      bool near = false;
+      for (const Pos& p : truth) near = near || (Pos(t.kf.x.template head<D>()) - p).squaredNorm() <= radius2;
+      false_tracks += near ? 0 : 1;
+    }
+  }
+
+  double coverage() const { return targets ? (double)covered / targets : 0.0; }
+  double rmse() const { return covered ? std::sqrt(err2 / covered) : 0.0; }
+};
+
+// Adds the TruthScore of a run over scans scans as lower-is-better entries:
+// the uncovered fraction of target-scans, id switches, false tracks per scan
+// and, with rmse, the position RMSE of the covered targets.
+static void add_truth_score(BenchRunner& br, const std::string& name, const TruthScore& score,
+                            uint64_t scans, bool rmse) {
+  br.add(name + "/uncovered", "frac", 1.0 - score.coverage(), scans);
+  br.add(name + "/id_switches", "count", score.switches, scans);
+  br.add(name + "/false_tracks", "tracks", (double)score.false_tracks / (double)scans, scans);
+  if (rmse) br.add(name + "/rmse", "m", score.rmse(), scans);
+}
+
+// Measurements and truth positions of every scan of a TargetSim2D run.
+static void sim_truth_scans(uint64_t seed, const SimConfig& scfg, std::vector<std::vector<Vec2>>& scans,
+                            std::vector<std::vector<Vec2>>& truth) {
+  TargetSim2D sim(seed, scfg);
+  scans.assign((size_t)scfg.steps, {});
+  truth.assign((size_t)scfg.steps, {});
+  for (size_t s = 0; s < scans.size(); ++s) {
+    sim.step();
+    for (const auto& m : sim.last_measurements()) scans[s].push_back(m.z);
+    for (const auto& t : sim.truth()) truth[s].push_back(t.pos);
+  }
+}
+
+// MHT vs single-assignment tracking on crossing targets. Every run tracks the
+// same scans and is scored against truth within 4 sigma_z (TruthScore).
+// Besides mean and worst step time: hypotheses kept and Murty augmenting
+// paths per scan.
+static void bench_mht(BenchRunner& br) {
+  const bool quick = br.options().quick;
+  const double sigma_a = 1.5;
+  struct Scene {
+    const char* name;
+    SimConfig sim;
+  };
+  Scene scenes[2];
+  scenes[0].name = "cross";
+  scenes[0].sim.scenario_cross = true;
+  scenes[0].sim.steps = quick ? 100 : 400;
+  scenes[0].sim.sigma_z = 8.0;
+  scenes[0].sim.p_detect = 0.8;
+  scenes[0].sim.clutter_per_step = 20;
+  scenes[1].name = "crossing_clutter";
+  scenes[1].sim.num_targets = 20;
+  scenes[1].sim.steps = quick ? 60 : 300;
+  scenes[1].sim.p_detect = 0.85;
+  scenes[1].sim.clutter_per_step = 60;
+
+  struct Method {
+    const char* name;
+    AssocMethod assoc;
+    int k;
+    int n_scan;
+  };
+  const Method methods[] = {
+    {"hungarian", AssocMethod::Hungarian, 1, 1},
+    {"mht_k1", AssocMethod::Mht, 1, 3},
+    {"mht_k4", AssocMethod::Mht, 4, 3},
+    {"mht_k16", AssocMethod::Mht, 16, 3},
+    {"mht_k16_n6", AssocMethod::Mht, 16, 6},
+  };
+
+  const std::vector<std::string> metrics = {"step", "max_step", "hyps", "augment", "uncovered", "id_switches", "false_tracks"};
+
+  for (const Scene& sc : scenes) {
+    const std::string prefix = std::string("mht/") + sc.name + "/";
+    bool wanted = false;
+    for (const Method& me : methods) wanted = wanted || br.enabled(prefix + me.name, metrics);
+    if (!wanted) continue;
+    std::vector<std::vector<Vec2>> scans, truth;
+    sim_truth_scans(br.options().seed, sc.sim, scans, truth);
+    const double area = 4.0 * sc.sim.clutter_area_half * sc.sim.clutter_area_half;
+    const double radius2 = 16.0 * sc.sim.sigma_z * sc.sim.sigma_z;
+
+    for (const Method& me : methods) {
+      const std::string name = prefix + me.name;
+      if (!br.enabled(name, metrics)) continue;
+      TrackerConfig tcfg;
+      tcfg.assoc = me.assoc;
+      tcfg.mht_hypotheses = me.k;
+      tcfg.mht_n_scan = me.n_scan;
+      tcfg.p_detect = sc.sim.p_detect;
+      tcfg.clutter_density = (double)sc.sim.clutter_per_step / area;
+      MultiTargetTracker trk(tcfg);
+
+      double step_us = 0.0, max_us = 0.0, hyps = 0.0, augment = 0.0;
+      TruthScore score(truth[0].size(), radius2);
+      for (size_t s = 0; s < scans.size(); ++s) {
+        const auto t0 = bench_clock::now();
+        trk.step(scans[s], sc.sim.dt, sigma_a, sc.sim.sigma_z);
+        const auto t1 = bench_clock::now();
+        const double us = std::chrono::duration<double, std::micro>(t1 - t0).count();
+        step_us += us;
+        max_us = std::max(max_us, us);
+        hyps += trk.last_mht().hypotheses;
+        augment += (double)trk.last_mht().augmentations;
+        score.add(trk, truth[s]);
+      }
+
+      const uint64_t n = (uint64_t)scans.size();
+      br.add(name + "/step", "us", step_us / (double)n, n);
+      br.add(name + "/max_step", "us", max_us, n);
+      if (me.assoc == AssocMethod::Mht) {
+        br.add(name + "/hyps", "count", hyps / (double)n, n);
+        br.add(name + "/augment", "count", augment / (double)n, n);
+      }
+      add_truth_score(br, name, score, n, false);
+    }
+  }
+}
+
+// JPDA vs hard assignment in clutter: same scans and scoring as the MHT
+// bench, plus position RMSE of the covered targets. Every method drops
+// tracks above 2 sigma_z position sigma (max_pos_sigma). "jpda" enumerates
+// clusters of up to jpda.max_exact_rows tracks, "jpda_approx" uses the
+// Fitzgerald approximation for every cluster. JPDA runs also report exact
+// and approximated clusters and enumerated events per scan.
+static void bench_jpda(BenchRunner& br) {
+  const bool quick = br.options().quick;
+  const double sigma_a = 1.5;
+  struct Scene {
+    const char* name;
+    SimConfig sim;
+  };
+  Scene scenes[3];
+  scenes[0].name = "cross";
+  scenes[0].sim.scenario_cross = true;
+  scenes[0].sim.steps = quick ? 100 : 400;
+  scenes[0].sim.sigma_z = 8.0;
+  scenes[0].sim.p_detect = 0.8;
+  scenes[0].sim.clutter_per_step = 20;
+  scenes[1].name = "crossing_clutter";
+  scenes[1].sim.num_targets = 20;
+  scenes[1].sim.steps = quick ? 60 : 300;
+  scenes[1].sim.p_detect = 0.85;
+  scenes[1].sim.clutter_per_step = 60;
+  scenes[2].name = "heavy_clutter";
+  scenes[2].sim.num_targets = 20;
+  scenes[2].sim.steps = quick ? 60 : 300;
+  scenes[2].sim.p_detect = 0.85;
+  scenes[2].sim.clutter_per_step = 400;
+
+  struct Method {
+    const char* name;
+    AssocMethod assoc;
+    int max_exact_rows;
+  };
+  const Method methods[] = {
+    {"hungarian", AssocMethod::Hungarian, 0},
+    {"mht_k4", AssocMethod::Mht, 0},
+    {"jpda", AssocMethod::Jpda, JpdaParams().max_exact_rows},
+    {"jpda_approx", AssocMethod::Jpda, 0},
+  };
+
+  const std::vector<std::string> metrics = {"step", "max_step", "exact_clusters", "approx_clusters", "events",
+                                            "uncovered", "id_switches", "false_tracks", "rmse"};
+
+  for (const Scene& sc : scenes) {
+    const std::string prefix = std::string("jpda/") + sc.name + "/";
+    bool wanted = false;
+    for (const Method& me : methods) wanted = wanted || br.enabled(prefix + me.name, metrics);
+    if (!wanted) continue;
+    std::vector<std::vector<Vec2>> scans, truth;
+    sim_truth_scans(br.options().seed, sc.sim, scans, truth);
+    const double area = 4.0 * sc.sim.clutter_area_half * sc.sim.clutter_area_half;
+    const double radius2 = 16.0 * sc.sim.sigma_z * sc.sim.sigma_z;
+
+    for (const Method& me : methods) {
+      const std::string name = prefix + me.name;
+      if (!br.enabled(name, metrics)) continue;
+      TrackerConfig tcfg;
+      tcfg.assoc = me.assoc;
+      tcfg.mht_hypotheses = 4;
+      tcfg.jpda.max_exact_rows = me.max_exact_rows;
+      tcfg.max_pos_sigma = 2.0;
+      tcfg.p_detect = sc.sim.p_detect;
+      tcfg.clutter_density = (double)sc.sim.clutter_per_step / area;
+      MultiTargetTracker trk(tcfg);
+
+      double step_us = 0.0, max_us = 0.0;
+      double exact = 0.0, approx = 0.0, events = 0.0;
+      TruthScore score(truth[0].size(), radius2);
+      for (size_t s = 0; s < scans.size(); ++s) {
+        const auto t0 = bench_clock::now();
+        trk.step(scans[s], sc.sim.dt, sigma_a, sc.sim.sigma_z);
+        const auto t1 = bench_clock::now();
+        const double us = std::chrono::duration<double, std::micro>(t1 - t0).count();
+        step_us += us;
+        max_us = std::max(max_us, us);
+        const JpdaInfo& ji = trk.last_jpda();
+        exact += ji.exact_clusters;
+        approx += ji.approx_clusters;
+        events += (double)ji.events;
+        score.add(trk, truth[s]);
+      }
+
+      const uint64_t n = (uint64_t)scans.size();
+      br.add(name + "/step", "us", step_us / (double)n, n);
+      br.add(name + "/max_step", "us", max_us, n);
+      if (me.assoc == AssocMethod::Jpda) {
+        br.add(name + "/exact_clusters", "count", exact / (double)n, n);
+        br.add(name + "/approx_clusters", "count", approx / (double)n, n);
+        br.add(name + "/events", "count", events / (double)n, n);
+      }
+      add_truth_score(br, name, score, n, true);
+    }
+  }
+}
+
+// CV vs IMM on maneuvering targets (and on the straight-line random scene,
+// where IMM should cost accuracy nothing). "cv_q10" is the usual workaround:
+// CV with enough process noise to follow the turns. Scored like the MHT
+// bench; tracks_created counts track breaks as well as clutter tracks.
+static void bench_imm(BenchRunner& br) {
+  const int steps = br.options().quick ? 100 : 400;
+  struct Scene {
+    const char* name;
+    SimConfig sim;
+  };
+  Scene scenes[2];
+  scenes[0].name = "random";
+  scenes[0].sim.num_targets = 20;
+  scenes[0].sim.steps = steps;
+  scenes[0].sim.clutter_per_step = 20;
+  scenes[1].name = "maneuver";
+  scenes[1].sim.scenario_maneuver = true;
+  scenes[1].sim.num_targets = 20;
+  scenes[1].sim.steps = steps;
+  scenes[1].sim.clutter_per_step = 20;
+
+  struct Method {
+    const char* name;
+    MotionModel motion;
+    double sigma_a;
+  };
+  const Method methods[] = {
+    {"cv", MotionModel::Cv, 1.5},
+    {"cv_q10", MotionModel::Cv, 10.0},
+    {"imm", MotionModel::Imm, 1.5},
+  };
+
+  const std::vector<std::string> metrics = {"step", "uncovered", "id_switches", "false_tracks", "rmse", "tracks_created"};
+
+  for (const Scene& sc : scenes) {
+    const std::string prefix = std::string("imm/") + sc.name + "/";
+    bool wanted = false;
+    for (const Method& me : methods) wanted = wanted || br.enabled(prefix + me.name, metrics);
+    if (!wanted) continue;
+    std::vector<std::vector<Vec2>> scans, truth;
+    sim_truth_scans(br.options().seed, sc.sim, scans, truth);
+    const double radius2 = 16.0 * sc.sim.sigma_z * sc.sim.sigma_z;
+
+    for (const Method& me : methods) {
+      const std::string name = prefix + me.name;
+      if (!br.enabled(name, metrics)) continue;
+      TrackerConfig tcfg;
+      tcfg.motion = me.motion;
+      tcfg.imm.turn_rate = sc.sim.maneuver_turn_rate;
+      MultiTargetTracker trk(tcfg);
+
+      double step_us = 0.0;
+      uint32_t max_id = 0;
+      TruthScore score(truth[0].size(), radius2);
+      for (size_t s = 0; s < scans.size(); ++s) {
+        const auto t0 = bench_clock::now();
+        trk.step(scans[s], sc.sim.dt, me.sigma_a, sc.sim.sigma_z);
+        const auto t1 = bench_clock::now();
+        step_us += std::chrono::duration<double, std::micro>(t1 - t0).count();
+        for (const auto& info : trk.track_info()) max_id = std::max(max_id, info.id);
+        score.add(trk, truth[s]);
+      }
+
+      const uint64_t n = (uint64_t)scans.size();
+      br.add(name + "/step", "us", step_us / (double)n, n);
+      add_truth_score(br, name, score, n, true);
+      br.add(name + "/tracks_created", "count", max_id, n);
+    }
+  }
+}
+
+// Asynchronous multi-sensor fusion: three radars with different rates,
+// noise and latency, some scans arriving late, over the random scene.
+// Scored like the MHT bench against truth at the tracker's own time. Per
+// method: ingest time per scan, delay (how far the tracker's time trails the
+// arrival clock on average, s), late scans dropped, and tracks created. Then
+// throughput against sensor count at a fixed total scan rate.
+static void bench_fusion(BenchRunner& br) {
+  const double dt = 0.05, sigma_a = 1.5;
+  const int steps = br.options().quick ? 300 : 1200;
+  SensorSpec radar[3];
+  radar[0].period = 0.10; radar[0].sigma_z = 3.0; radar[0].p_detect = 0.9;
+  radar[0].latency = 0.02; radar[0].late_prob = 0.10; radar[0].late_delay = 0.25;
+  radar[1].period = 0.25; radar[1].sigma_z = 1.5; radar[1].p_detect = 0.9;
+  radar[1].latency = 0.05; radar[1].late_prob = 0.20; radar[1].late_delay = 0.40;
+  radar[2].period = 0.15; radar[2].offset = 0.05; radar[2].sigma_z = 5.0; radar[2].p_detect = 0.8;
+  radar[2].latency = 0.0; radar[2].late_prob = 0.05; radar[2].late_delay = 0.30;
+  for (SensorSpec& r : radar) r.clutter_per_scan = 10;
+
+  struct Method {
+    const char* name;
+    int num_sensors; // radars 0..n-1
+    double lag;
+    double max_oosm_lag;
+    double frame; // lifecycle tick, 0 = per scan time
+  };
+  // Frames of radar 0's period, so M-of-N counts the same seconds as with
+  // radar 0 alone; "oosm_per_scan" ticks on every scan for comparison.
+  const Method methods[] = {
+    {"radar0_only", 1, 0.0, 1.0, 0.1},
+    {"drop_late", 3, 0.0, 0.0, 0.1},
+    {"lag_0.5", 3, 0.5, 0.0, 0.1},
+    {"oosm", 3, 0.0, 1.0, 0.1},
+    {"oosm_per_scan", 3, 0.0, 1.0, 0.0},
+    {"lag_0.1+oosm", 3, 0.1, 1.0, 0.1},
+  };
+
+  struct Result {
+    double us_per_scan = 0.0;
+    double delay = 0.0;
+    uint32_t tracks_created = 0;
+    FusionStats fs;
+  };
+  // One run of a sensor set through SensorFusion, scored when score != null.
+  auto run = [&](const std::vector<SensorSpec>& sensors, int targets, const FusionConfig& fc,
+                 TruthScore* score) {
+    SimConfig scfg;
+    scfg.num_targets = targets;
+    scfg.dt = dt;
+    scfg.steps = steps;
+    scfg.sensors = sensors;
+    TargetSim2D sim(br.options().seed, scfg);
+    TrackerConfig tcfg;
+    MultiTargetTracker trk(tcfg);
+    SensorFusion fusion(trk, fc);
+
+    std::vector<std::vector<Vec2>> truth((size_t)steps);
+    std::vector<Vec2> z;
+    Result res;
+    double fuse_ns = 0.0;
+    int delays = 0;
+    for (int k = 0; k < steps; ++k) {
+      sim.step();
+      for (const auto& t : sim.truth()) truth[(size_t)k].push_back(t.pos);
+      const auto t0 = bench_clock::now();
+      for (const SensorScan& sc : sim.last_scans()) {
+        z.clear();
+        for (const auto& m : sc.meas) z.push_back(m.z);
+        fusion.ingest(sc.sensor, sc.t, z, (k + 1) * dt);
+      }
+      const auto t1 = bench_clock::now();
+      fuse_ns += std::chrono::duration<double, std::nano>(t1 - t0).count();
+      for (const auto& info : trk.track_info()) res.tracks_created = std::max(res.tracks_created, info.id);
+      if (fusion.stats().in_order == 0) continue;
+      res.delay += (k + 1) * dt - fusion.time();
+      delays++;
+      if (score) score->add(trk, truth[(size_t)std::max(0L, std::lround(fusion.time() / dt) - 1)]);
+    }
+    fusion.flush();
+    g_sink = (double)trk.tracks().size();
+    res.fs = fusion.stats();
+    res.us_per_scan = res.fs.scans ? fuse_ns * 1e-3 / (double)res.fs.scans : 0.0;
+    res.delay = delays ? res.delay / delays : 0.0;
+    return res;
+  };
+
+  const std::vector<std::string> metrics = {"ingest", "delay", "dropped", "uncovered", "id_switches",
+                                            "false_tracks", "rmse", "tracks_created"};
+  for (const Method& me : methods) {
+    const std::string name = std::string("fusion/") + me.name + "/t20";
+    if (!br.enabled(name, metrics)) continue;
+    FusionConfig fc;
+    fc.lag = me.lag;
+    fc.max_oosm_lag = me.max_oosm_lag;
+    fc.frame = me.frame;
+    fc.sigma_a = sigma_a;
+    for (const SensorSpec& r : radar) fc.sensors.push_back({r.sigma_z});
+    TruthScore score(20, 16.0 * 3.0 * 3.0);
+    const Result r = run(std::vector<SensorSpec>(radar, radar + me.num_sensors), 20, fc, &score);
+    const uint64_t n = r.fs.scans;
+    br.add(name + "/ingest", "us", r.us_per_scan, n);
+    br.add(name + "/delay", "s", r.delay, n);
+    br.add(name + "/dropped", "scans", (double)(r.fs.dropped_late + r.fs.dropped_mode), n);
+    add_truth_score(br, name, score, (uint64_t)steps, true);
+    br.add(name + "/tracks_created", "count", r.tracks_created, n);
+  }
+
+  // Same 20 scans/s in total, spread over 1..16 sensors.
+  for (int n : {1, 2, 4, 8, 16}) {
+    const std::string name = "fusion/scale/s" + std::to_string(n);
+    if (!br.enabled(name, {"ingest", "per_meas"})) continue;
+    std::vector<SensorSpec> sensors((size_t)n);
+    FusionConfig fc;
+    fc.lag = 0.1;
+    fc.sigma_a = sigma_a;
+    for (int i = 0; i < n; ++i) {
+      SensorSpec& sp = sensors[(size_t)i];
+      sp.period = 0.05 * n;
+      sp.offset = 0.05 * i;
+      sp.clutter_per_scan = 10;
+      sp.latency = 0.02;
+      sp.late_prob = 0.1;
+      sp.late_delay = 0.25;
+      fc.sensors.push_back({sp.sigma_z});
+    }
+    const Result r = run(sensors, 20, fc, nullptr);
+    br.add(name + "/ingest", "us", r.us_per_scan, r.fs.scans);
+    br.add(name + "/per_meas", "ns",
+           r.fs.measurements ? r.us_per_scan * 1e3 * (double)r.fs.scans / (double)r.fs.measurements : 0.0,
+           r.fs.measurements);
+  }
+}
+
+// Polar kernels on filters around a sensor 400 m away: the per-track
+// measurement-space prediction (EKF / UKF), the per-pair gate test with and
+// without the range-rate pre-gate (clutter: random range rate in +-30 m/s),
+// and the update.
+static void bench_polar(BenchRunner& br) {
+  const int n = 1024;
+  Rng rng(br.options().seed);
+  std::vector<KalmanCV2D> init = random_filters(rng, n);
+  PolarModel model;
+  model.sensor = Vec2(0.0, -400.0);
+  std::vector<PolarMeas> z((size_t)n), clutter((size_t)n);
+  for (int i = 0; i < n; ++i) {
+    z[i] = cart_to_polar(init[i].x.head<2>(), init[i].x.tail<2>(), model.sensor);
+    z[i].range += rng.normal(0.0, model.sigma_r);
+    z[i].azimuth += rng.normal(0.0, model.sigma_az);
+    z[i].range_rate += rng.normal(0.0, model.sigma_rr);
+    clutter[i] = z[i];
+    clutter[i].range_rate = rng.uniform(-30.0, 30.0);
+  }
+
+  std::vector<PolarGate> gates((size_t)n);
+  Vec2 center, half;
+  const struct { PolarFilter filter; const char* name; } filters[] = {
+    {PolarFilter::Ekf, "polar/predict/ekf"},
+    {PolarFilter::Ukf, "polar/predict/ukf"},
+  };
+  for (const auto& f : filters) {
+    PolarModel m = model;
+    m.filter = f.filter;
+    br.run_ns(f.name, n, [&] {
+      for (int i = 0; i < n; ++i) polar_predict(init[i], m, gates[i], center, half);
+      g_sink = gates[0].S(0, 0) + center(0);
+    });
+  }
+
+  for (int i = 0; i < n; ++i) polar_predict(init[i], model, gates[i], center, half);
+  PolarModel no_doppler = model;
+  no_doppler.doppler = false;
+  br.run_ns("polar/maha2/clutter", n, [&] {
+    double acc = 0.0, m2;
+    for (int i = 0; i < n; ++i) acc += polar_maha2(gates[i], clutter[i], model, m2) ? m2 : 0.0;
+    g_sink = acc;
+  });
+  br.run_ns("polar/maha2/clutter_no_doppler", n, [&] {
+    double acc = 0.0, m2;
+    for (int i = 0; i < n; ++i) acc += polar_maha2(gates[i], clutter[i], no_doppler, m2) ? m2 : 0.0;
+    g_sink = acc;
+  });
+
+  std::vector<KalmanCV2D> kfs = init;
+  br.run_ns("polar/update", n, [&] {
+    for (int i = 0; i < n; ++i) {
+      kfs[i].x = init[i].x;
+      kfs[i].P = init[i].P;
+      polar_update(kfs[i], gates[i], z[i], model);
+    }
+    g_sink = kfs[0].x(0);
+  });
+}
+
+// Polar radar detections (range, azimuth, range rate) on two scenes: "far"
+// with the sensor well outside the target area and "near" with it at the
+// edge, where the azimuth noise is wider and the measurement function bends
+// most over a gate. Per method: step time, Mahalanobis tests and (with
+// RADAR_STATS) gated pairs per scan, and the track quality within 4 sigma_r
+// of truth. "cartesian" tracks the converted detections with fixed sigma_z;
+// the rest step_polar().
+static void bench_polar_scenes(BenchRunner& br) {
+  const double sigma_a = 1.5;
+  struct Scene {
+    const char* name;
+    SimConfig sim;
+  };
+  Scene scenes[2];
+  for (Scene& sc : scenes) {
+    sc.sim.polar = true;
+    sc.sim.num_targets = 20;
+    sc.sim.clutter_per_step = 60;
+    sc.sim.steps = br.options().quick ? 100 : 400;
+  }
+  scenes[0].name = "far";
+  scenes[1].name = "near";
+  scenes[1].sim.polar_sensor = Vec2(0.0, -150.0);
+  scenes[1].sim.sigma_az = 0.03;
+
+  struct Method {
+    const char* name;
+    bool polar;
+    PolarFilter filter;
+    bool doppler;
+  };
+  const Method methods[] = {
+    {"cartesian", false, PolarFilter::Ekf, false},
+    {"ekf_no_doppler", true, PolarFilter::Ekf, false},
+    {"ekf", true, PolarFilter::Ekf, true},
+    {"ukf", true, PolarFilter::Ukf, true},
+  };
+  const std::vector<std::string> metrics = {"step", "tests", "gated", "uncovered", "id_switches",
+                                            "false_tracks", "rmse", "tracks_created"};
+
+  for (const Scene& sc : scenes) {
+    const std::string prefix = std::string("polar/") + sc.name + "/";
+    bool wanted = false;
+    for (const Method& me : methods) wanted = wanted || br.enabled(prefix + me.name, metrics);
+    if (!wanted) continue;
+
+    TargetSim2D sim(br.options().seed, sc.sim);
+    std::vector<std::vector<PolarMeas>> scans((size_t)sc.sim.steps);
+    std::vector<std::vector<Vec2>> cart((size_t)sc.sim.steps);
+    std::vector<std::vector<Vec2>> truth((size_t)sc.sim.steps);
+    double range_sum = 0.0;
+    for (size_t s = 0; s < scans.size(); ++s) {
+      sim.step();
+      scans[s] = sim.last_polar();
+      for (const auto& m : sim.last_measurements()) cart[s].push_back(m.z);
+      for (const auto& t : sim.truth()) {
+        truth[s].push_back(t.pos);
+        range_sum += (t.pos - sc.sim.polar_sensor).norm();
+      }
+    }
+    const double mean_range = range_sum / (double)(scans.size() * truth[0].size());
+    // Converted detections: cross-range noise at the mean range.
+    const double sigma_z = std::max(sc.sim.sigma_r, mean_range * sc.sim.sigma_az);
+
+    for (const Method& me : methods) {
+      const std::string name = prefix + me.name;
+      if (!br.enabled(name, metrics)) continue;
+      TrackerConfig tcfg;
+      MultiTargetTracker trk(tcfg);
+      PolarModel model;
+      model.sensor = sc.sim.polar_sensor;
+      model.sigma_r = sc.sim.sigma_r;
+      model.sigma_az = sc.sim.sigma_az;
+      model.sigma_rr = sc.sim.sigma_rr;
+      model.filter = me.filter;
+      model.doppler = me.doppler;
+      if (!me.doppler) model.gate = 9.21;
+
+      double step_us = 0.0;
+      uint64_t pairs = 0;
+      uint32_t max_id = 0;
+      TruthScore score(truth[0].size(), 16.0 * sc.sim.sigma_r * sc.sim.sigma_r);
+      for (size_t s = 0; s < scans.size(); ++s) {
+        const auto t0 = bench_clock::now();
+        if (me.polar) trk.step_polar(scans[s], sc.sim.dt, sigma_a, model);
+        else trk.step(cart[s], sc.sim.dt, sigma_a, sigma_z);
+        const auto t1 = bench_clock::now();
+        step_us += std::chrono::duration<double, std::micro>(t1 - t0).count();
+        pairs += trk.last_pairs_evaluated();
+        for (const auto& info : trk.track_info()) max_id = std::max(max_id, info.id);
+        score.add(trk, truth[s]);
+      }
+
+      const uint64_t n = (uint64_t)scans.size();
+      br.add(name + "/step", "us", step_us / (double)n, n);
+      br.add(name + "/tests", "count", (double)pairs / (double)n, n);
+      if (TrackerStats::kEnabled) br.add(name + "/gated", "count", trk.stats().gated.mean(), n);
+      add_truth_score(br, name, score, n, true);
+      br.add(name + "/tracks_created", "count", max_id, n);
+    }
+  }
+}
+
+// A gate that wraps around the sensor: a target 15 m out, tracked with an
+// azimuth noise so wide that its gate spans more than +-90 degrees, then
+// detections behind the sensor, which are inside that gate. The gating grid
+// only prunes pairs, so step_polar() must leave the same associations and
+// tracks with the grid on and off.
+static void bench_polar_wide_gate(BenchRunner& br) {
+  const std::string name = "polar/wide_gate/grid/same_assoc";
+  if (!br.enabled(name)) return;
+  const double dt = 0.05, sigma_a = 1.5;
+  const double pi = 3.14159265358979323846;
+
+  Rng rng(br.options().seed);
+  std::vector<PolarMeas> scans(10);
+  for (size_t s = 0; s < scans.size(); ++s) {
+    const bool behind = s >= 3;
+    scans[s].range = (behind ? 25.0 : 15.0) + rng.normal(0.0, 1.0);
+    scans[s].azimuth = (behind ? pi : 0.0) + rng.normal(0.0, 0.05);
+  }
+  PolarModel model;
+  model.sigma_az = 2.0;
+  model.doppler = false;
+  model.gate = 9.21;
+
+  TrackerConfig linear_cfg;
+  linear_cfg.use_gating_grid = false;
+  TrackerConfig grid_cfg;
+  grid_cfg.use_gating_grid = true;
+  MultiTargetTracker linear(linear_cfg), grid(grid_cfg);
+  bool same = true;
+  for (const PolarMeas& z : scans) {
+    linear.step_polar({z}, dt, sigma_a, model);
+    grid.step_polar({z}, dt, sigma_a, model);
+    same = same && linear.last_association().track_to_meas == grid.last_association().track_to_meas &&
+           hash_tracks(linear) == hash_tracks(grid);
+  }
+  br.check(name, same);
+}
+
+// Templated filter kernels (kalman_nd.h) of one model on random SPD
+// covariances: predict, update and the gating maha2, per track.
+template <typename Model>
+static void bench_nd_kernels(BenchRunner& br, const std::string& tag) {
+  constexpr int N = Model::N;
+  constexpr int M = Model::M;
+  const int n = 1024;
+  Rng rng(br.options().seed);
+  std::vector<KalmanND<Model>> init((size_t)n, KalmanND<Model>(0.05, 1.5, 3.0));
+  std::vector<VecN<M>> z((size_t)n);
+  for (int i = 0; i < n; ++i) {
+    MatN<N, N> A;
+    for (int r = 0; r < N; ++r) for (int c = 0; c < N; ++c) A(r, c) = rng.uniform(-2.0, 2.0);
+    init[i].P = A * A.transpose() + MatN<N, N>::Identity();
+    for (int k = 0; k < N; ++k) init[i].x(k) = rng.uniform(-100.0, 100.0);
+    for (int k = 0; k < M; ++k) z[i](k) = init[i].x(k) + rng.normal(0.0, 3.0);
+  }
+
+  std::vector<KalmanND<Model>> kfs = init;
+  br.run_ns("nd/predict/" + tag, n, [&] {
+    for (int i = 0; i < n; ++i) {
+      kfs[i].P = init[i].P;
+      kfs[i].predict();
+    }
+    g_sink = kfs[0].P(0, 0);
+  });
+  br.run_ns("nd/update/" + tag, n, [&] {
+    for (int i = 0; i < n; ++i) {
+      kfs[i].x = init[i].x;
+      kfs[i].P = init[i].P;
+      kfs[i].update(z[i]);
+    }
+    g_sink = kfs[0].x(0);
+  });
+  std::vector<InnovCovN<M>> ics((size_t)n);
+  for (int i = 0; i < n; ++i) ics[i] = init[i].innovation_cov();
+  br.run_ns("nd/maha2/" + tag, n, [&] {
+    double acc = 0.0;
+    for (int i = 0; i < n; ++i) acc += maha2(ics[i], VecN<M>(z[i] - init[i].x.template head<M>()));
+    g_sink = acc;
+  });
+}
+
+// One TrackerND run over pre-generated scans: step time, Mahalanobis tests
+// per scan, tracks created and the track quality within radius of truth
+// (TruthScore).
+template <typename Model>
+static void bench_nd_method(BenchRunner& br, const std::string& name, const TrackerConfig& tcfg,
+                            const std::vector<std::vector<VecN<Model::M>>>& scans,
+                            const std::vector<std::vector<VecN<Model::M>>>& truth,
+                            double dt, double sigma_a, double sigma_z) {
+  if (!br.enabled(name, {"step", "tests", "uncovered", "id_switches", "false_tracks", "rmse",
+                         "tracks_created"})) {
+    return;
+  }
+  TrackerND<Model> trk(tcfg);
+  double step_us = 0.0;
+  uint64_t pairs = 0;
+  uint32_t max_id = 0;
+  TruthScore score(truth[0].size(), 16.0 * sigma_z * sigma_z);
+  for (size_t s = 0; s < scans.size(); ++s) {
+    const auto t0 = bench_clock::now();
+    trk.step(scans[s], dt, sigma_a, sigma_z);
+    const auto t1 = bench_clock::now();
+    step_us += std::chrono::duration<double, std::micro>(t1 - t0).count();
+    pairs += trk.last_pairs_evaluated();
+    for (const auto& info : trk.track_info()) max_id = std::max(max_id, info.id);
+    score.add(trk, truth[s]);
+  }
+  const uint64_t n = (uint64_t)scans.size();
+  br.add(name + "/step", "us", step_us / (double)n, n);
+  br.add(name + "/tests", "count", (double)pairs / (double)n, n);
+  add_truth_score(br, name, score, n, true);
+  br.add(name + "/tracks_created", "count", max_id, n);
+}
+
+// Templated state dimensions: the filter kernels of 2D CV (against kalman/*
+// for the hand-written 2D kernels), 3D CV and 3D CA. Then 3D CV and CA
+// (TrackerND) on the air-target scene, straight and maneuvering
+// (Sim3DConfig), gated at chi-square 3 dof 99%. Last, TrackerND<CV2> against
+// MultiTargetTracker on the 2D random scene: the same scans with the generic
+// kernels, so track ids must match and states agree to rounding.
+static void bench_nd(BenchRunner& br) {
+  bench_nd_kernels<CV2>(br, "cv2");
+  bench_nd_kernels<CV3>(br, "cv3");
+  bench_nd_kernels<CA3>(br, "ca3");
+
+  const int steps = br.options().quick ? 100 : 400;
+  struct Scene {
+    const char* name;
+    Sim3DConfig sim;
+  };
+  Scene scenes[2];
+  scenes[0].name = "straight";
+  scenes[1].name = "maneuver";
+  scenes[1].sim.maneuver_accel = 8.0;
+  for (Scene& sc : scenes) sc.sim.steps = steps;
+
+  for (const Scene& sc : scenes) {
+    const std::string prefix = std::string("nd/") + sc.name + "/";
+    TargetSim3D sim(br.options().seed, sc.sim);
+    std::vector<std::vector<Vec3>> scans((size_t)sc.sim.steps);
+    std::vector<std::vector<Vec3>> truth((size_t)sc.sim.steps);
+    for (size_t s = 0; s < scans.size(); ++s) {
+      sim.step();
+      for (const auto& m : sim.last_measurements()) scans[s].push_back(m.z);
+      for (const auto& t : sim.truth()) truth[s].push_back(t.pos);
+    }
+
+    TrackerConfig tcfg;
+    tcfg.gate_maha2 = 11.34;
+    const double dt = sc.sim.dt, sz = sc.sim.sigma_z;
+    bench_nd_method<CV3>(br, prefix + "cv3", tcfg, scans, truth, dt, 1.5, sz);
+    bench_nd_method<CV3>(br, prefix + "cv3_q10", tcfg, scans, truth, dt, 10.0, sz);
+    bench_nd_method<CA3>(br, prefix + "ca3", tcfg, scans, truth, dt, 0.5, sz);
+  }
+
+  // Methods TrackerND does not run are refused, not silently replaced.
+  if (br.enabled("nd/rejects_unsupported")) {
+    bool rejects = TrackerND<CV2>::supports(TrackerConfig{});
+    const AssocMethod others[] = {AssocMethod::Auction, AssocMethod::Mht, AssocMethod::Jpda};
+    for (AssocMethod a : others) {
+      TrackerConfig c;
+      c.assoc = a;
+      TrackerND<CV2> t(c);
+      rejects = rejects && !t.ok() && !t.step({Vec2(0.0, 0.0)}, 0.05, 1.5, 3.0) && t.tracks().empty();
+    }
+    TrackerConfig imm, sqrt_cov;
+    imm.motion = MotionModel::Imm;
+    sqrt_cov.cov_update = CovUpdate::SquareRoot;
+    rejects = rejects && !TrackerND<CV2>::supports(imm) && !TrackerND<CV2>::supports(sqrt_cov);
+    br.check("nd/rejects_unsupported", rejects);
+  }
+
+  const std::string name = "nd/cv2_vs_2d";
+  if (!br.enabled(name, {"step_2d", "step_nd", "max_state_diff", "same_ids"})) return;
+  SimConfig scfg;
+  scfg.num_targets = 20;
+  scfg.clutter_per_step = 20;
+  scfg.steps = steps;
+  TargetSim2D sim(br.options().seed, scfg);
+  TrackerConfig tcfg;
+  MultiTargetTracker ref(tcfg);
+  TrackerND<CV2> nd(tcfg);
+  std::vector<Vec2> z;
+  double ref_us = 0.0, nd_us = 0.0, max_diff = 0.0;
+  bool same_ids = true;
+  for (int s = 0; s < scfg.steps; ++s) {
+    sim.step();
+    z.clear();
+    for (const auto& m : sim.last_measurements()) z.push_back(m.z);
+    const auto t0 = bench_clock::now();
+    ref.step(z, scfg.dt, 1.5, scfg.sigma_z);
+    const auto t1 = bench_clock::now();
+    nd.step(z, scfg.dt, 1.5, scfg.sigma_z);
+    const auto t2 = bench_clock::now();
+    ref_us += std::chrono::duration<double, std::micro>(t1 - t0).count();
+    nd_us += std::chrono::duration<double, std::micro>(t2 - t1).count();
+    if (ref.tracks().size() != nd.tracks().size()) {
+      same_ids = false;
+      continue;
+    }
+    for (size_t i = 0; i < ref.tracks().size(); ++i) {
+      same_ids = same_ids && ref.track_info()[i].id == nd.track_info()[i].id;
+      max_diff = std::max(max_diff, (ref.tracks()[i].kf.x - nd.tracks()[i].kf.x).cwiseAbs().maxCoeff());
+    }
+  }
+  const uint64_t n = (uint64_t)scfg.steps;
+  br.add(name + "/step_2d", "us", ref_us / (double)n, n);
+  br.add(name + "/step_nd", "us", nd_us / (double)n, n);
+  br.add(name + "/max_state_diff", "m", max_diff, n);
+  br.check(name + "/same_ids", same_ids);
+}
+
+// Checkpoint capture and restore of a warm tracker and its scene: the
+// serialization the scan loop pays on a checkpoint scan (file I/O happens on
+// the writer thread and is not timed here).
+static void bench_checkpoint(BenchRunner& br) {
+  const int sizes[] = {1000, 10000};
+  const double dt = 0.05, sigma_a = 1.5, sigma_z = 3.0;
+
+  for (int n : sizes) {
+    if (br.options().quick && n > 1000) continue;
+    const std::string tag = "/t" + std::to_string(n);
+
+    SimConfig scfg;
+    scfg.num_targets = n;
+    scfg.clutter_per_step = n / 5;
+    scfg.scenario_massive = true;
+    TargetSim2D sim(br.options().seed, scfg);
+    MultiTargetTracker trk(TrackerConfig{});
+    for (int s = 0; s < 10; ++s) {
+      sim.step();
+      std::vector<Vec2> z;
+      for (const auto& m : sim.last_measurements()) z.push_back(m.z);
+      trk.step(z, dt, sigma_a, sigma_z);
+    }
+
+    CheckpointImage img;
+    br.run_ns("checkpoint/save_tracker" + tag, 1, [&] {
+      StateWriter w(img.tracker);
+      trk.save_state(w);
+      g_sink = (double)img.tracker.size();
+    });
+    br.run_ns("checkpoint/save_sim" + tag, 1, [&] {
+      StateWriter w(img.sim);
+      sim.save_state(w);
+      g_sink = (double)img.sim.size();
+    });
+    {
+      StateWriter w(img.tracker);
+      trk.save_state(w);
+    }
+    MultiTargetTracker restored(TrackerConfig{});
+    br.run_ns("checkpoint/load_tracker" + tag, 1, [&] {
+      StateReader r(img.tracker);
+      g_sink = restored.load_state(r) ? 1.0 : 0.0;
+    });
+  }
+}
+
+// Output hash of one scan: the canonical per-track record fed to the golden
+// FNV-1a (byte at a time) and to the word-at-a-time stage hash (ns per track).
+static void bench_hash(BenchRunner& br) {
+  const int n = 1024;
+  Rng rng(br.options().seed);
+  const std::vector<KalmanCV2D> kfs = random_filters(rng, n);
+
+  auto run = [&](auto hash, const char* name) {
+    br.run_ns(std::string("hash/") + name, (uint64_t)n, [&] {
+      auto h = hash;
+      for (int i = 0; i < n; ++i) hash_track_record(h, (uint32_t)i + 1, true, kfs[i].x, kfs[i].P, 0, 5);
+      g_sink = (double)(h.h & 0xff);
+    });
+  };
+  run(Fnv1a64{}, "fnv1a");
+  run(WordHash64{}, "word64");
+}
+
+// Scene generation cost per scan: the std::random based default scene vs the
+// CounterRng load-test scene, same target and clutter counts.
+static void bench_sim(BenchRunner& br) {
+  const int targets = br.options().quick ? 10000 : 100000;
+  const int clutter = targets / 5;
+  const int steps = br.options().quick ? 5 : 20;
+
+  for (int massive = 0; massive <= 1; ++massive) {
+    const std::string name = std::string("sim/") + (massive ? "massive" : "random") +
+                             "/t" + std::to_string(targets) + "/c" + std::to_string(clutter);
+    if (!br.enabled(name)) continue;
+
+    SimConfig scfg;
+    scfg.num_targets = targets;
+    scfg.clutter_per_step = clutter;
+    scfg.scenario_massive = massive != 0;
+    TargetSim2D sim(br.options().seed, scfg);
+
+    const auto t0 = bench_clock::now();
+    for (int s = 0; s < steps; ++s) sim.step();
+    const auto t1 = bench_clock::now();
+    g_sink = (double)sim.last_measurements().size();
+
+    const double ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
+    br.add(name, "ms", ms / steps, (uint64_t)steps);
+  }
+}
+
+static std::string json_escape(const std::string& s) {
+  std::string out;
+  for (char c : s) {
+    if (c == '"' || c == '\\') out += '\\';
+    out += c;
+  }
+  return out;
+}
+
+static void write_json(std::ostream& os, const BenchRunner& br) {
+  os << "{\n";
+  os << "  \"format\": \"radar_bench/1\",\n";
+  os << "  \"seed\": " << br.options().seed << ",\n";
+  os << "  \"quick\": " << (br.options().quick ? "true" : "false") << ",\n";
+  os << "  \"results\": [\n";
+  const auto& rs = br.results();
+  for (size_t i = 0; i < rs.size(); ++i) {
+    os << "    {\"name\": \"" << json_escape(rs[i].name) << "\", \"unit\": \"" << rs[i].unit
+       << "\", \"value\": " << std::setprecision(9) << rs[i].value
+       << ", \"iters\": " << rs[i].iters << "}" << (i + 1 < rs.size() ? "," : "") << "\n";
+  }
+  os << "  ]\n";
+  os << "}\n";
+}
+
+// Reads name/value pairs back from a file written by write_json(). Only the
+// flat result objects are parsed, so this is not a general JSON reader.
+static bool read_baseline(const std::string& path, std::vector<BenchResult>& out) {
+  std::ifstream f(path);
+  if (!f) return false;
+  std::stringstream ss;
+  ss << f.rdbuf();
+  const std::string text = ss.str();
+
+  const std::string name_key = "\"name\": \"";
+  const std::string value_key = "\"value\": ";
+  size_t pos = 0;
+  while ((pos = text.find(name_key, pos)) != std::string::npos) {
+    const size_t obj_end = text.find('}', pos);
+    if (obj_end == std::string::npos) break;
+
+    BenchResult r;
+    size_t i = pos + name_key.size();
+    for (; i < obj_end && text[i] != '"'; ++i) {
+      if (text[i] == '\\' && i + 1 < obj_end) ++i;
+      r.name += text[i];
+    }
+    const size_t v = text.find(value_key, pos);
+    if (v != std::string::npos && v < obj_end) {
+      r.value = std::strtod(text.c_str() + v + value_key.size(), nullptr);
+      out.push_back(r);
+    }
+    pos = obj_end;
+  }
+  return true;
+}
+
+// Prints one line per benchmark present in both runs; returns the number of
+// regressions (current slower than baseline by more than the threshold).
+static int compare_baseline(const BenchRunner& br, const std::vector<BenchResult>& base) {
+  const double thr = br.options().threshold;
+  int regressions = 0, matched = 0;
+
+  std::cerr << "=== COMPARE vs " << br.options().baseline << " (threshold "
+            << std::setprecision(3) << thr * 100.0 << "%) ===\n";
+  for (const auto& cur : br.results()) {
+    const auto it = std::find_if(base.begin(), base.end(),
+                                 [&](const BenchResult& b) { return b.name == cur.name; });
+    if (it == base.end() || !(it->value > 0.0)) continue;
+    matched++;
+
+    const double ratio = cur.value / it->value;
+    const char* verdict = "ok";
+    if (ratio > 1.0 + thr) { verdict = "REGRESSION"; regressions++; }
+    else if (ratio < 1.0 / (1.0 + thr)) verdict = "improved";
+
+    std::cerr << std::left << std::setw(48) << cur.name << std::right << std::fixed
+              << std::setprecision(3) << std::setw(14) << it->value << " -> "
+              << std::setw(14) << cur.value << " " << cur.unit
+              << std::setw(9) << std::setprecision(2) << (ratio - 1.0) * 100.0 << "%  "
+              << verdict << "\n";
+  }
+  std::cerr << "compared=" << matched << " regressions=" << regressions << "\n";
+  return regressions;
+}
+
+int main(int argc, char** argv) {
+  BenchOptions opt;
+
+  for (int i = 1; i < argc; ++i) {
+    const char* a = argv[i];
+    if (arg_eq(a, "--seed") && i + 1 < argc) opt.seed = parse_u64(argv[++i]);
+    else if (arg_eq(a, "--quick") && i + 1 < argc) opt.quick = parse_b(argv[++i]) != 0;
+    else if (arg_eq(a, "--filter") && i + 1 < argc) opt.filter = argv[++i];
+    else if (arg_eq(a, "--json") && i + 1 < argc) opt.json_path = argv[++i];
+    else if (arg_eq(a, "--baseline") && i + 1 < argc) opt.baseline = argv[++i];
+    else if (arg_eq(a, "--threshold") && i + 1 < argc) opt.threshold = parse_d(argv[++i]);
+    else if (arg_eq(a, "--help")) {
+      std::cout
+        << "radar_bench options:\n"
+        << "  --seed N          (default 1)\n"
+        << "  --quick 0|1       short timings and a reduced sweep (default 0)\n"
+        << "  --filter STR      only run benchmarks whose name contains STR\n"
+        << "  --json FILE       write results to FILE (default: stdout)\n"
+        << "  --baseline FILE   compare against an earlier --json output\n"
+        << "  --threshold X     relative slowdown flagged as regression (default 0.10)\n";
+      return 0;
+    }
+  }
+
+  std::vector<BenchResult> base;
+  if (!opt.baseline.empty() && !read_baseline(opt.baseline, base)) {
+    std::cerr << "cannot read baseline: " << opt.baseline << "\n";
+    return 2;
+  }
+
+  BenchRunner br(opt);
+  bench_kalman(br);
+  bench_filter(br);
+  bench_predict(br);
+  bench_hungarian(br);
+  bench_association(br);
+  bench_gating(br);
+  bench_auction(br);
+  bench_scenarios(br);
+  bench_threads(br);
+  bench_layout(br);
+  bench_init(br);
+  bench_alloc(br);
+  bench_mht(br);
+  bench_jpda(br);
+  bench_imm(br);
+  bench_fusion(br);
+  bench_polar(br);
+  bench_polar_scenes(br);
+  bench_polar_wide_gate(br);
+  bench_nd(br);
+  bench_checkpoint(br);
+  bench_hash(br);
+  bench_sim(br);
+
+  if (opt.json_path.empty()) {
+    write_json(std::cout, br);
+  } else {
+    std::ofstream f(opt.json_path);
+    if (!f) {
+      std::cerr << "cannot write: " << opt.json_path << "\n";
+      return 2;
+    }
+    write_json(f, br);
+  }
+
+  const int regressions = opt.baseline.empty() ? 0 : compare_baseline(br, base);
+  if (!br.failed_checks().empty()) return 3;
+  return regressions > 0 ? 1 : 0;
+}
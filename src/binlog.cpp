@@ -0,0 +1,113 @@
+#include "binlog.h"
+#include <sstream>
+
+BinLog::BinLog(const std::string& path, const std::string& schema, bool compress, int block_rows)
+  : out_(path, std::ios::binary), compress_(compress), block_rows_(block_rows > 0 ? block_rows : 4096) {
+  std::stringstream ss(schema);
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    Column c;
+    const size_t colon = item.find(':');
+    c.name = item.substr(0, colon);
+    const std::string t = (colon == std::string::npos) ? "f64" : item.substr(colon + 1);
+    if (t == "i32") { c.type = ColType::I32; c.size = 4; }
+    else if (t == "u32") { c.type = ColType::U32; c.size = 4; }
+    else if (t == "u8") { c.type = ColType::U8; c.size = 1; }
+    else { c.type = ColType::F64; c.size = 8; }
+    c.data.reserve((size_t)block_rows_ * (size_t)c.size);
+    cols_.push_back(std::move(c));
+  }
+
+  std::vector<uint8_t> hdr;
+  const char magic[8] = {'R', 'T', 'B', 'L', 'O', 'G', '1', '\0'};
+  hdr.insert(hdr.end(), magic, magic + 8);
+  const uint32_t ncols = (uint32_t)cols_.size();
+  hdr.insert(hdr.end(), (const uint8_t*)&ncols, (const uint8_t*)&ncols + 4);
+  for (const auto& c : cols_) {
+    hdr.push_back((uint8_t)c.type);
+    hdr.push_back((uint8_t)c.name.size());
+    hdr.insert(hdr.end(), c.name.begin(), c.name.end());
+  }
+  write_padded(hdr.data(), hdr.size());
+}
+
+BinLog::~BinLog() { flush(); }
+
+void BinLog::write_u32(uint32_t v) {
+  out_.write(reinterpret_cast<const char*>(&v), 4);
+}
+
+void BinLog::write_padded(const uint8_t* p, size_t n) {
+  static const char zeros[8] = {};
+  out_.write(reinterpret_cast<const char*>(p), (std::streamsize)n);
+  if (n % 8) out_.write(zeros, (std::streamsize)(8 - n % 8));
+}
+
+void BinLog::flush() {
+  if (rows_ == 0) return;
+  write_u32((uint32_t)rows_);
+  write_u32(compress_ ? 1u : 0u);
+  for (auto& c : cols_) {
+    if (compress_) {
+      encode(c, rows_);
+      write_u32((uint32_t)packed_.size());
+      write_u32(0);
+      write_padded(packed_.data(), packed_.size());
+    } else {
+      write_u32((uint32_t)c.data.size());
+      write_u32(0);
+      write_padded(c.data.data(), c.data.size());
+    }
+    c.data.clear();
+  }
+  rows_ = 0;
+}
+
+void BinLog::encode(const Column& c, int n) {
+  const int w = c.size;
+  const size_t len = (size_t)n * (size_t)w;
+  delta_.resize(len);
+
+  // Delta / XOR against the previous row; the first row is taken against 0.
+  if (c.type == ColType::F64) {
+    uint64_t prev = 0;
+    for (int i = 0; i < n; ++i) {
+      uint64_t v;
+      std::memcpy(&v, &c.data[(size_t)i * 8], 8);
+      const uint64_t d = v ^ prev;
+      std::memcpy(&delta_[(size_t)i * 8], &d, 8);
+      prev = v;
+    }
+  } else if (w == 4) {
+    uint32_t prev = 0;
+    for (int i = 0; i < n; ++i) {
+      uint32_t v;
+      std::memcpy(&v, &c.data[(size_t)i * 4], 4);
+      const uint32_t d = v - prev;
+      std::memcpy(&delta_[(size_t)i * 4], &d, 4);
+      prev = v;
+    }
+  } else {
+    uint8_t prev = 0;
+    for (int i = 0; i < n; ++i) {
+      delta_[(size_t)i] = (uint8_t)(c.data[(size_t)i] - prev);
+      prev = c.data[(size_t)i];
+    }
+  }
+
+  // Byte shuffle: all byte-0s, then all byte-1s, ...
+  shuffled_.resize(len);
+  for (int k = 0; k < w; ++k)
+    for (int i = 0; i < n; ++i)
+      shuffled_[(size_t)k * (size_t)n + (size_t)i] = delta_[(size_t)i * (size_t)w + (size_t)k];
+
+  // Zero suppression: MSB-first bitmap of nonzero bytes, then those bytes.
+  const size_t bm = (len + 7) / 8;
+  packed_.assign(bm, 0);
+  for (size_t j = 0; j < len; ++j) {
+    if (shuffled_[j]) {
+      packed_[j >> 3] |= (uint8_t)(0x80u >> (j & 7));
+      packed_.push_back(shuffled_[j]);
+    }
+  }
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Binary columnar log: a typed-column alternative to Csv for long runs.
+//
+// Layout (little-endian):
+//   header  "RTBLOG1\0", u32 ncols, per column {u8 type, u8 name_len, name},
+//           zero-padded to a multiple of 8 bytes
+//   blocks  u32 nrows, u32 codec, then per column {u32 nbytes, u32 0,
+//           payload zero-padded to a multiple of 8 bytes}
+//
+// Codec 0 stores raw column arrays (8-byte aligned, so readers can map them
+// without copying). Codec 1 is a cheap compressor: per-column delta (integers)
+// or XOR with the previous value (doubles), byte shuffle, then zero-byte
+// suppression as {bitmap of nonzero bytes, nonzero bytes}.
+// tools/binlog.py reads both.
+enum class ColType : uint8_t { I32 = 0, U32 = 1, F64 = 2, U8 = 3 };
+
+class BinLog {
+public:
+  // schema: "name:type,..." with type one of i32, u32, f64, u8.
+  BinLog(const std::string& path, const std::string& schema, bool compress, int block_rows = 4096);
+  ~BinLog();
+
+  BinLog(const BinLog&) = delete;
+  BinLog& operator=(const BinLog&) = delete;
+
+  // One value per column, in schema order.
+  template <typename... Ts>
+  void row(const Ts&... xs) {
+    int c = 0;
+    (put(cols_[c++], xs), ...);
+    if (++rows_ == block_rows_) flush();
+  }
+
+  void flush();
+
+private:
+  struct Column {
+    std::string name;
+    ColType type = ColType::F64;
+    int size = 8;
+    std::vector<uint8_t> data;
+  };
+
+  std::ofstream out_;
+  std::vector<Column> cols_;
+  bool compress_ = false;
+  int block_rows_ = 4096;
+  int rows_ = 0;
+
+  std::vector<uint8_t> delta_;   // codec scratch
+  std::vector<uint8_t> shuffled_;
+  std::vector<uint8_t> packed_;
+
+  template <typename T>
+  static void put(Column& c, T v) {
+    uint8_t b[8];
+    switch (c.type) {
+      case ColType::I32: { const int32_t x = (int32_t)v; std::memcpy(b, &x, 4); break; }
+      case ColType::U32: { const uint32_t x = (uint32_t)v; std::memcpy(b, &x, 4); break; }
+      case ColType::F64: { const double x = (double)v; std::memcpy(b, &x, 8); break; }
+      case ColType::U8: b[0] = (uint8_t)v; break;
+    }
+    c.data.insert(c.data.end(), b, b + c.size);
+  }
+
+  void write_u32(uint32_t v);
+  void write_padded(const uint8_t* p, size_t n);
+  void encode(const Column& c, int n);
+};
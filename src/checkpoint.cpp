@@ -0,0 +1,189 @@
+#include "checkpoint.h"
+#include "fnv1a.h"
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string_view>
+
+namespace {
+
+const char kMagic[8] = {'R', 'T', 'C', 'K', 'P', 'T', '1', '\0'};
+const uint32_t kVersion = 3;
+const uint32_t kTagRun = 0x204e5552;     // "RUN "
+const uint32_t kTagTracker = 0x204b5254; // "TRK "
+const uint32_t kTagSim = 0x204d4953;     // "SIM "
+
+uint64_t padded(uint64_t n) { return (n + 7) & ~7ull; }
+
+void add_section(Fnv1a64& h, std::ofstream& out, uint32_t tag, const std::vector<uint8_t>& b) {
+  static const char zeros[8] = {};
+  uint8_t hdr[16] = {};
+  const uint64_t n = b.size();
+  std::memcpy(hdr, &tag, 4);
+  std::memcpy(hdr + 8, &n, 8);
+  out.write(reinterpret_cast<const char*>(hdr), 16);
+  if (n) out.write(reinterpret_cast<const char*>(b.data()), (std::streamsize)n);
+  if (n % 8) out.write(zeros, (std::streamsize)(8 - n % 8));
+
+  h.add(std::string_view(reinterpret_cast<const char*>(hdr), 16));
+  h.add(std::string_view(reinterpret_cast<const char*>(b.data()), b.size()));
+  for (uint64_t i = n; i < padded(n); ++i) h.add_byte(0);
+}
+
+bool set_error(std::string* error, const char* msg) {
+  if (error) *error = msg;
+  return false;
+}
+
+} // namespace
+
+bool write_checkpoint(const std::string& path, const CheckpointImage& img) {
+  const std::string tmp = path + ".tmp";
+  {
+    std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+    if (!out) return false;
+
+    // Header first with a zero checksum, patched once the payload is out.
+    const uint32_t sections = 3;
+    const uint64_t payload = 3 * 16 + padded(img.run.size()) + padded(img.tracker.size()) + padded(img.sim.size());
+    uint8_t hdr[32] = {};
+    std::memcpy(hdr, kMagic, 8);
+    std::memcpy(hdr + 8, &kVersion, 4);
+    std::memcpy(hdr + 12, &sections, 4);
+    std::memcpy(hdr + 16, &payload, 8);
+    out.write(reinterpret_cast<const char*>(hdr), 32);
+
+    Fnv1a64 h;
+    add_section(h, out, kTagRun, img.run);
+    add_section(h, out, kTagTracker, img.tracker);
+    add_section(h, out, kTagSim, img.sim);
+    out.seekp(24);
+    out.write(reinterpret_cast<const char*>(&h.h), 8);
+    out.flush();
+    if (!out) return false;
+  }
+  std::error_code ec;
+  std::filesystem::rename(tmp, path, ec);
+  return !ec;
+}
+
+bool read_checkpoint(const std::string& path, CheckpointImage& img, std::string* error) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) return set_error(error, "cannot open checkpoint");
+
+  uint8_t hdr[32];
+  if (!in.read(reinterpret_cast<char*>(hdr), 32)) return set_error(error, "truncated header");
+  uint32_t version = 0, sections = 0;
+  uint64_t payload = 0, checksum = 0;
+  std::memcpy(&version, hdr + 8, 4);
+  std::memcpy(&sections, hdr + 12, 4);
+  std::memcpy(&payload, hdr + 16, 8);
+  std::memcpy(&checksum, hdr + 24, 8);
+  if (std::memcmp(hdr, kMagic, 8) != 0) return set_error(error, "not a checkpoint");
+  if (version != kVersion) return set_error(error, "unsupported checkpoint version");
+
+  std::error_code ec;
+  const uint64_t file_size = std::filesystem::file_size(path, ec);
+  if (ec || file_size != 32 + payload) return set_error(error, "checkpoint size mismatch");
+  std::vector<uint8_t> body((size_t)payload);
+  if (payload && !in.read(reinterpret_cast<char*>(body.data()), (std::streamsize)payload)) {
+    return set_error(error, "truncated checkpoint");
+  }
+  Fnv1a64 h;
+  h.add(std::string_view(reinterpret_cast<const char*>(body.data()), body.size()));
+  if (h.h != checksum) return set_error(error, "checkpoint checksum mismatch");
+
+  img.run.clear();
+  img.tracker.clear();
+  img.sim.clear();
+  size_t pos = 0;
+  for (uint32_t s = 0; s < sections; ++s) {
+    if (body.size() - pos < 16) return set_error(error, "truncated section");
+    uint32_t tag = 0;
+    uint64_t n = 0;
+    std::memcpy(&tag, body.data() + pos, 4);
+    std::memcpy(&n, body.data() + pos + 8, 8);
+    pos += 16;
+    if (n > body.size() - pos) return set_error(error, "truncated section");
+    std::vector<uint8_t>* dst = tag == kTagRun ? &img.run : tag == kTagTracker ? &img.tracker :
+                                tag == kTagSim ? &img.sim : nullptr;
+    if (dst) dst->assign(body.begin() + (std::ptrdiff_t)pos, body.begin() + (std::ptrdiff_t)(pos + n));
+    pos += (size_t)padded(n);
+  }
+  return true;
+}
+
+CheckpointWriter::CheckpointWriter(std::string path) : path_(std::move(path)) {
+  thread_ = std::thread([this] { run(); });
+}
+
+CheckpointWriter::~CheckpointWriter() {
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  thread_.join();
+}
+
+bool CheckpointWriter::submit(CheckpointImage& img) {
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    if (busy_) {
+      skipped_++;
+      return false;
+    }
+    std::swap(pending_, img);
+    busy_ = true;
+  }
+  cv_.notify_all();
+  return true;
+}
+
+void CheckpointWriter::flush() {
+  std::unique_lock<std::mutex> lk(mu_);
+  cv_.wait(lk, [this] { return !busy_; });
+}
+
+void CheckpointWriter::run() {
+  std::unique_lock<std::mutex> lk(mu_);
+  for (;;) {
+    // Drain a pending image before honoring stop, so nothing submitted is lost.
+    cv_.wait(lk, [this] { return busy_ || stop_; });
+    if (!busy_) return;
+    lk.unlock();
+    const auto t0 = std::chrono::steady_clock::now();
+    const bool ok = write_checkpoint(path_, pending_);
+    const auto t1 = std::chrono::steady_clock::now();
+    lk.lock();
+    if (ok) {
+      written_++;
+      write_ms_ += std::chrono::duration<double, std::milli>(t1 - t0).count();
+    } else {
+      failed_++;
+    }
+    busy_ = false;
+    cv_.notify_all();
+  }
+}
+
+uint64_t CheckpointWriter::written() const {
+  std::lock_guard<std::mutex> lk(mu_);
+  return written_;
+}
+
+uint64_t CheckpointWriter::skipped() const {
+  std::lock_guard<std::mutex> lk(mu_);
+  return skipped_;
+}
+
+uint64_t CheckpointWriter::failed() const {
+  std::lock_guard<std::mutex> lk(mu_);
+  return failed_;
+}
+
+double CheckpointWriter::write_ms() const {
+  std::lock_guard<std::mutex> lk(mu_);
+  return write_ms_;
+}
@@ -0,0 +1,171 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "math_types.h"
+
+// Checkpoint file: the state of a run at a scan boundary, for warm restart.
+//
+// Layout (little-endian):
+//   header   "RTCKPT1\0", u32 version, u32 num_sections, u64 payload bytes,
+//            u64 FNV-1a 64 of the payload
+//   payload  per section {u32 tag, u32 0, u64 nbytes, bytes zero-padded to
+//            a multiple of 8}
+//
+// Sections are opaque byte images written by each component's save_state()
+// (StateWriter) and read back by load_state() (StateReader). Values are
+// stored in host layout, so a checkpoint is for restarting the same build,
+// not an interchange format.
+struct CheckpointImage {
+  std::vector<uint8_t> run;     // driver: step, hash, totals (main.cpp)
+  std::vector<uint8_t> tracker; // MultiTargetTracker::save_state
+  std::vector<uint8_t> sim;     // TargetSim2D::save_state, empty for replay
+};
+
+// Appends values to a section buffer (cleared on construction, capacity kept).
+class StateWriter {
+public:
+  explicit StateWriter(std::vector<uint8_t>& buf) : buf_(buf) { buf_.clear(); }
+
+  template <typename T>
+  void pod(const T& v) {
+    static_assert(std::is_trivially_copyable<T>::value, "pod() needs a trivially copyable type");
+    bytes(&v, sizeof(T));
+  }
+
+  // Size, then the elements as raw bytes.
+  template <typename T>
+  void vec(const std::vector<T>& v) {
+    static_assert(std::is_trivially_copyable<T>::value, "vec() needs a trivially copyable type");
+    pod((uint64_t)v.size());
+    if (!v.empty()) bytes(v.data(), v.size() * sizeof(T));
+  }
+
+  template <int R, int C>
+  void mat(const Eigen::Matrix<double, R, C>& m) { bytes(m.data(), sizeof(double) * R * C); }
+
+  void str(const std::string& s) {
+    pod((uint64_t)s.size());
+    bytes(s.data(), s.size());
+  }
+
+  void bytes(const void* p, size_t n) {
+    const size_t at = buf_.size();
+    buf_.resize(at + n);
+    std::memcpy(buf_.data() + at, p, n);
+  }
+
+private:
+  std::vector<uint8_t>& buf_;
+};
+
+// Reads a section back. Errors are sticky: every read after a short one
+// fails, so callers check ok() (or done()) once at the end.
+class StateReader {
+public:
+  explicit StateReader(const std::vector<uint8_t>& buf) : p_(buf.data()), n_(buf.size()) {}
+
+  template <typename T>
+  bool pod(T& v) {
+    static_assert(std::is_trivially_copyable<T>::value, "pod() needs a trivially copyable type");
+    return bytes(&v, sizeof(T));
+  }
+
+  template <typename T>
+  bool vec(std::vector<T>& v) {
+    static_assert(std::is_trivially_copyable<T>::value, "vec() needs a trivially copyable type");
+    uint64_t n = 0;
+    if (!pod(n) || n > (n_ - pos_) / sizeof(T)) return fail();
+    v.resize((size_t)n);
+    return n == 0 || bytes(v.data(), (size_t)n * sizeof(T));
+  }
+
+  template <int R, int C>
+  bool mat(Eigen::Matrix<double, R, C>& m) { return bytes(m.data(), sizeof(double) * R * C); }
+
+  bool str(std::string& s) {
+    uint64_t n = 0;
+    if (!pod(n) || n > n_ - pos_) return fail();
+    s.assign(reinterpret_cast<const char*>(p_ + pos_), (size_t)n);
+    pos_ += (size_t)n;
+    return true;
+  }
+
+  // Element count of a following sequence, bounded by the bytes left so a
+  // corrupt count cannot trigger a huge allocation.
+  bool count(uint64_t& n, size_t min_elem_bytes) {
+    if (!pod(n) || n > (n_ - pos_) / (min_elem_bytes ? min_elem_bytes : 1)) return fail();
+    return true;
+  }
+
+  bool bytes(void* out, size_t n) {
+    if (!ok_ || n > n_ - pos_) return fail();
+    std::memcpy(out, p_ + pos_, n);
+    pos_ += n;
+    return true;
+  }
+
+  bool ok() const { return ok_; }
+  bool done() const { return ok_ && pos_ == n_; }
+
+private:
+  const uint8_t* p_;
+  size_t n_;
+  size_t pos_ = 0;
+  bool ok_ = true;
+
+  bool fail() {
+    ok_ = false;
+    return false;
+  }
+};
+
+// Writes img to path atomically: a temporary file next to it, then a rename
+// over path, so path always holds the previous or the new checkpoint whole.
+bool write_checkpoint(const std::string& path, const CheckpointImage& img);
+// Reads and verifies (magic, version, checksum) a checkpoint.
+bool read_checkpoint(const std::string& path, CheckpointImage& img, std::string* error = nullptr);
+
+// Background checkpoint writer. The scan loop serializes the state into a
+// CheckpointImage (the copy) and submit() swaps it into the writer's idle
+// slot, handing back the buffers of an earlier image for reuse: no disk I/O
+// and, in steady state, no allocation on the caller's thread. A submit while
+// the previous image is still being written is dropped and counted in
+// skipped(), so a slow disk never stalls scans.
+class CheckpointWriter {
+public:
+  explicit CheckpointWriter(std::string path);
+  ~CheckpointWriter();
+
+  CheckpointWriter(const CheckpointWriter&) = delete;
+  CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+
+  bool submit(CheckpointImage& img);
+  // Blocks until the pending image, if any, is on disk.
+  void flush();
+
+  uint64_t written() const;
+  uint64_t skipped() const;
+  uint64_t failed() const;
+  double write_ms() const; // summed over written images
+
+private:
+  std::string path_;
+  mutable std::mutex mu_;
+  std::condition_variable cv_;
+  CheckpointImage pending_;
+  bool busy_ = false;
+  bool stop_ = false;
+  uint64_t written_ = 0;
+  uint64_t skipped_ = 0;
+  uint64_t failed_ = 0;
+  double write_ms_ = 0.0;
+  std::thread thread_;
+
+  void run();
+};
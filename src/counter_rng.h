@@ -0,0 +1,126 @@
+#pragma once
+#include <cstdint>
+#include <cmath>
+
+// Counter-based RNG (Philox4x32-10, Salmon et al., SC'11). Every 128-bit
+// output block is a pure function of (key, counter), so any draw can be
+// produced without the ones before it: streams can be handed to threads or
+// tiles in any order and still give the same numbers.
+//
+// CounterRng(seed, stream, sub) walks the blocks of one (stream, sub) pair;
+// the simulator uses stream = target id or tile index and sub = scan index.
+// Distributions are inlined here rather than built per call.
+class CounterRng {
+public:
+  CounterRng(uint64_t seed, uint64_t stream, uint32_t sub) {
+    key_[0] = (uint32_t)seed;
+    key_[1] = (uint32_t)(seed >> 32);
+    ctr_[0] = 0;
+    ctr_[1] = sub;
+    ctr_[2] = (uint32_t)stream;
+    ctr_[3] = (uint32_t)(stream >> 32);
+  }
+
+  uint32_t next_u32() {
+    if (pos_ == 4) refill();
+    return out_[pos_++];
+  }
+
+  // [0,1) with 53 random bits
+  double uniform01() {
+    const uint64_t hi = next_u32();
+    const uint64_t lo = next_u32();
+    return (double)(((hi << 32) | lo) >> 11) * (1.0 / 9007199254740992.0);
+  }
+
+  // [a,b)
+  double uniform(double a, double b) { return a + (b - a) * uniform01(); }
+
+  // Normal(mu, sigma), Marsaglia polar method; the second variate is kept
+  // for the next call.
+  double normal(double mu, double sigma) {
+    if (has_spare_) {
+      has_spare_ = false;
+      return mu + sigma * spare_;
+    }
+    double u, v, s;
+    do {
+      u = 2.0 * uniform01() - 1.0;
+      v = 2.0 * uniform01() - 1.0;
+      s = u * u + v * v;
+    } while (s >= 1.0 || s == 0.0);
+    const double f = std::sqrt(-2.0 * std::log(s) / s);
+    spare_ = v * f;
+    has_spare_ = true;
+    return mu + sigma * u * f;
+  }
+
+  // Poisson(lambda): multiplication method for small means, PTRS
+  // transformed rejection (Hormann 1993) above that.
+  uint64_t poisson(double lambda) {
+    if (!(lambda > 0.0)) return 0;
+    if (lambda < 10.0) {
+      const double limit = std::exp(-lambda);
+      uint64_t k = 0;
+      double p = uniform01();
+      while (p > limit) {
+        ++k;
+        p *= uniform01();
+      }
+      return k;
+    }
+
+    const double slam = std::sqrt(lambda);
+    const double loglam = std::log(lambda);
+    const double b = 0.931 + 2.53 * slam;
+    const double a = -0.059 + 0.02483 * b;
+    const double inv_alpha = 1.1239 + 1.1328 / (b - 3.4);
+    const double vr = 0.9277 - 3.6224 / (b - 2.0);
+    for (;;) {
+      const double u = uniform01() - 0.5;
+      const double v = uniform01();
+      const double us = 0.5 - std::fabs(u);
+      const double k = std::floor((2.0 * a / us + b) * u + lambda + 0.43);
+      if (us >= 0.07 && v <= vr) return (uint64_t)k;
+      if (k < 0.0 || (us < 0.013 && v > us)) continue;
+      if (std::log(v) + std::log(inv_alpha) - std::log(a / (us * us) + b) <=
+          -lambda + k * loglam - std::lgamma(k + 1.0)) {
+        return (uint64_t)k;
+      }
+    }
+  }
+
+private:
+  uint32_t key_[2];
+  uint32_t ctr_[4];
+  uint32_t out_[4] = {0, 0, 0, 0};
+  int pos_ = 4;
+  double spare_ = 0.0;
+  bool has_spare_ = false;
+
+  static void mulhilo(uint32_t a, uint32_t b, uint32_t& hi, uint32_t& lo) {
+    const uint64_t p = (uint64_t)a * (uint64_t)b;
+    hi = (uint32_t)(p >> 32);
+    lo = (uint32_t)p;
+  }
+
+  void refill() {
+    uint32_t c0 = ctr_[0], c1 = ctr_[1], c2 = ctr_[2], c3 = ctr_[3];
+    uint32_t k0 = key_[0], k1 = key_[1];
+    for (int round = 0; round < 10; ++round) {
+      uint32_t hi0, lo0, hi1, lo1;
+      mulhilo(0xD2511F53u, c0, hi0, lo0);
+      mulhilo(0xCD9E8D57u, c2, hi1, lo1);
+      const uint32_t n0 = hi1 ^ c1 ^ k0;
+      const uint32_t n1 = lo1;
+      const uint32_t n2 = hi0 ^ c3 ^ k1;
+      const uint32_t n3 = lo0;
+      c0 = n0; c1 = n1; c2 = n2; c3 = n3;
+      k0 += 0x9E3779B9u;
+      k1 += 0xBB67AE85u;
+    }
+    out_[0] = c0; out_[1] = c1; out_[2] = c2; out_[3] = c3;
+    ctr_[0] += 1; // block index within this (stream, sub)
+    pos_ = 0;
+  }
+};
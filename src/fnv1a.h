@@ -1,5 +1,6 @@
 #pragma once
 #include <cstdint>
+#include <cstring>
 #include <string_view>
 
 struct Fnv1a64 {
@@ -19,4 +20,17 @@ struct Fnv1a64 {
       add_byte(static_cast<uint8_t>((v >> (i * 8)) & 0xFF));
     }
   }
-};
\ No newline at end of file
+
+  void add_u32(uint32_t v) {
+    for (int i = 0; i < 4; ++i) {
+      add_byte(static_cast<uint8_t>((v >> (i * 8)) & 0xFF));
+    }
+  }
+
+  // IEEE-754 bits, little-endian: exact, and -0.0 differs from 0.0.
+  void add_f64(double v) {
+    uint64_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    add_u64(bits);
+  }
+};
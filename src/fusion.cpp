@@ -0,0 +1,93 @@
+#include "fusion.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+SensorFusion::SensorFusion(MultiTargetTracker& tracker, const FusionConfig& cfg)
+  : trk_(tracker), cfg_(cfg) {}
+
+bool SensorFusion::before(int a, int b) const {
+  const Held& x = slots_[(size_t)a];
+  const Held& y = slots_[(size_t)b];
+  if (x.t != y.t) return x.t < y.t;
+  if (x.sensor != y.sensor) return x.sensor < y.sensor;
+  return x.seq < y.seq;
+}
+
+void SensorFusion::ingest(int sensor, double t, MeasSpan z, double now) {
+  stats_.scans++;
+  stats_.measurements += z.size();
+
+  int slot;
+  if (!free_.empty()) {
+    slot = free_.back();
+    free_.pop_back();
+  } else {
+    slot = (int)slots_.size();
+    slots_.emplace_back();
+  }
+  Held& h = slots_[(size_t)slot];
+  h.t = t;
+  h.sensor = sensor;
+  h.seq = seq_++;
+  h.z.assign(z.begin(), z.end());
+
+  // std::push_heap builds a max-heap, so the comparison is reversed.
+  auto later = [this](int a, int b) { return before(b, a); };
+  heap_.push_back(slot);
+  std::push_heap(heap_.begin(), heap_.end(), later);
+
+  release_until(now - cfg_.lag);
+}
+
+void SensorFusion::flush() {
+  release_until(std::numeric_limits<double>::infinity());
+  if (started_) {
+    trk_.end_frame();
+    stats_.frames++;
+  }
+}
+
+void SensorFusion::release_until(double t) {
+  auto later = [this](int a, int b) { return before(b, a); };
+  while (!heap_.empty() && slots_[(size_t)heap_.front()].t <= t) {
+    std::pop_heap(heap_.begin(), heap_.end(), later);
+    const int slot = heap_.back();
+    heap_.pop_back();
+    release(slots_[(size_t)slot]);
+    free_.push_back(slot);
+  }
+}
+
+void SensorFusion::release(Held& h) {
+  const double sigma_z = h.sensor >= 0 && (size_t)h.sensor < cfg_.sensors.size()
+                           ? cfg_.sensors[(size_t)h.sensor].sigma_z : SensorModel().sigma_z;
+  if (!started_ || h.t >= time_) {
+    const double dt = started_ ? h.t - time_ : 0.0;
+    // The epsilon keeps a scan at k * frame from rounding into frame k - 1.
+    const double frame = cfg_.frame > 0.0 ? std::floor(h.t / cfg_.frame + 1e-6) : h.t;
+    if (started_ && frame != frame_) {
+      trk_.end_frame();
+      stats_.frames++;
+    }
+    if (!trk_.update_scan(h.z, dt, cfg_.sigma_a, sigma_z)) trk_.step(h.z, dt, cfg_.sigma_a, sigma_z);
+    time_ = h.t;
+    frame_ = frame;
+    started_ = true;
+    stats_.in_order++;
+    return;
+  }
+
+  const double lag = time_ - h.t;
+  if (lag > cfg_.max_oosm_lag) {
+    stats_.dropped_late++;
+    return;
+  }
+  const int updated = trk_.update_oosm(h.z, lag, sigma_z);
+  if (updated < 0) {
+    stats_.dropped_mode++;
+    return;
+  }
+  stats_.oosm++;
+  stats_.oosm_updates += (uint64_t)updated;
+}
@@ -0,0 +1,91 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include "tracker.h"
+
+// Measurement model of one sensor.
+struct SensorModel {
+  double sigma_z = 3.0; // position noise, meters (R = sigma_z^2 I)
+};
+
+struct FusionConfig {
+  // Hold each scan this long (seconds, by arrival clock) before it reaches
+  // the tracker, so scans that arrive out of order within the lag are fused
+  // in time order. 0 = release at once.
+  double lag = 0.0;
+  // A scan older than the tracker's time (it arrived after a newer scan was
+  // released) updates the tracks by retrodiction when at most this many
+  // seconds old, and is dropped beyond; 0 = always drop.
+  double max_oosm_lag = 1.0;
+  // Lifecycle frame (seconds): in-order scans whose times fall in the same
+  // [k frame, (k+1) frame) share one tick of the tracker's lifecycle, so
+  // M-of-N, max_misses and candidate aging count frames, not sensor scans.
+  // Set it to the fastest sensor's period. 0 = one tick per distinct scan
+  // time (same-time scans still share one).
+  double frame = 0.0;
+  double sigma_a = 1.5;
+  std::vector<SensorModel> sensors; // indexed by sensor id
+};
+
+struct FusionStats {
+  uint64_t scans = 0;        // ingested
+  uint64_t measurements = 0; // ingested
+  uint64_t in_order = 0;     // released to step()
+  uint64_t oosm = 0;         // released to update_oosm()
+  uint64_t oosm_updates = 0; // tracks those updated
+  uint64_t frames = 0;       // lifecycle ticks (MultiTargetTracker::end_frame)
+  uint64_t dropped_late = 0; // late scans older than max_oosm_lag
+  uint64_t dropped_mode = 0; // late scans in MHT and IMM modes, which cannot retrodict
+};
+
+// Asynchronous multi-sensor front end of a MultiTargetTracker.
+//
+// Scans are timestamped per sensor and held in a min-heap on (time, sensor,
+// arrival order) until the arrival clock passes their time + lag; then they
+// reach the tracker in time order, each as update_scan() with dt since the
+// previous scan and that sensor's sigma_z. The lifecycle ticks (end_frame())
+// once per frame, when the first scan of a later frame is released or on
+// flush(); in MHT mode every scan is a full step(). A scan released after a
+// newer one goes to update_oosm() instead, so no history is kept or replayed. Cost per scan is
+// O(log pending) plus the tracker step, so throughput follows the total
+// measurement rate, not the number of sensors. Scan buffers are pooled: no
+// allocation in steady state.
+class SensorFusion {
+public:
+  SensorFusion(MultiTargetTracker& tracker, const FusionConfig& cfg);
+
+  // A scan of sensor taken at time t, arriving at time now (>= t).
+  // Releases every held scan due by now.
+  void ingest(int sensor, double t, MeasSpan z, double now);
+  // Releases all held scans and closes the open frame (end of stream).
+  void flush();
+
+  // Time of the tracker's state: the newest scan released in order.
+  double time() const { return time_; }
+  size_t pending() const { return heap_.size(); }
+  const FusionStats& stats() const { return stats_; }
+
+private:
+  struct Held {
+    double t = 0.0;
+    int sensor = 0;
+    uint64_t seq = 0;
+    std::vector<Vec2> z;
+  };
+
+  MultiTargetTracker& trk_;
+  FusionConfig cfg_;
+  FusionStats stats_;
+  double time_ = 0.0;
+  double frame_ = 0.0; // frame of time_
+  bool started_ = false;
+  uint64_t seq_ = 0;
+
+  std::vector<Held> slots_;
+  std::vector<int> free_;
+  std::vector<int> heap_; // slot indices, min-heap on (t, sensor, seq)
+
+  bool before(int a, int b) const;
+  void release_until(double t);
+  void release(Held& h);
+};
@@ -0,0 +1,84 @@
+#include "gate_clusters.h"
+#include "scratch.h"
+#include <cstddef>
+
+namespace {
+
+int uf_find(std::vector<int>& parent, int x) {
+  while (parent[x] != x) {
+    parent[x] = parent[parent[x]]; // path halving
+    x = parent[x];
+  }
+  return x;
+}
+
+void uf_union(std::vector<int>& parent, int a, int b) {
+  a = uf_find(parent, a);
+  b = uf_find(parent, b);
+  if (a == b) return;
+  // Lower index becomes root so numbering does not depend on edge order.
+  if (a < b) parent[b] = a;
+  else parent[a] = b;
+}
+
+} // namespace
+
+void build_gate_clusters(const SparseCost& g, GateClusters& out) {
+  const int R = g.rows;
+  const int C = g.cols;
+
+  // Nodes: rows [0, R), cols [R, R + C).
+  std::vector<int>& parent = out.parent;
+  scratch_resize(parent, (size_t)(R + C));
+  for (int i = 0; i < R + C; ++i) parent[i] = i;
+  std::vector<char>& col_seen = out.col_seen;
+  scratch_assign(col_seen, (size_t)C, 0);
+
+  for (int r = 0; r < R; ++r) {
+    for (int e = g.row_start[r]; e < g.row_start[r + 1]; ++e) {
+      uf_union(parent, r, R + g.col[e]);
+      col_seen[g.col[e]] = 1;
+    }
+  }
+
+  // Number clusters by lowest row; roots are always rows (lowest node index).
+  std::vector<int>& cluster_of_root = out.cluster_of_root;
+  std::vector<int>& row_cluster = out.row_cluster;
+  scratch_assign(cluster_of_root, (size_t)R, -1);
+  scratch_assign(row_cluster, (size_t)R, -1);
+  int K = 0;
+  for (int r = 0; r < R; ++r) {
+    if (g.row_start[r] == g.row_start[r + 1]) continue;
+    const int root = uf_find(parent, r);
+    if (cluster_of_root[root] == -1) cluster_of_root[root] = K++;
+    row_cluster[r] = cluster_of_root[root];
+  }
+
+  scratch_assign(out.row_start, (size_t)K + 1, 0);
+  scratch_assign(out.col_start, (size_t)K + 1, 0);
+
+  std::vector<int>& col_cluster = out.col_cluster;
+  scratch_assign(col_cluster, (size_t)C, -1);
+  for (int c = 0; c < C; ++c) {
+    if (!col_seen[c]) continue;
+    col_cluster[c] = cluster_of_root[uf_find(parent, R + c)];
+  }
+
+  for (int r = 0; r < R; ++r) if (row_cluster[r] >= 0) out.row_start[row_cluster[r] + 1]++;
+  for (int c = 0; c < C; ++c) if (col_cluster[c] >= 0) out.col_start[col_cluster[c] + 1]++;
+  for (int k = 0; k < K; ++k) {
+    out.row_start[k + 1] += out.row_start[k];
+    out.col_start[k + 1] += out.col_start[k];
+  }
+
+  scratch_resize(out.rows, (size_t)out.row_start[K]);
+  scratch_resize(out.cols, (size_t)out.col_start[K]);
+
+  std::vector<int>& cursor = out.cursor;
+  scratch_reserve(cursor, out.row_start.size());
+  cursor.assign(out.row_start.begin(), out.row_start.end() - 1);
+  for (int r = 0; r < R; ++r) if (row_cluster[r] >= 0) out.rows[cursor[row_cluster[r]]++] = r;
+  scratch_reserve(cursor, out.col_start.size());
+  cursor.assign(out.col_start.begin(), out.col_start.end() - 1);
+  for (int c = 0; c < C; ++c) if (col_cluster[c] >= 0) out.cols[cursor[col_cluster[c]]++] = c;
+}
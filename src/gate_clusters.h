@@ -0,0 +1,47 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include "hungarian.h"
+#include "auction.h"
+#include "jpda.h"
+
+// Connected components of a gated bipartite track/measurement graph.
+// Built with union-find over the edges; rows/cols without edges belong to no cluster.
+// Cluster k owns rows[row_start[k] .. row_start[k+1]) and cols[col_start[k] .. col_start[k+1]),
+// both ascending. Clusters are numbered in order of their lowest row.
+struct GateClusters {
+  std::vector<int> row_start;
+  std::vector<int> rows;
+  std::vector<int> col_start;
+  std::vector<int> cols;
+
+  // build scratch
+  std::vector<int> parent;
+  std::vector<int> cluster_of_root;
+  std::vector<int> row_cluster;
+  std::vector<int> col_cluster;
+  std::vector<int> cursor;
+  std::vector<char> col_seen;
+
+  int count() const { return row_start.empty() ? 0 : (int)row_start.size() - 1; }
+  int num_rows(int k) const { return row_start[k + 1] - row_start[k]; }
+  int num_cols(int k) const { return col_start[k + 1] - col_start[k]; }
+};
+
+void build_gate_clusters(const SparseCost& g, GateClusters& out);
+
+// Scratch for clustered_min_cost, kept by the caller across scans.
+struct AssignWorkspace {
+  GateClusters clusters;
+  std::vector<int> col_local;
+  std::vector<SparseCost> sub;              // per worker
+  std::vector<SparseSolverScratch> solver;  // per worker
+
+  // clustered_auction
+  std::vector<AuctionScratch> auction;      // per worker
+  std::vector<uint64_t> auction_bids;       // per worker
+
+  // clustered_jpda
+  std::vector<JpdaScratch> jpda;            // per worker
+  std::vector<JpdaInfo> jpda_info;          // per worker
+};
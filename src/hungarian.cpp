@@ -1,4 +1,7 @@
 #include "hungarian.h"
+#include "scratch.h"
+#include "gate_clusters.h"
+#include "thread_pool.h"
 #include <algorithm>
 #include <limits>
 
@@ -8,31 +11,51 @@ std::vector<int> hungarian_min_cost(const std::vector<std::vector<double>>& cost
   const int n = (int)cost.size();
   const int m = (n > 0) ? (int)cost[0].size() : 0;
 
-  if (n == 0) return {};
-  if (m == 0) return std::vector<int>(n, -1);
+  std::vector<double> flat((size_t)n * (size_t)m);
+  for (int i = 0; i < n; ++i) std::copy(cost[i].begin(), cost[i].end(), flat.begin() + (size_t)i * m);
+
+  HungarianScratch ws;
+  std::vector<int> row_to_col;
+  hungarian_min_cost(flat.data(), n, m, ws, row_to_col);
+  return row_to_col;
+}
+
+void hungarian_min_cost(const double* cost, int n, int m,
+                        HungarianScratch& ws, std::vector<int>& row_to_col) {
+  if (n == 0) {
+    row_to_col.clear();
+    return;
+  }
+  scratch_assign(row_to_col, (size_t)n, -1);
+  if (m == 0) return;
 
   const int N = std::max(n, m);
   const double INF = 1e100;
 
-  // Build padded square matrix a[1..N][1..N]
-  std::vector<std::vector<double>> a(N + 1, std::vector<double>(N + 1, 0.0));
-  for (int i = 1; i <= N; ++i) {
-    for (int j = 1; j <= N; ++j) {
-      if (i <= n && j <= m) a[i][j] = cost[i - 1][j - 1];
-      else a[i][j] = 0.0; // padding cost; caller controls "validity" via large costs in original
-    }
-  }
+  // Padded square matrix a[1..N][1..N]: rows/cols beyond the input cost 0
+  // (caller controls "validity" via large costs in the original).
+  auto a = [&](int i, int j) {
+    return (i <= n && j <= m) ? cost[(size_t)(i - 1) * m + (j - 1)] : 0.0;
+  };
 
   // Potentials and matching
-  std::vector<double> u(N + 1, 0.0), v(N + 1, 0.0);
-  std::vector<int> p(N + 1, 0), way(N + 1, 0);
+  std::vector<double>& u = ws.u;
+  std::vector<double>& v = ws.v;
+  std::vector<int>& p = ws.p;
+  std::vector<int>& way = ws.way;
+  std::vector<double>& minv = ws.minv;
+  std::vector<char>& used = ws.used;
+  scratch_assign(u, (size_t)N + 1, 0.0);
+  scratch_assign(v, (size_t)N + 1, 0.0);
+  scratch_assign(p, (size_t)N + 1, 0);
+  scratch_assign(way, (size_t)N + 1, 0);
 
   // p[j] = matched row for column j
   for (int i = 1; i <= N; ++i) {
     p[0] = i;
     int j0 = 0;
-    std::vector<double> minv(N + 1, INF);
-    std::vector<char> used(N + 1, false);
+    scratch_assign(minv, (size_t)N + 1, INF);
+    scratch_assign(used, (size_t)N + 1, false);
 
     do {
       used[j0] = true;
@@ -42,7 +65,7 @@ std::vector<int> hungarian_min_cost(const std::vector<std::vector<double>>& cost
 
       for (int j = 1; j <= N; ++j) {
         if (used[j]) continue;
-        double cur = a[i0][j] - u[i0] - v[j];
+        double cur = a(i0, j) - u[i0] - v[j];
         if (cur < minv[j]) {
           minv[j] = cur;
           way[j] = j0;
@@ -74,9 +97,6 @@ std::vector<int> hungarian_min_cost(const std::vector<std::vector<double>>& cost
 
   // p[j] gives row matched to column j in padded square.
   // Convert to assignment for original rows (size n), with -1 for unassigned.
-  std::vector<int> row_to_col(n, -1);
-
-  // Build inverse: row->col
   for (int j = 1; j <= N; ++j) {
     int i = p[j];
     if (i >= 1 && i <= n) {
@@ -85,6 +105,169 @@ std::vector<int> hungarian_min_cost(const std::vector<std::vector<double>>& cost
       else row_to_col[i - 1] = -1;
     }
   }
+}
 
+// Successive shortest augmenting paths on the residual graph of the matching.
+// Row potentials of free rows stay 0, so the true length of a path ending at
+// column j is dist[j] + v[j]; each round augments along the cheapest one.
+std::vector<int> sparse_min_cost(const SparseCost& g) {
+  SparseSolverScratch ws;
+  std::vector<int> row_to_col;
+  sparse_min_cost(g, ws, row_to_col);
   return row_to_col;
-}
\ No newline at end of file
+}
+
+void sparse_min_cost(const SparseCost& g, SparseSolverScratch& ws, std::vector<int>& row_to_col) {
+  const int n = g.rows;
+  const int m = g.cols;
+  scratch_assign(row_to_col, (size_t)n, -1);
+  if (n == 0 || m == 0) return;
+
+  const double INF = std::numeric_limits<double>::infinity();
+
+  std::vector<int>& col_to_row = ws.col_to_row;
+  std::vector<double>& u = ws.u;
+  std::vector<double>& v = ws.v;
+  scratch_assign(col_to_row, (size_t)m, -1);
+  scratch_assign(u, (size_t)n, 0.0);
+  scratch_assign(v, (size_t)m, INF);
+
+  // Column potentials start at the cheapest incoming edge: reduced costs >= 0.
+  for (int e = 0; e < g.row_start[n]; ++e) v[g.col[e]] = std::min(v[g.col[e]], g.cost[e]);
+  for (int j = 0; j < m; ++j) if (v[j] == INF) v[j] = 0.0;
+
+  std::vector<double>& dist = ws.dist;
+  std::vector<int>& prev_row = ws.prev_row;
+  std::vector<char>& done = ws.done;
+  std::vector<double>& row_dist = ws.row_dist;
+  scratch_resize(dist, (size_t)m);
+  scratch_resize(prev_row, (size_t)m);
+  scratch_resize(done, (size_t)m);
+  scratch_resize(row_dist, (size_t)n);
+
+  using Item = SparseSolverScratch::HeapItem;
+  auto later = [](const Item& a, const Item& b) {
+    if (a.d != b.d) return a.d > b.d;
+    return a.j > b.j;
+  };
+  std::vector<Item>& heap = ws.heap;
+
+  for (;;) {
+    std::fill(dist.begin(), dist.end(), INF);
+    std::fill(done.begin(), done.end(), 0);
+    std::fill(row_dist.begin(), row_dist.end(), INF);
+    heap.clear();
+
+    auto relax_row = [&](int i, double di) {
+      row_dist[i] = di;
+      for (int e = g.row_start[i]; e < g.row_start[i + 1]; ++e) {
+        const int j = g.col[e];
+        if (done[j]) continue;
+        const double d = di + g.cost[e] + u[i] - v[j];
+        if (d < dist[j]) {
+          dist[j] = d;
+          prev_row[j] = i;
+          heap.push_back({d, j});
+          std::push_heap(heap.begin(), heap.end(), later);
+        }
+      }
+    };
+
+    bool any_free = false;
+    for (int i = 0; i < n; ++i) {
+      if (row_to_col[i] != -1) continue;
+      any_free = true;
+      relax_row(i, 0.0);
+    }
+    if (!any_free) break;
+
+    int best_j = -1;
+    double best_len = INF;
+    while (!heap.empty()) {
+      std::pop_heap(heap.begin(), heap.end(), later);
+      const Item it = heap.back();
+      heap.pop_back();
+      if (done[it.j] || it.d > dist[it.j]) continue;
+      done[it.j] = 1;
+
+      const int i = col_to_row[it.j];
+      if (i == -1) {
+        const double len = it.d + v[it.j];
+        if (len < best_len) {
+          best_len = len;
+          best_j = it.j;
+        }
+      } else {
+        // Matched edges are tight, so reaching the row costs nothing extra.
+        relax_row(i, it.d);
+      }
+    }
+    if (best_j == -1) break; // no augmenting path left: matching is maximum
+
+    // Keep reduced costs non-negative on everything still reachable.
+    for (int j = 0; j < m; ++j) if (done[j]) v[j] += dist[j];
+    for (int i = 0; i < n; ++i) if (row_dist[i] < INF) u[i] += row_dist[i];
+
+    for (int j = best_j;;) {
+      const int i = prev_row[j];
+      const int next = row_to_col[i];
+      row_to_col[i] = j;
+      col_to_row[j] = i;
+      if (next == -1) break;
+      j = next;
+    }
+  }
+}
+
+std::vector<int> clustered_min_cost(const SparseCost& g, ThreadPool* pool) {
+  AssignWorkspace ws;
+  std::vector<int> row_to_col;
+  clustered_min_cost(g, ws, row_to_col, pool);
+  return row_to_col;
+}
+
+void clustered_min_cost(const SparseCost& g, AssignWorkspace& ws,
+                        std::vector<int>& row_to_col, ThreadPool* pool) {
+  scratch_assign(row_to_col, (size_t)g.rows, -1);
+
+  GateClusters& cl = ws.clusters;
+  build_gate_clusters(g, cl);
+
+  // Clusters have disjoint columns, so one shared global->local map is race-free.
+  std::vector<int>& col_local = ws.col_local;
+  scratch_assign(col_local, (size_t)g.cols, -1);
+  const size_t workers = (size_t)(pool ? pool->size() : 1);
+  if (ws.sub.size() < workers) ws.sub.resize(workers);
+  if (ws.solver.size() < workers) ws.solver.resize(workers);
+
+  auto solve = [&](int begin, int end, int worker) {
+    SparseCost& sc = ws.sub[worker];
+    SparseSolverScratch& ss = ws.solver[worker];
+    for (int k = begin; k < end; ++k) {
+      const int* rows = cl.rows.data() + cl.row_start[k];
+      const int* cols = cl.cols.data() + cl.col_start[k];
+      const int nr = cl.num_rows(k);
+      const int nc = cl.num_cols(k);
+
+      for (int c = 0; c < nc; ++c) col_local[cols[c]] = c;
+
+      sc.reset(nr, nc);
+      for (int r = 0; r < nr; ++r) {
+        const int gr = rows[r];
+        for (int e = g.row_start[gr]; e < g.row_start[gr + 1]; ++e) {
+          sc.add(r, col_local[g.col[e]], g.cost[e]);
+        }
+      }
+      sc.finish();
+
+      sparse_min_cost(sc, ss, ss.row_to_col);
+      const std::vector<int>& a = ss.row_to_col;
+      for (int r = 0; r < nr; ++r) {
+        if (a[r] != -1) row_to_col[rows[r]] = cols[a[r]];
+      }
+    }
+  };
+
+  if (pool) pool->parallel_for(cl.count(), 8, solve);
+  else solve(0, cl.count(), 0);
+}
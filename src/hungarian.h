@@ -1,10 +1,85 @@
 #pragma once
 #include <vector>
 
+class ThreadPool;
+
 // Solve minimum-cost assignment using Hungarian algorithm.
 // Input: cost matrix with size rows x cols (rows=tracks, cols=measurements).
 // Output: assignment vector of size rows, where assignment[i] = j means row i assigned to col j,
 // or -1 means unassigned (when cols < rows or if caller uses large costs to represent invalid).
 //
 // Deterministic, O(n^3). Works for rectangular matrices by padding internally.
-std::vector<int> hungarian_min_cost(const std::vector<std::vector<double>>& cost);
\ No newline at end of file
+std::vector<int> hungarian_min_cost(const std::vector<std::vector<double>>& cost);
+
+// Reusable buffers for the dense solver.
+struct HungarianScratch {
+  std::vector<double> u, v, minv;
+  std::vector<int> p, way;
+  std::vector<char> used;
+};
+
+// Same solver on a flat row-major rows x cols matrix; allocation-free once
+// ws and row_to_col have grown to the problem size.
+void hungarian_min_cost(const double* cost, int rows, int cols,
+                        HungarianScratch& ws, std::vector<int>& row_to_col);
+
+// Sparse cost graph in CSR form: row r owns edges [row_start[r], row_start[r+1]).
+// Gated-out cells are simply absent.
+struct SparseCost {
+  int rows = 0;
+  int cols = 0;
+  std::vector<int> row_start;
+  std::vector<int> col;
+  std::vector<double> cost;
+
+  void reset(int rows_, int cols_) {
+    rows = rows_;
+    cols = cols_;
+    row_start.assign(1, 0);
+    col.clear();
+    cost.clear();
+  }
+  // Edges must be added row by row (rows in ascending order).
+  void add(int r, int c, double w) {
+    while ((int)row_start.size() <= r + 1) row_start.push_back((int)col.size());
+    col.push_back(c);
+    cost.push_back(w);
+    row_start[r + 1] = (int)col.size();
+  }
+  void finish() {
+    while ((int)row_start.size() <= rows) row_start.push_back((int)col.size());
+  }
+};
+
+// Minimum-cost maximum-cardinality matching over the edges of g only
+// (successive shortest augmenting paths, Dijkstra with potentials).
+// Same optimum as hungarian_min_cost with a huge cost in every missing cell,
+// without ever materializing those cells. Unmatched rows get -1.
+std::vector<int> sparse_min_cost(const SparseCost& g);
+
+// Reusable buffers for sparse_min_cost.
+struct SparseSolverScratch {
+  struct HeapItem {
+    double d;
+    int j;
+  };
+  std::vector<int> col_to_row, prev_row;
+  std::vector<double> u, v, dist, row_dist;
+  std::vector<char> done;
+  std::vector<HeapItem> heap;
+  std::vector<int> row_to_col;
+};
+
+void sparse_min_cost(const SparseCost& g, SparseSolverScratch& ws, std::vector<int>& row_to_col);
+
+// Splits g into connected components and solves each with sparse_min_cost.
+// For scenes of many well-separated tracks the components are tiny, so this
+// is close to linear in the number of gated pairs. With a pool, clusters are
+// solved in parallel; each writes only its own rows, so the result is the same.
+std::vector<int> clustered_min_cost(const SparseCost& g, ThreadPool* pool = nullptr);
+
+struct AssignWorkspace;
+
+// Same, reusing ws across calls (allocation-free in steady state).
+void clustered_min_cost(const SparseCost& g, AssignWorkspace& ws,
+                        std::vector<int>& row_to_col, ThreadPool* pool = nullptr);
@@ -0,0 +1,177 @@
+#include "imm.h"
+#include "checkpoint.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+const double kLog2Pi = 1.8378770664093453;
+
+// One model's slot as 14 scalars: x, y, vx, vy, then the upper triangle of P
+// row by row (p00 p01 p02 p03 p11 p12 p13 p22 p23 p33).
+constexpr int kSlot = 14;
+constexpr int kPIdx[4][4] = {{4, 5, 6, 7}, {5, 8, 9, 10}, {6, 9, 11, 12}, {7, 10, 12, 13}};
+
+void get(const TrackBank& b, size_t i, double* v) {
+  v[0] = b.x[i]; v[1] = b.y[i]; v[2] = b.vx[i]; v[3] = b.vy[i];
+  v[4] = b.p00[i]; v[5] = b.p01[i]; v[6] = b.p02[i]; v[7] = b.p03[i];
+  v[8] = b.p11[i]; v[9] = b.p12[i]; v[10] = b.p13[i];
+  v[11] = b.p22[i]; v[12] = b.p23[i];
+  v[13] = b.p33[i];
+}
+
+void put(TrackBank& b, size_t i, const double* v) {
+  b.x[i] = v[0]; b.y[i] = v[1]; b.vx[i] = v[2]; b.vy[i] = v[3];
+  b.p00[i] = v[4]; b.p01[i] = v[5]; b.p02[i] = v[6]; b.p03[i] = v[7];
+  b.p11[i] = v[8]; b.p12[i] = v[9]; b.p13[i] = v[10];
+  b.p22[i] = v[11]; b.p23[i] = v[12];
+  b.p33[i] = v[13];
+}
+
+// Moment-matched mixture of the model slots: sum w_m x_m, and
+// sum w_m (P_m + d_m d_m^T) with d_m = x_m - x.
+template <int Models>
+void mixture(const double (*in)[kSlot], const double* w, double* out) {
+  for (int k = 0; k < 4; ++k) {
+    out[k] = 0.0;
+    for (int m = 0; m < Models; ++m) out[k] += w[m] * in[m][k];
+  }
+  for (int k = 4; k < kSlot; ++k) out[k] = 0.0;
+  for (int m = 0; m < Models; ++m) {
+    double d[4];
+    for (int k = 0; k < 4; ++k) d[k] = in[m][k] - out[k];
+    for (int a = 0; a < 4; ++a) {
+      for (int c = a; c < 4; ++c) {
+        const int k = kPIdx[a][c];
+        out[k] += w[m] * (in[m][k] + d[a] * d[c]);
+      }
+    }
+  }
+}
+} // namespace
+
+void ImmBank::push_back(const KalmanCV2D& kf, const ImmParams& p) {
+  const size_t i = size();
+  resize(i + 1);
+  for (TrackBank& b : bank_) b.load(i, kf);
+  const double turn = 0.5 * (1.0 - p.init_cv);
+  mu_[i] = {p.init_cv, turn, turn};
+}
+
+void ImmBank::move(size_t from, size_t to) {
+  double v[kSlot];
+  for (TrackBank& b : bank_) {
+    get(b, from, v);
+    put(b, to, v);
+  }
+  mu_[to] = mu_[from];
+}
+
+void ImmBank::resize(size_t n) {
+  for (TrackBank& b : bank_) b.resize(n);
+  mu_.resize(n);
+}
+
+void ImmBank::predict(size_t begin, size_t end, double dt, double sigma_a, const ImmParams& p) {
+  // Transition matrix: stay with 1 - p_switch, else any other model.
+  const double stay = 1.0 - p.p_switch;
+  const double other = p.p_switch / (double)(kModels - 1);
+
+  // Mixing: model j starts from the mixture of all models weighted by
+  // P(was i | is j now), written back in place.
+  for (size_t t = begin; t < end; ++t) {
+    double in[kModels][kSlot];
+    for (int m = 0; m < kModels; ++m) get(bank_[m], t, in[m]);
+
+    Probs c;
+    for (int j = 0; j < kModels; ++j) {
+      c[j] = 0.0;
+      for (int i = 0; i < kModels; ++i) c[j] += (i == j ? stay : other) * mu_[t][i];
+    }
+    for (int j = 0; j < kModels; ++j) {
+      double w[kModels];
+      for (int i = 0; i < kModels; ++i) {
+        w[i] = c[j] > 0.0 ? (i == j ? stay : other) * mu_[t][i] / c[j] : (i == j ? 1.0 : 0.0);
+      }
+      double out[kSlot];
+      mixture<kModels>(in, w, out);
+      put(bank_[j], t, out);
+    }
+    mu_[t] = c;
+  }
+
+  predict_cv_batch(bank_[0], begin, end, dt, sigma_a);
+  predict_ct_batch(bank_[1], begin, end, dt, sigma_a, p.turn_rate);
+  predict_ct_batch(bank_[2], begin, end, dt, sigma_a, -p.turn_rate);
+}
+
+// Per model: S = P_pos + R, K = P H^T S^-1, x += K y, P -= K (H P) on the
+// upper triangle (the Symmetric form of KalmanCV2D::update_pos).
+void ImmBank::update(size_t i, const Vec2& z, double sigma_z) {
+  const double r = sigma_z * sigma_z;
+  double log_l[kModels];
+  double best = -std::numeric_limits<double>::infinity();
+  for (int m = 0; m < kModels; ++m) {
+    double v[kSlot];
+    get(bank_[m], i, v);
+    const double s00 = v[4] + r, s01 = v[5], s11 = v[8] + r;
+    const double det = s00 * s11 - s01 * s01;
+    const double i00 = s11 / det, i01 = -s01 / det, i11 = s00 / det;
+    const double y0 = z(0) - v[0], y1 = z(1) - v[1];
+    log_l[m] = -0.5 * (y0 * (i00 * y0 + i01 * y1) + y1 * (i01 * y0 + i11 * y1) + std::log(det)) - kLog2Pi;
+    best = std::max(best, log_l[m]);
+
+    // Column k of H P is (P_0k, P_1k).
+    double h0[4], h1[4], K[4][2];
+    for (int k = 0; k < 4; ++k) {
+      h0[k] = v[kPIdx[0][k]];
+      h1[k] = v[kPIdx[1][k]];
+      K[k][0] = h0[k] * i00 + h1[k] * i01;
+      K[k][1] = h0[k] * i01 + h1[k] * i11;
+    }
+    for (int k = 0; k < 4; ++k) v[k] += K[k][0] * y0 + K[k][1] * y1;
+    for (int a = 0; a < 4; ++a) {
+      for (int c = a; c < 4; ++c) v[kPIdx[a][c]] -= K[a][0] * h0[c] + K[a][1] * h1[c];
+    }
+    put(bank_[m], i, v);
+  }
+
+  // mu_j ~ c_j L_j, relative to the best likelihood so nothing underflows.
+  Probs mu;
+  double sum = 0.0;
+  for (int m = 0; m < kModels; ++m) {
+    mu[m] = mu_[i][m] * std::exp(log_l[m] - best);
+    sum += mu[m];
+  }
+  if (sum > 0.0) {
+    for (int m = 0; m < kModels; ++m) mu_[i][m] = mu[m] / sum;
+  }
+}
+
+void ImmBank::combine(size_t i, KalmanCV2D& kf) const {
+  double in[kModels][kSlot];
+  for (int m = 0; m < kModels; ++m) get(bank_[m], i, in[m]);
+  double out[kSlot];
+  mixture<kModels>(in, mu_[i].data(), out);
+
+  for (int k = 0; k < 4; ++k) kf.x(k) = out[k];
+  for (int a = 0; a < 4; ++a) {
+    for (int c = 0; c < 4; ++c) kf.P(a, c) = out[kPIdx[a][c]];
+  }
+}
+
+void ImmBank::save_state(StateWriter& w) const {
+  for (const TrackBank& b : bank_) b.save_state(w);
+  w.vec(mu_);
+}
+
+bool ImmBank::load_state(StateReader& r) {
+  for (TrackBank& b : bank_) {
+    if (!b.load_state(r)) return false;
+  }
+  if (!r.vec(mu_)) return false;
+  for (const TrackBank& b : bank_) {
+    if (b.size() != mu_.size()) return false;
+  }
+  return true;
+}
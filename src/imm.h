@@ -0,0 +1,58 @@
+#pragma once
+#include <array>
+#include <vector>
+#include <cstddef>
+#include "track_bank.h"
+
+// Motion model of MultiTargetTracker's filters.
+enum class MotionModel {
+  Cv,  // one constant-velocity filter per track
+  Imm, // interacting multiple models: CV and coordinated turns at +-turn_rate
+};
+
+struct ImmParams {
+  double turn_rate = 0.5; // rad/s of the two coordinated-turn models
+  double p_switch = 0.05; // per-scan probability of leaving the current model
+  double init_cv = 0.8;   // CV probability of a new track, the rest split over the turns
+};
+
+// IMM state of every track (Blom & Bar-Shalom 1988): CV, CT(+w), CT(-w).
+//
+// Model-major: each model keeps its states in its own TrackBank, indexed like
+// the tracker's tracks, so a model's predict is one flat column loop over a
+// range of tracks (predict_cv_batch / predict_ct_batch). Mixing, update and
+// combination work per track on the same slot of every bank. Nothing is
+// allocated per track.
+class ImmBank {
+public:
+  static constexpr int kModels = 3;
+  using Probs = std::array<double, kModels>;
+
+  size_t size() const { return mu_.size(); }
+
+  // Appends a track whose models all start at kf.
+  void push_back(const KalmanCV2D& kf, const ImmParams& p);
+  // Compaction: slot to takes slot from; then resize to the kept count.
+  void move(size_t from, size_t to);
+  void resize(size_t n);
+
+  // Mixing and model-conditioned predict of tracks [begin, end); mode
+  // probabilities become the predicted ones, which is also the result of a
+  // scan without a measurement.
+  void predict(size_t begin, size_t end, double dt, double sigma_a, const ImmParams& p);
+  // Model-conditioned update of track i with z; mode probabilities are
+  // reweighted by the model likelihoods.
+  void update(size_t i, const Vec2& z, double sigma_z);
+  // Moment-matched combination of track i into kf.x / kf.P.
+  void combine(size_t i, KalmanCV2D& kf) const;
+
+  const Probs& mode_probs(size_t i) const { return mu_[i]; }
+
+  // Checkpoint image of every model bank and the mode probabilities.
+  void save_state(StateWriter& w) const;
+  bool load_state(StateReader& r);
+
+private:
+  std::array<TrackBank, kModels> bank_;
+  std::vector<Probs> mu_; // per track: predicted, or updated after update()
+};
@@ -0,0 +1,191 @@
+#include "jpda.h"
+#include "gate_clusters.h"
+#include "thread_pool.h"
+#include "scratch.h"
+#include <algorithm>
+
+namespace {
+
+// Depth-first walk over the joint events; options of each row are sorted
+// best first, so the first leaf is the greedy event and a row's remaining
+// options can be cut as soon as one falls below the bound.
+struct EventWalk {
+  const SparseCost& g;
+  const JpdaParams& p;
+  JpdaScratch& ws;
+  int n;
+  int num_edges;
+  double best = 0.0;
+  double total = 0.0;
+  uint64_t events = 0;
+  bool aborted = false;
+
+  void leaf(double w) {
+    if (++events > p.max_events) {
+      aborted = true;
+      return;
+    }
+    best = std::max(best, w);
+    total += w;
+    for (int r = 0; r < n; ++r) {
+      const int e = ws.choice[r];
+      ws.acc[e == -1 ? (size_t)(num_edges + r) : (size_t)e] += w;
+    }
+  }
+
+  void walk(int r, double w) {
+    if (r == n) {
+      leaf(w);
+      return;
+    }
+    // Options of row r: its edges and the miss, at [row_start[r] + r, row_start[r + 1] + r + 1).
+    for (int k = g.row_start[r] + r; k < g.row_start[r + 1] + r + 1; ++k) {
+      const int e = ws.order[k];
+      const double wk = w * ws.w[k];
+      if (wk < p.prune * best) break;
+      if (e != -1) {
+        if (ws.col_used[g.col[e]]) continue;
+        ws.col_used[g.col[e]] = 1;
+      }
+      ws.choice[r] = e;
+      walk(r + 1, wk);
+      if (e != -1) ws.col_used[g.col[e]] = 0;
+      if (aborted) return;
+    }
+  }
+};
+
+void fitzgerald(const SparseCost& g, double miss_weight, JpdaScratch& ws, double* beta, double* beta0) {
+  const int n = g.rows;
+  scratch_assign(ws.row_sum, (size_t)n, 0.0);
+  scratch_assign(ws.col_sum, (size_t)g.cols, 0.0);
+  for (int r = 0; r < n; ++r) {
+    for (int e = g.row_start[r]; e < g.row_start[r + 1]; ++e) {
+      ws.row_sum[r] += g.cost[e];
+      ws.col_sum[g.col[e]] += g.cost[e];
+    }
+  }
+  for (int r = 0; r < n; ++r) {
+    // Each term is below G_ij / (S_i + miss_weight), so the row sums to < 1.
+    double assoc = 0.0;
+    for (int e = g.row_start[r]; e < g.row_start[r + 1]; ++e) {
+      const double G = g.cost[e];
+      beta[e] = G / (ws.row_sum[r] + ws.col_sum[g.col[e]] - G + miss_weight);
+      assoc += beta[e];
+    }
+    beta0[r] = 1.0 - assoc;
+  }
+}
+
+} // namespace
+
+bool jpda_marginals(const SparseCost& g, double miss_weight, const JpdaParams& p,
+                    JpdaScratch& ws, double* beta, double* beta0, uint64_t& events) {
+  const int n = g.rows;
+  const int num_edges = g.row_start[n];
+  if (n > p.max_exact_rows) {
+    fitzgerald(g, miss_weight, ws, beta, beta0);
+    return false;
+  }
+
+  // Options per row, scaled so the best is 1 and sorted best first.
+  scratch_resize(ws.order, (size_t)(num_edges + n));
+  scratch_resize(ws.w, (size_t)(num_edges + n));
+  for (int r = 0; r < n; ++r) {
+    const int b = g.row_start[r] + r;
+    const int end = g.row_start[r + 1] + r + 1;
+    double scale = miss_weight;
+    for (int e = g.row_start[r]; e < g.row_start[r + 1]; ++e) scale = std::max(scale, g.cost[e]);
+    for (int e = g.row_start[r]; e < g.row_start[r + 1]; ++e) ws.order[b + (e - g.row_start[r])] = e;
+    ws.order[end - 1] = -1;
+    auto weight = [&](int e) { return (e == -1 ? miss_weight : g.cost[e]) / scale; };
+    std::stable_sort(ws.order.begin() + b, ws.order.begin() + end,
+                     [&](int x, int y) { return weight(x) > weight(y); });
+    for (int k = b; k < end; ++k) ws.w[k] = weight(ws.order[k]);
+  }
+
+  scratch_assign(ws.col_used, (size_t)g.cols, 0);
+  scratch_resize(ws.choice, (size_t)n);
+  scratch_assign(ws.acc, (size_t)(num_edges + n), 0.0);
+
+  EventWalk walk{g, p, ws, n, num_edges};
+  walk.walk(0, 1.0);
+  events += walk.events;
+  if (walk.aborted) {
+    fitzgerald(g, miss_weight, ws, beta, beta0);
+    return false;
+  }
+
+  const double inv = 1.0 / walk.total;
+  for (int e = 0; e < num_edges; ++e) beta[e] = ws.acc[e] * inv;
+  for (int r = 0; r < n; ++r) beta0[r] = ws.acc[(size_t)(num_edges + r)] * inv;
+  return true;
+}
+
+JpdaInfo clustered_jpda(const SparseCost& g, double miss_weight, const JpdaParams& p,
+                        AssignWorkspace& ws, std::vector<double>& beta,
+                        std::vector<double>& beta0, ThreadPool* pool) {
+  scratch_assign(beta, (size_t)g.row_start[g.rows], 0.0);
+  scratch_assign(beta0, (size_t)g.rows, 1.0);
+
+  GateClusters& cl = ws.clusters;
+  build_gate_clusters(g, cl);
+
+  std::vector<int>& col_local = ws.col_local;
+  scratch_assign(col_local, (size_t)g.cols, -1);
+  const size_t workers = (size_t)(pool ? pool->size() : 1);
+  if (ws.sub.size() < workers) ws.sub.resize(workers);
+  if (ws.jpda.size() < workers) ws.jpda.resize(workers);
+  if (ws.jpda_info.size() < workers) ws.jpda_info.resize(workers);
+  std::fill(ws.jpda_info.begin(), ws.jpda_info.end(), JpdaInfo());
+
+  auto solve = [&](int begin, int end, int worker) {
+    SparseCost& sc = ws.sub[worker];
+    JpdaScratch& js = ws.jpda[worker];
+    JpdaInfo& info = ws.jpda_info[worker];
+    for (int k = begin; k < end; ++k) {
+      const int* rows = cl.rows.data() + cl.row_start[k];
+      const int* cols = cl.cols.data() + cl.col_start[k];
+      const int nr = cl.num_rows(k);
+      const int nc = cl.num_cols(k);
+
+      for (int c = 0; c < nc; ++c) col_local[cols[c]] = c;
+
+      sc.reset(nr, nc);
+      for (int r = 0; r < nr; ++r) {
+        const int gr = rows[r];
+        for (int e = g.row_start[gr]; e < g.row_start[gr + 1]; ++e) {
+          sc.add(r, col_local[g.col[e]], g.cost[e]);
+        }
+      }
+      sc.finish();
+
+      // Local edges keep each row's order, so they map back by offset.
+      scratch_resize(js.sub_beta, (size_t)sc.row_start[nr]);
+      scratch_resize(js.sub_beta0, (size_t)nr);
+      const bool exact = jpda_marginals(sc, miss_weight, p, js, js.sub_beta.data(),
+                                        js.sub_beta0.data(), info.events);
+      if (exact) info.exact_clusters++;
+      else info.approx_clusters++;
+
+      for (int r = 0; r < nr; ++r) {
+        const int gr = rows[r];
+        beta0[gr] = js.sub_beta0[r];
+        for (int e = sc.row_start[r]; e < sc.row_start[r + 1]; ++e) {
+          beta[g.row_start[gr] + (e - sc.row_start[r])] = js.sub_beta[e];
+        }
+      }
+    }
+  };
+
+  if (pool) pool->parallel_for(cl.count(), 8, solve);
+  else solve(0, cl.count(), 0);
+
+  JpdaInfo total;
+  for (size_t w = 0; w < workers; ++w) {
+    total.exact_clusters += ws.jpda_info[w].exact_clusters;
+    total.approx_clusters += ws.jpda_info[w].approx_clusters;
+    total.events += ws.jpda_info[w].events;
+  }
+  return total;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include "hungarian.h"
+
+class ThreadPool;
+struct AssignWorkspace;
+
+// Joint probabilistic data association (JPDA) marginals of one gated
+// track/measurement graph.
+//
+// g.cost[e] is the likelihood ratio of edge e, pd N(z; z_pred, S) / lambda,
+// and miss_weight the ratio of a missed detection, 1 - pd. A joint event gives
+// every row one of its columns or the miss, with no column taken twice, and
+// weighs the product of its choices. beta[e] is the probability of the
+// events that use edge e, beta0[r] that of the events where row r misses.
+//
+// Small clusters enumerate the events depth-first. The result does not change
+// when a row's options are all scaled by the same factor (every event holds
+// one option per row), so each row is scaled to a best option of 1; a
+// partial event can then only lose weight, and branches below
+// prune * (best complete event) are cut. Clusters with more than
+// max_exact_rows rows, or whose enumeration would pass max_events leaves, use
+// the approximation of Fitzgerald (1985):
+//   beta_ij = G_ij / (S_i + S_j - G_ij + miss_weight)
+// with S_i, S_j the row and column sums of G.
+struct JpdaParams {
+  int max_exact_rows = 10;
+  uint64_t max_events = 20000;
+  double prune = 1e-7;
+};
+
+struct JpdaScratch {
+  std::vector<int> order;       // options of each row (edges, -1 = miss), best first
+  std::vector<double> w;        // scaled weight per option
+  std::vector<char> col_used;
+  std::vector<int> choice;      // edge (or -1) per row on the DFS path
+  std::vector<double> acc;      // per edge, then per row miss
+  std::vector<double> row_sum, col_sum;
+  std::vector<double> sub_beta, sub_beta0; // clustered_jpda, per cluster
+};
+
+// Counters of one clustered_jpda() call.
+struct JpdaInfo {
+  int exact_clusters = 0;
+  int approx_clusters = 0;
+  uint64_t events = 0;  // complete joint events summed by exact clusters
+};
+
+// Marginals of one cluster. Returns false when it used the approximation.
+bool jpda_marginals(const SparseCost& g, double miss_weight, const JpdaParams& p,
+                    JpdaScratch& ws, double* beta, double* beta0, uint64_t& events);
+
+// Marginals over the connected components of g (see clustered_min_cost),
+// in parallel with a pool; beta is indexed like g's edges, beta0 like its rows
+// (1 for rows without edges). Same result for any thread count.
+JpdaInfo clustered_jpda(const SparseCost& g, double miss_weight, const JpdaParams& p,
+                        AssignWorkspace& ws, std::vector<double>& beta,
+                        std::vector<double>& beta0, ThreadPool* pool = nullptr);
@@ -1,47 +1,162 @@
 #include "kalman.h"
+#include "kalman_sqrt.h"
 
 KalmanCV2D::KalmanCV2D(double dt_, double sigma_a_, double sigma_z_)
   : dt(dt_), sigma_a(sigma_a_), sigma_z(sigma_z_) {}
 
 void KalmanCV2D::predict() {
-  Mat4 F = Mat4::Identity();
-  F(0,2) = dt;
-  F(1,3) = dt;
-
   // Continuous white-noise acceleration model discretized
   const double dt2 = dt * dt;
   const double dt3 = dt2 * dt;
   const double dt4 = dt2 * dt2;
-
-  Mat4 Q = Mat4::Zero();
   const double q = sigma_a * sigma_a;
-  Q(0,0) = dt4/4.0 * q; Q(0,2) = dt3/2.0 * q;
-  Q(1,1) = dt4/4.0 * q; Q(1,3) = dt3/2.0 * q;
-  Q(2,0) = dt3/2.0 * q; Q(2,2) = dt2 * q;
-  Q(3,1) = dt3/2.0 * q; Q(3,3) = dt2 * q;
+  const double q_pp = dt4/4.0 * q; // position-position
+  const double q_pv = dt3/2.0 * q; // position-velocity
+  const double q_vv = dt2 * q;     // velocity-velocity
 
-  x = F * x;
-  P = F * P * F.transpose() + Q;
+  // F = [I dt*I; 0 I] in closed form: no F, Q or 4x4 temporaries. The terms
+  // are those of F*P*F^T + Q without the exact zeros, so the result is
+  // bit-identical to the generic product and to predict_cv_batch(). All 16
+  // terms are kept: the standard (I-KH)P update leaves P slightly asymmetric.
+  x(0) = x(0) + dt * x(2);
+  x(1) = x(1) + dt * x(3);
+
+  // Rows of F*P: row 0 += dt * row 2, row 1 += dt * row 3.
+  double FP[2][4];
+  for (int j = 0; j < 4; ++j) {
+    FP[0][j] = P(0,j) + dt * P(2,j);
+    FP[1][j] = P(1,j) + dt * P(3,j);
+  }
+  // (F*P)*F^T: column 0 += dt * column 2, column 1 += dt * column 3.
+  for (int i = 0; i < 2; ++i) {
+    P(i,0) = FP[i][0] + dt * FP[i][2];
+    P(i,1) = FP[i][1] + dt * FP[i][3];
+    P(i,2) = FP[i][2];
+    P(i,3) = FP[i][3];
+  }
+  for (int i = 2; i < 4; ++i) {
+    P(i,0) = P(i,0) + dt * P(i,2);
+    P(i,1) = P(i,1) + dt * P(i,3);
+  }
+  P(0,0) += q_pp; P(0,2) += q_pv;
+  P(1,1) += q_pp; P(1,3) += q_pv;
+  P(2,0) += q_pv; P(2,2) += q_vv;
+  P(3,1) += q_pv; P(3,3) += q_vv;
 }
 
 void KalmanCV2D::update(const Vec2& z, Vec2* out_innovation, Mat2* out_S) {
-  Mat2x4 H;
-  H.setZero();
-  H(0,0) = 1.0;
-  H(1,1) = 1.0;
+  const InnovCov ic = innovation_cov();
+  update_pos(z, ic, CovUpdate::Standard, out_innovation);
+  if (out_S) *out_S = ic.S;
+}
+
+InnovCov KalmanCV2D::innovation_cov() const {
+  const double r = sigma_z * sigma_z;
+
+  InnovCov ic;
+  ic.S(0,0) = P(0,0) + r;
+  ic.S(0,1) = P(0,1) + 0.0;
+  ic.S(1,0) = P(1,0) + 0.0;
+  ic.S(1,1) = P(1,1) + r;
+
+  const double inv_det = 1.0 / (ic.S(0,0) * ic.S(1,1) - ic.S(1,0) * ic.S(0,1));
+  ic.S_inv(0,0) =  ic.S(1,1) * inv_det;
+  ic.S_inv(1,0) = -ic.S(1,0) * inv_det;
+  ic.S_inv(0,1) = -ic.S(0,1) * inv_det;
+  ic.S_inv(1,1) =  ic.S(0,0) * inv_det;
+  return ic;
+}
+
+void KalmanCV2D::update_pos(const Vec2& z, const InnovCov& ic, CovUpdate form, Vec2* out_innovation) {
+  // Factored here for this one update; callers that keep L across scans
+  // (MultiTargetTracker) call update_pos_sqrt directly. Falls through to
+  // Joseph when P has already lost definiteness.
+  if (form == CovUpdate::SquareRoot) {
+    Mat4 L;
+    if (cholesky4(P, L)) {
+      update_pos_sqrt(*this, L, z, out_innovation);
+      return;
+    }
+    form = CovUpdate::Joseph;
+  }
 
-  Mat2 R = Mat2::Identity() * (sigma_z * sigma_z);
+  const double y0 = z(0) - x(0);
+  const double y1 = z(1) - x(1);
 
-  Vec2 y = z - (H * x); // innovation
-  Mat2 S = H * P * H.transpose() + R;
+  // K = P H^T S^-1: H^T just selects the first two columns of P.
+  double K[4][2];
+  for (int i = 0; i < 4; ++i) {
+    K[i][0] = P(i,0) * ic.S_inv(0,0) + P(i,1) * ic.S_inv(1,0);
+    K[i][1] = P(i,0) * ic.S_inv(0,1) + P(i,1) * ic.S_inv(1,1);
+  }
 
-  // Kalman gain
-  Mat4x2 K = P * H.transpose() * S.inverse();
+  for (int i = 0; i < 4; ++i) x(i) = x(i) + (K[i][0] * y0 + K[i][1] * y1);
 
-  x = x + K * y;
-  Mat4 I = Mat4::Identity();
-  P = (I - K * H) * P;
+  if (form == CovUpdate::Standard) {
+    // (I - K H) P: rows 0/1 scale the position rows, rows 2/3 add to themselves.
+    double N[4][4];
+    for (int j = 0; j < 4; ++j) {
+      N[0][j] = (1.0 - K[0][0]) * P(0,j) - K[0][1] * P(1,j);
+      N[1][j] = (0.0 - K[1][0]) * P(0,j) + (1.0 - K[1][1]) * P(1,j);
+      N[2][j] = ((0.0 - K[2][0]) * P(0,j) - K[2][1] * P(1,j)) + P(2,j);
+      N[3][j] = ((0.0 - K[3][0]) * P(0,j) - K[3][1] * P(1,j)) + P(3,j);
+    }
+    for (int i = 0; i < 4; ++i) for (int j = 0; j < 4; ++j) P(i,j) = N[i][j];
+  } else if (form == CovUpdate::Symmetric) {
+    // P - K S K^T = P - K (H P): only the 10 upper terms, then mirror.
+    for (int i = 0; i < 4; ++i) {
+      for (int j = i; j < 4; ++j) {
+        P(i,j) = P(i,j) - (K[i][0] * P(j,0) + K[i][1] * P(j,1));
+      }
+    }
+    for (int i = 1; i < 4; ++i) for (int j = 0; j < i; ++j) P(i,j) = P(j,i);
+  } else {
+    // Joseph: M = (I - K H) P, then M (I - K H)^T + r K K^T on the upper triangle.
+    const double r = sigma_z * sigma_z;
+    double M[4][4];
+    for (int j = 0; j < 4; ++j) {
+      for (int i = 0; i < 4; ++i) {
+        M[i][j] = P(i,j) - (K[i][0] * P(0,j) + K[i][1] * P(1,j));
+      }
+    }
+    for (int i = 0; i < 4; ++i) {
+      for (int j = i; j < 4; ++j) {
+        // Row j of (I - K H) is e_j - [K_j0, K_j1, 0, 0].
+        const double mkt = M[i][0] * K[j][0] + M[i][1] * K[j][1];
+        const double kkt = K[i][0] * K[j][0] + K[i][1] * K[j][1];
+        P(i,j) = (M[i][j] - mkt) + r * kkt;
+      }
+    }
+    for (int i = 1; i < 4; ++i) for (int j = 0; j < i; ++j) P(i,j) = P(j,i);
+  }
+
+  if (out_innovation) *out_innovation = Vec2(y0, y1);
+}
 
-  if (out_innovation) *out_innovation = y;
-  if (out_S) *out_S = S;
-}
\ No newline at end of file
+void KalmanCV2D::update_pda(const Vec2& nu, const Mat2& spread, double beta0, const InnovCov& ic) {
+  double K[4][2];
+  for (int i = 0; i < 4; ++i) {
+    K[i][0] = P(i,0) * ic.S_inv(0,0) + P(i,1) * ic.S_inv(1,0);
+    K[i][1] = P(i,0) * ic.S_inv(0,1) + P(i,1) * ic.S_inv(1,1);
+  }
+
+  for (int i = 0; i < 4; ++i) x(i) = x(i) + (K[i][0] * nu(0) + K[i][1] * nu(1));
+
+  // K S K^T = K (H P); K spread K^T through KD = K spread. Upper triangle
+  // from the prior P, then mirror.
+  const Mat4 P0 = P;
+  const double w = 1.0 - beta0;
+  double KD[4][2];
+  for (int i = 0; i < 4; ++i) {
+    KD[i][0] = K[i][0] * spread(0,0) + K[i][1] * spread(1,0);
+    KD[i][1] = K[i][0] * spread(0,1) + K[i][1] * spread(1,1);
+  }
+  for (int i = 0; i < 4; ++i) {
+    for (int j = i; j < 4; ++j) {
+      const double ksk = K[i][0] * P0(0,j) + K[i][1] * P0(1,j);
+      const double kdk = KD[i][0] * K[j][0] + KD[i][1] * K[j][1];
+      P(i,j) = P0(i,j) - w * ksk + kdk;
+    }
+  }
+  for (int i = 1; i < 4; ++i) for (int j = 0; j < i; ++j) P(i,j) = P(j,i);
+}
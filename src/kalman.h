@@ -1,6 +1,29 @@
 #pragma once
 #include "math_types.h"
 
+// Innovation covariance of a position-only measurement (H = [I 0]):
+// S = P_pos + R and S^-1 from 2x2 cofactors. Computed once per track and
+// shared by gating and the update.
+struct InnovCov {
+  Mat2 S = Mat2::Zero();
+  Mat2 S_inv = Mat2::Zero();
+};
+
+// Covariance update form used by KalmanCV2D::update_pos().
+enum class CovUpdate {
+  Standard,  // P = (I - K H) P, same arithmetic as update()
+  Symmetric, // P = P - K S K^T on the upper triangle, mirrored
+  Joseph,    // P = (I - K H) P (I - K H)^T + K R K^T, upper triangle, mirrored
+  SquareRoot, // Potter update of a Cholesky factor of P, P = L L^T (kalman_sqrt.h)
+};
+
+// Squared Mahalanobis distance y^T S^-1 y.
+inline double maha2(const InnovCov& ic, const Vec2& y) {
+  const double t0 = y(0) * ic.S_inv(0,0) + y(1) * ic.S_inv(1,0);
+  const double t1 = y(0) * ic.S_inv(0,1) + y(1) * ic.S_inv(1,1);
+  return t0 * y(0) + t1 * y(1);
+}
+
 struct KalmanCV2D {
   // State: [x, y, vx, vy]
   Vec4 x = Vec4::Zero();
@@ -20,4 +43,17 @@ struct KalmanCV2D {
   void predict();
   // z = [x_meas, y_meas]
   void update(const Vec2& z, Vec2* out_innovation = nullptr, Mat2* out_S = nullptr);
-};
\ No newline at end of file
+
+  InnovCov innovation_cov() const;
+
+  // Update specialized for H = [I 0] and R = sigma_z^2 I, reusing S / S^-1
+  // from gating. Works on scalars: no H, R, 4x2 gain or 4x4 temporaries.
+  void update_pos(const Vec2& z, const InnovCov& ic, CovUpdate form, Vec2* out_innovation = nullptr);
+
+  // Probabilistic data association update with the same H, R and S:
+  // nu = sum_j beta_j nu_j is the combined innovation of the gated
+  // measurements, spread = sum_j beta_j nu_j nu_j^T - nu nu^T, and beta0 the
+  // probability that none of them is the target's.
+  //   x += K nu,  P -= (1 - beta0) K S K^T - K spread K^T
+  void update_pda(const Vec2& nu, const Mat2& spread, double beta0, const InnovCov& ic);
+};
@@ -0,0 +1,132 @@
+#include "kalman_info.h"
+#include "kalman_sqrt.h"
+
+namespace {
+
+// Inverse of a symmetric positive-definite 4x4 through its Cholesky factor:
+// A^-1 = L^-T L^-1, upper triangle mirrored.
+bool spd_inverse4(const Mat4& A, Mat4& inv) {
+  Mat4 L;
+  if (!cholesky4(A, L)) return false;
+  double W[4][4] = {}; // L^-1, lower triangular
+  for (int j = 0; j < 4; ++j) {
+    W[j][j] = 1.0 / L(j,j);
+    for (int i = j + 1; i < 4; ++i) {
+      double s = 0.0;
+      for (int k = j; k < i; ++k) s += L(i,k) * W[k][j];
+      W[i][j] = -s / L(i,i);
+    }
+  }
+  for (int i = 0; i < 4; ++i) {
+    for (int j = i; j < 4; ++j) {
+      double s = 0.0;
+      for (int k = j; k < 4; ++k) s += W[k][i] * W[k][j];
+      inv(i,j) = s;
+    }
+  }
+  for (int i = 1; i < 4; ++i) for (int j = 0; j < i; ++j) inv(i,j) = inv(j,i);
+  return true;
+}
+
+} // namespace
+
+InfoCV2D::InfoCV2D(const KalmanCV2D& kf) : dt(kf.dt), sigma_a(kf.sigma_a) {
+  if (spd_inverse4(kf.P, Y)) {
+    for (int i = 0; i < 4; ++i) {
+      double s = 0.0;
+      for (int k = 0; k < 4; ++k) s += Y(i,k) * kf.x(k);
+      y(i) = s;
+    }
+  } else {
+    Y.setZero();
+  }
+}
+
+void InfoCV2D::predict() {
+  // A = Y F^-1 (F^-1 subtracts dt times columns 0/1 from columns 2/3), then
+  // M = F^-T A on the upper triangle.
+  double A[4][4];
+  for (int i = 0; i < 4; ++i) {
+    A[i][0] = Y(i,0);
+    A[i][1] = Y(i,1);
+    A[i][2] = Y(i,2) - dt * Y(i,0);
+    A[i][3] = Y(i,3) - dt * Y(i,1);
+  }
+  double M[4][4];
+  for (int j = 0; j < 4; ++j) {
+    M[0][j] = A[0][j];
+    M[1][j] = A[1][j];
+    M[2][j] = A[2][j] - dt * A[0][j];
+    M[3][j] = A[3][j] - dt * A[1][j];
+  }
+  for (int i = 1; i < 4; ++i) for (int j = 0; j < i; ++j) M[i][j] = M[j][i];
+
+  // u = F^-T y
+  double u[4] = {y(0), y(1), y(2) - dt * y(0), y(3) - dt * y(1)};
+
+  const double q = sigma_a * sigma_a;
+  if (q == 0.0) {
+    for (int i = 0; i < 4; ++i) {
+      y(i) = u[i];
+      for (int j = 0; j < 4; ++j) Y(i,j) = M[i][j];
+    }
+    return;
+  }
+
+  // MG = M G with G = [h I; dt I], h = dt^2 / 2.
+  const double h = 0.5 * dt * dt;
+  double MG[4][2];
+  for (int i = 0; i < 4; ++i) {
+    MG[i][0] = h * M[i][0] + dt * M[i][2];
+    MG[i][1] = h * M[i][1] + dt * M[i][3];
+  }
+  const double c00 = h * MG[0][0] + dt * MG[2][0] + 1.0 / q;
+  const double c01 = h * MG[0][1] + dt * MG[2][1];
+  const double c11 = h * MG[1][1] + dt * MG[3][1] + 1.0 / q;
+  const double inv_det = 1.0 / (c00 * c11 - c01 * c01);
+  const double i00 = c11 * inv_det, i01 = -c01 * inv_det, i11 = c00 * inv_det;
+
+  // MC = M G C^-1
+  double MC[4][2];
+  for (int i = 0; i < 4; ++i) {
+    MC[i][0] = MG[i][0] * i00 + MG[i][1] * i01;
+    MC[i][1] = MG[i][0] * i01 + MG[i][1] * i11;
+  }
+  for (int i = 0; i < 4; ++i) {
+    for (int j = i; j < 4; ++j) Y(i,j) = M[i][j] - (MC[i][0] * MG[j][0] + MC[i][1] * MG[j][1]);
+  }
+  for (int i = 1; i < 4; ++i) for (int j = 0; j < i; ++j) Y(i,j) = Y(j,i);
+
+  const double gu0 = h * u[0] + dt * u[2];
+  const double gu1 = h * u[1] + dt * u[3];
+  for (int i = 0; i < 4; ++i) y(i) = u[i] - (MC[i][0] * gu0 + MC[i][1] * gu1);
+}
+
+void InfoCV2D::fuse(const Vec2& z, double sigma_z) {
+  fuse(&z, 1, sigma_z);
+}
+
+void InfoCV2D::fuse(const Vec2* z, int n, double sigma_z) {
+  const double r_inv = 1.0 / (sigma_z * sigma_z);
+  double s0 = 0.0, s1 = 0.0;
+  for (int k = 0; k < n; ++k) {
+    s0 += z[k](0);
+    s1 += z[k](1);
+  }
+  Y(0,0) += n * r_inv;
+  Y(1,1) += n * r_inv;
+  y(0) += s0 * r_inv;
+  y(1) += s1 * r_inv;
+}
+
+bool InfoCV2D::to_kf(KalmanCV2D& kf) const {
+  Mat4 P;
+  if (!spd_inverse4(Y, P)) return false;
+  kf.P = P;
+  for (int i = 0; i < 4; ++i) {
+    double s = 0.0;
+    for (int k = 0; k < 4; ++k) s += P(i,k) * y(k);
+    kf.x(i) = s;
+  }
+  return true;
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include "kalman.h"
+
+// Information form of KalmanCV2D: Y = P^-1 and y = P^-1 x.
+//
+// Measurements of one instant fuse by addition, Y += H^T R^-1 H and
+// y += H^T R^-1 z, in any number and order and with no inverse, so fusing n
+// sensors costs n additions against n covariance updates. A filter can also
+// start from no information at all (Y = 0).
+//
+// predict() is the information-form predict with the CV noise Q = q G G^T
+// (G is 4x2, see kalman_sqrt.h): with M = F^-T Y F^-1 and
+// C = G^T M G + I / q,
+//   Y = M - M G C^-1 G^T M,  y = (I - M G C^-1 G^T) F^-T y,
+// which only inverts the 2x2 C. Fixed-size scalar kernels, no allocation.
+struct InfoCV2D {
+  Vec4 y = Vec4::Zero();
+  Mat4 Y = Mat4::Zero();
+
+  double dt = 0.05;
+  double sigma_a = 1.5;
+
+  InfoCV2D() = default;
+  // From a covariance-form filter; Y = 0 if kf.P is not positive definite.
+  explicit InfoCV2D(const KalmanCV2D& kf);
+
+  void predict();
+  // One position measurement with noise sigma_z, or n of them.
+  void fuse(const Vec2& z, double sigma_z);
+  void fuse(const Vec2* z, int n, double sigma_z);
+
+  // kf.x = Y^-1 y and kf.P = Y^-1. Returns false (kf untouched) while Y is
+  // singular, i.e. the state is not observable yet.
+  bool to_kf(KalmanCV2D& kf) const;
+};
@@ -0,0 +1,138 @@
+#include "kalman_nd.h"
+
+template <typename Model>
+void KalmanND<Model>::predict() {
+  constexpr int D = Model::kDim;
+  constexpr int O = Model::kOrder;
+
+  // f[k] = dt^k / k!, the coefficient of block superdiagonal k of F.
+  double f[3];
+  f[0] = 1.0;
+  f[1] = dt;
+  f[2] = dt * dt / 2.0;
+  // Noise gain per derivative: G = [dt^2/2, dt, 1].
+  const double g[3] = {f[2], f[1], 1.0};
+  const double q = sigma_a * sigma_a;
+
+  // x <- F x, rows in ascending order: row block a only reads blocks b >= a.
+  for (int a = 0; a < O; ++a) {
+    for (int i = 0; i < D; ++i) {
+      double v = x(a * D + i);
+      for (int b = a + 1; b < O; ++b) v += f[b - a] * x(b * D + i);
+      x(a * D + i) = v;
+    }
+  }
+
+  // A = F P, then P = A F^T + Q on the upper triangle.
+  double A[N][N];
+  for (int a = 0; a < O; ++a) {
+    for (int i = 0; i < D; ++i) {
+      for (int c = 0; c < N; ++c) {
+        double v = P(a * D + i, c);
+        for (int b = a + 1; b < O; ++b) v += f[b - a] * P(b * D + i, c);
+        A[a * D + i][c] = v;
+      }
+    }
+  }
+  for (int r = 0; r < N; ++r) {
+    for (int a = 0; a < O; ++a) {
+      for (int i = 0; i < D; ++i) {
+        const int c = a * D + i;
+        if (c < r) continue;
+        double v = A[r][c];
+        for (int b = a + 1; b < O; ++b) v += f[b - a] * A[r][b * D + i];
+        // Q couples derivatives of the same axis only.
+        if (r % D == i) v += q * g[r / D] * g[a];
+        P(r, c) = v;
+      }
+    }
+  }
+  for (int i = 1; i < N; ++i) for (int j = 0; j < i; ++j) P(i,j) = P(j,i);
+}
+
+template <typename Model>
+auto KalmanND<Model>::innovation_cov() const -> InnovCovN<M> {
+  const double r = sigma_z * sigma_z;
+  InnovCovN<M> ic;
+  ic.S = P.template topLeftCorner<M, M>();
+  for (int a = 0; a < M; ++a) ic.S(a,a) += r;
+  // Closed-form cofactor inverse for fixed sizes up to 4x4.
+  ic.S_inv = ic.S.inverse();
+  return ic;
+}
+
+template <typename Model>
+void KalmanND<Model>::update_pos(const MeasVec& z, const InnovCovN<M>& ic, CovUpdate form,
+                                 MeasVec* out_innovation) {
+  double y[M];
+  for (int m = 0; m < M; ++m) y[m] = z(m) - x(m);
+
+  // K = P H^T S^-1: H^T selects the first M columns of P.
+  double K[N][M];
+  for (int i = 0; i < N; ++i) {
+    for (int m = 0; m < M; ++m) {
+      double k = 0.0;
+      for (int l = 0; l < M; ++l) k += P(i,l) * ic.S_inv(l,m);
+      K[i][m] = k;
+    }
+  }
+  for (int i = 0; i < N; ++i) {
+    double dx = 0.0;
+    for (int m = 0; m < M; ++m) dx += K[i][m] * y[m];
+    x(i) += dx;
+  }
+
+  if (form == CovUpdate::Standard) {
+    // (I - K H) P: every row subtracts K's row times the position rows of P.
+    double Nm[N][N];
+    for (int i = 0; i < N; ++i) {
+      for (int j = 0; j < N; ++j) {
+        double kp = 0.0;
+        for (int m = 0; m < M; ++m) kp += K[i][m] * P(m,j);
+        Nm[i][j] = P(i,j) - kp;
+      }
+    }
+    for (int i = 0; i < N; ++i) for (int j = 0; j < N; ++j) P(i,j) = Nm[i][j];
+  } else if (form == CovUpdate::Symmetric) {
+    // P - K (H P) on the upper triangle, then mirror.
+    for (int i = 0; i < N; ++i) {
+      for (int j = i; j < N; ++j) {
+        double kp = 0.0;
+        for (int m = 0; m < M; ++m) kp += K[i][m] * P(j,m);
+        P(i,j) -= kp;
+      }
+    }
+    for (int i = 1; i < N; ++i) for (int j = 0; j < i; ++j) P(i,j) = P(j,i);
+  } else {
+    // Joseph: W = (I - K H) P, then W (I - K H)^T + r K K^T on the upper triangle.
+    const double r = sigma_z * sigma_z;
+    double W[N][N];
+    for (int i = 0; i < N; ++i) {
+      for (int j = 0; j < N; ++j) {
+        double kp = 0.0;
+        for (int m = 0; m < M; ++m) kp += K[i][m] * P(m,j);
+        W[i][j] = P(i,j) - kp;
+      }
+    }
+    for (int i = 0; i < N; ++i) {
+      for (int j = i; j < N; ++j) {
+        double wkt = 0.0, kkt = 0.0;
+        for (int m = 0; m < M; ++m) {
+          wkt += W[i][m] * K[j][m];
+          kkt += K[i][m] * K[j][m];
+        }
+        P(i,j) = (W[i][j] - wkt) + r * kkt;
+      }
+    }
+    for (int i = 1; i < N; ++i) for (int j = 0; j < i; ++j) P(i,j) = P(j,i);
+  }
+
+  if (out_innovation) {
+    for (int m = 0; m < M; ++m) (*out_innovation)(m) = y[m];
+  }
+}
+
+template struct KalmanND<CV2>;
+template struct KalmanND<CV3>;
+template struct KalmanND<CA2>;
+template struct KalmanND<CA3>;
@@ -0,0 +1,92 @@
+#pragma once
+#include "math_types.h"
+#include "kalman.h"
+
+// Kinematic model of D position axes and Order - 1 derivatives (2 = constant
+// velocity, 3 = constant acceleration), stored derivative-major:
+// [p_0 .. p_D-1, v_0 .. v_D-1, (a_0 .. a_D-1)]. KinematicModel<2, 2> has the
+// [x, y, vx, vy] layout of KalmanCV2D. The measurement is the position,
+// H = [I 0].
+template <int D, int Order>
+struct KinematicModel {
+  static_assert(D >= 1, "at least one position axis");
+  static_assert(Order == 2 || Order == 3, "CV (Order 2) or CA (Order 3)");
+  static constexpr int kDim = D;
+  static constexpr int kOrder = Order;
+  static constexpr int N = D * Order; // state
+  static constexpr int M = D;         // measurement
+};
+
+template <int D>
+using CvModel = KinematicModel<D, 2>;
+template <int D>
+using CaModel = KinematicModel<D, 3>;
+
+using CV2 = CvModel<2>;
+using CV3 = CvModel<3>;
+using CA2 = CaModel<2>;
+using CA3 = CaModel<3>;
+
+// S = P_pos + R and S^-1 for M position axes (InnovCov for any M).
+template <int M>
+struct InnovCovN {
+  MatN<M, M> S = MatN<M, M>::Zero();
+  MatN<M, M> S_inv = MatN<M, M>::Zero();
+};
+
+// Squared Mahalanobis distance y^T S^-1 y from the upper triangle of S^-1.
+template <int M>
+inline double maha2(const InnovCovN<M>& ic, const VecN<M>& y) {
+  double s = 0.0;
+  for (int a = 0; a < M; ++a) {
+    double t = ic.S_inv(a,a) * y(a);
+    for (int b = a + 1; b < M; ++b) t += 2.0 * ic.S_inv(a,b) * y(b);
+    s += t * y(a);
+  }
+  return s;
+}
+
+// Kalman filter of a KinematicModel, with KalmanCV2D's interface and update
+// forms. Every kernel loops over compile-time bounds on fixed-size matrices,
+// so each model gets its own unrolled code and nothing is allocated.
+// Instantiated in kalman_nd.cpp for CV2, CV3, CA2 and CA3.
+//
+// Process noise is white acceleration entering through G = [dt^2/2, dt]
+// (CV) or [dt^2/2, dt, 1] (CA) on each axis. For CV, sigma_a is the
+// acceleration std as in KalmanCV2D; for CA (Bar-Shalom's Wiener-process
+// acceleration model) it is the std of the acceleration change per scan.
+template <typename Model>
+struct KalmanND {
+  static constexpr int N = Model::N;
+  static constexpr int M = Model::M;
+  using StateVec = VecN<N>;
+  using StateMat = MatN<N, N>;
+  using MeasVec = VecN<M>;
+
+  StateVec x = StateVec::Zero();
+  StateMat P = StateMat::Identity();
+
+  double dt = 0.05;
+  double sigma_a = 1.5;
+  double sigma_z = 3.0;
+
+  KalmanND() = default;
+  KalmanND(double dt_, double sigma_a_, double sigma_z_) : dt(dt_), sigma_a(sigma_a_), sigma_z(sigma_z_) {}
+
+  // F is I plus dt^k / k! on the k-th block superdiagonal, so F P F^T only
+  // multiplies the nonzero blocks; P is formed on the upper triangle and
+  // mirrored.
+  void predict();
+
+  InnovCovN<M> innovation_cov() const;
+
+  // Update with H = [I 0] and R = sigma_z^2 I, reusing S / S^-1 from
+  // gating. SquareRoot runs as Joseph: the square-root kernels are 4x4 only.
+  void update_pos(const MeasVec& z, const InnovCovN<M>& ic, CovUpdate form, MeasVec* out_innovation = nullptr);
+  void update(const MeasVec& z, MeasVec* out_innovation = nullptr) {
+    update_pos(z, innovation_cov(), CovUpdate::Standard, out_innovation);
+  }
+};
+
+using KalmanCV3D = KalmanND<CV3>;
+using KalmanCA3D = KalmanND<CA3>;
@@ -0,0 +1,108 @@
+#include "kalman_sqrt.h"
+#include <cmath>
+
+bool cholesky4(const Mat4& P, Mat4& L) {
+  L.setZero();
+  for (int j = 0; j < 4; ++j) {
+    double d = P(j,j);
+    for (int k = 0; k < j; ++k) d -= L(j,k) * L(j,k);
+    if (!(d > 0.0)) return false;
+    const double ljj = std::sqrt(d);
+    L(j,j) = ljj;
+    for (int i = j + 1; i < 4; ++i) {
+      double s = P(i,j);
+      for (int k = 0; k < j; ++k) s -= L(i,k) * L(j,k);
+      L(i,j) = s / ljj;
+    }
+  }
+  return true;
+}
+
+void outer4(const Mat4& L, Mat4& P) {
+  for (int i = 0; i < 4; ++i) {
+    for (int j = i; j < 4; ++j) {
+      double s = 0.0;
+      for (int k = 0; k < 4; ++k) s += L(i,k) * L(j,k);
+      P(i,j) = s;
+    }
+  }
+  for (int i = 1; i < 4; ++i) for (int j = 0; j < i; ++j) P(i,j) = P(j,i);
+}
+
+void predict_sqrt(KalmanCV2D& kf, Mat4& L) {
+  const double dt = kf.dt;
+  const double sq = std::fabs(kf.sigma_a);
+
+  // M = [F L, sqrt(q) G]^T, 6x4. Row c of M is column c of the pre-array.
+  double M[6][4];
+  for (int c = 0; c < 4; ++c) {
+    M[c][0] = L(0,c) + dt * L(2,c);
+    M[c][1] = L(1,c) + dt * L(3,c);
+    M[c][2] = L(2,c);
+    M[c][3] = L(3,c);
+  }
+  const double g_pos = 0.5 * dt * dt * sq;
+  const double g_vel = dt * sq;
+  M[4][0] = g_pos; M[4][1] = 0.0;   M[4][2] = g_vel; M[4][3] = 0.0;
+  M[5][0] = 0.0;   M[5][1] = g_pos; M[5][2] = 0.0;   M[5][3] = g_vel;
+
+  // Householder QR of M; M^T M = R^T R, so L = R^T.
+  for (int k = 0; k < 4; ++k) {
+    double norm2 = 0.0;
+    for (int i = k; i < 6; ++i) norm2 += M[i][k] * M[i][k];
+    if (norm2 == 0.0) continue;
+    const double alpha = M[k][k] > 0.0 ? -std::sqrt(norm2) : std::sqrt(norm2);
+    double v[6];
+    for (int i = k; i < 6; ++i) v[i] = M[i][k];
+    v[k] -= alpha;
+    double vn2 = 0.0;
+    for (int i = k; i < 6; ++i) vn2 += v[i] * v[i];
+    if (vn2 == 0.0) continue;
+    for (int j = k; j < 4; ++j) {
+      double s = 0.0;
+      for (int i = k; i < 6; ++i) s += v[i] * M[i][j];
+      const double f = 2.0 * s / vn2;
+      for (int i = k; i < 6; ++i) M[i][j] -= f * v[i];
+    }
+  }
+
+  // Row k of R, sign-flipped for a positive diagonal, is column k of L.
+  for (int k = 0; k < 4; ++k) {
+    const double sign = M[k][k] < 0.0 ? -1.0 : 1.0;
+    for (int i = 0; i < 4; ++i) L(i,k) = i < k ? 0.0 : sign * M[k][i];
+  }
+
+  kf.x(0) += dt * kf.x(2);
+  kf.x(1) += dt * kf.x(3);
+  outer4(L, kf.P);
+}
+
+void update_pos_sqrt(KalmanCV2D& kf, Mat4& L, const Vec2& z, Vec2* out_innovation) {
+  const double r = kf.sigma_z * kf.sigma_z;
+  const double y0 = z(0) - kf.x(0);
+  const double y1 = z(1) - kf.x(1);
+
+  for (int m = 0; m < 2; ++m) {
+    // h = e_m: phi is row m of L, L phi is column m of P.
+    double phi[4], lp[4];
+    double a = r;
+    for (int k = 0; k < 4; ++k) {
+      phi[k] = L(m,k);
+      a += phi[k] * phi[k];
+    }
+    for (int i = 0; i < 4; ++i) {
+      double s = 0.0;
+      for (int k = 0; k < 4; ++k) s += L(i,k) * phi[k];
+      lp[i] = s;
+    }
+    const double y = z(m) - kf.x(m);
+    for (int i = 0; i < 4; ++i) kf.x(i) += lp[i] / a * y;
+    const double gamma = 1.0 / (a + std::sqrt(a * r));
+    for (int i = 0; i < 4; ++i) {
+      for (int k = 0; k < 4; ++k) L(i,k) -= gamma * lp[i] * phi[k];
+    }
+  }
+
+  outer4(L, kf.P);
+  if (out_innovation) *out_innovation = Vec2(y0, y1);
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include "kalman.h"
+
+// Square-root (Cholesky factor) form of KalmanCV2D: the covariance is kept as
+// L with P = L L^T, so it stays symmetric and positive semi-definite however
+// long the run, and L has half the dynamic range of P. Fixed-size scalar
+// kernels, no allocation.
+//
+// predict_sqrt: x = F x and L = tria([F L, sqrt(q) G]), where Q = q G G^T is
+// the white-acceleration noise of KalmanCV2D::predict (G is 4x2). tria() is a
+// Householder QR of the 6x4 transpose, so L comes out lower triangular with a
+// positive diagonal.
+//
+// update_pos_sqrt: R = sigma_z^2 I is diagonal, so the two position
+// components are processed as scalar Potter updates,
+//   a = phi^T phi + r,  phi = L^T h,  x += (L phi / a) (z - h x),
+//   L -= L phi phi^T / (a + sqrt(a r)),
+// which equals the joint update. L stays a factor but not triangular until
+// the next predict.
+//
+// Both also write kf.P = L L^T, so gating and logging read kf as usual.
+
+// Lower-triangular L with L L^T = P. Returns false (L unspecified) when P is
+// not positive definite.
+bool cholesky4(const Mat4& P, Mat4& L);
+
+// P = L L^T, computed on the upper triangle and mirrored (exactly symmetric).
+void outer4(const Mat4& L, Mat4& P);
+
+void predict_sqrt(KalmanCV2D& kf, Mat4& L);
+void update_pos_sqrt(KalmanCV2D& kf, Mat4& L, const Vec2& z, Vec2* out_innovation = nullptr);
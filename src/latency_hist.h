@@ -0,0 +1,66 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <algorithm>
+
+// Log-linear (HDR-style) histogram of latencies in nanoseconds.
+// Each power-of-two range is split into 16 linear sub-buckets, so recorded
+// values keep ~6% relative precision from 1 ns up to 2^63 ns with a fixed
+// 1024-counter footprint and O(1), allocation-free record().
+struct LatencyHistogram {
+  static constexpr int kSubBits = 4;
+  static constexpr int kSub = 1 << kSubBits;
+  static constexpr int kBuckets = 64 * kSub;
+
+  std::array<uint64_t, kBuckets> counts{};
+  uint64_t total = 0;
+  uint64_t sum_ns = 0;
+  uint64_t max_ns = 0;
+
+  static int bucket_of(uint64_t v) {
+    if (v < (uint64_t)kSub) return (int)v;
+    int msb = 63;
+    while (!(v >> msb)) --msb;
+    const int shift = msb - kSubBits;
+    return (shift + 1) * kSub + (int)((v >> shift) & (kSub - 1));
+  }
+
+  // Upper edge of a bucket (the value reported for percentiles).
+  static uint64_t bucket_high(int b) {
+    if (b < kSub) return (uint64_t)b;
+    const int shift = b / kSub - 1;
+    const uint64_t base = ((uint64_t)kSub | (uint64_t)(b % kSub)) << shift;
+    return base + ((uint64_t)1 << shift) - 1;
+  }
+
+  void record(uint64_t ns) {
+    counts[bucket_of(ns)]++;
+    total++;
+    sum_ns += ns;
+    max_ns = std::max(max_ns, ns);
+  }
+
+  void merge(const LatencyHistogram& o) {
+    for (int i = 0; i < kBuckets; ++i) counts[i] += o.counts[i];
+    total += o.total;
+    sum_ns += o.sum_ns;
+    max_ns = std::max(max_ns, o.max_ns);
+  }
+
+  void clear() { *this = LatencyHistogram{}; }
+
+  // q in [0, 1]; e.g. 0.999 for p99.9.
+  uint64_t percentile(double q) const {
+    if (total == 0) return 0;
+    uint64_t rank = (uint64_t)(q * (double)total + 0.5);
+    rank = std::min(std::max<uint64_t>(rank, 1), total);
+    uint64_t seen = 0;
+    for (int b = 0; b < kBuckets; ++b) {
+      seen += counts[b];
+      if (seen >= rank) return std::min(bucket_high(b), max_ns);
+    }
+    return max_ns;
+  }
+
+  double mean() const { return total ? (double)sum_ns / (double)total : 0.0; }
+};
@@ -7,12 +7,20 @@
 #include <cstdint>
 #include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <cstring>
+#include <memory>
 
 #include "sim.h"
 #include "tracker.h"
 #include "csv.h"
 #include "fnv1a.h"
+#include "output_hash.h"
 #include "hungarian.h"
+#include "pipeline.h"
+#include "binlog.h"
+#include "scan_file.h"
+#include "checkpoint.h"
 
 static bool arg_eq(const char* a, const char* b) { return std::string(a) == std::string(b); }
 static uint64_t parse_u64(const char* s) { return static_cast<uint64_t>(std::strtoull(s, nullptr, 10)); }
@@ -87,6 +95,369 @@ static void run_assoc_demo() {
   std::cout << "  total_cost=" << assignment_cost(cost, h) << "\n";
 }
 
+static const char* assoc_name(AssocMethod m) {
+  switch (m) {
+    case AssocMethod::Greedy: return "greedy";
+    case AssocMethod::Hungarian: return "hungarian";
+    case AssocMethod::Auction: return "auction";
+    case AssocMethod::Mht: return "mht";
+    case AssocMethod::Jpda: return "jpda";
+  }
+  return "?";
+}
+
+// One scan travelling through the ingest -> track -> output pipeline.
+// Vectors are reused across scans, so steady state does not allocate.
+struct TrackRow {
+  uint32_t id = 0;
+  bool confirmed = false;
+  Vec4 x = Vec4::Zero();
+  int misses = 0;
+  double maha2 = 0.0;
+  int hits_window = 0;
+  Vec2 innov = Vec2::Zero();
+  Mat2 S = Mat2::Zero();
+  Mat4 P = Mat4::Zero();
+};
+
+// Per-scan digests of the tracker's stages (--hash_stages), WordHash64.
+enum HashStage { kHashPredict, kHashAssoc, kHashInit, kNumHashStages };
+
+struct ScanFrame {
+  int step = 0;
+  std::vector<TruthTarget> truth;
+  MeasSpan z;                      // the sim buffers below, or a view into a replay file
+  const int32_t* ids = nullptr;    // per-measurement true id (0 = clutter); null if unknown
+  std::vector<Vec2> z_buf;
+  std::vector<int32_t> id_buf;
+  std::vector<PolarMeas> polar;    // --polar: the detections z_buf was converted from
+  std::vector<TrackRow> tracks;
+  uint64_t stage_hash[kNumHashStages] = {}; // --hash_stages: this scan's digests
+
+  // --checkpoint: the run's state after this scan, filled by each stage in
+  // turn on due scans and handed to the writer by the output stage.
+  bool ckpt_due = false;
+  CheckpointImage ckpt;
+  JpdaInfo ckpt_jpda;   // JPDA totals through this scan
+  uint64_t ckpt_ns = 0; // capture time summed over the stages
+};
+
+struct RunTotals {
+  uint64_t scans = 0; // scans the totals cover, restored ones included
+  uint64_t total_meas = 0;
+  uint64_t total_clutter = 0;
+  uint32_t max_track_id_seen = 0;
+  uint64_t assoc_updates = 0;
+  double maha2_sum = 0.0;
+};
+
+// Run section of a checkpoint: totals and JPDA counters field by field, so
+// the image carries no struct padding (RunTotals has some after its u32).
+static void save_totals(StateWriter& w, const RunTotals& t, const JpdaInfo& j) {
+  w.pod(t.scans);
+  w.pod(t.total_meas);
+  w.pod(t.total_clutter);
+  w.pod(t.max_track_id_seen);
+  w.pod(t.assoc_updates);
+  w.pod(t.maha2_sum);
+  w.pod(j.exact_clusters);
+  w.pod(j.approx_clusters);
+  w.pod(j.events);
+}
+
+static void load_totals(StateReader& r, RunTotals& t, JpdaInfo& j) {
+  r.pod(t.scans);
+  r.pod(t.total_meas);
+  r.pod(t.total_clutter);
+  r.pod(t.max_track_id_seen);
+  r.pod(t.assoc_updates);
+  r.pod(t.maha2_sum);
+  r.pod(j.exact_clusters);
+  r.pod(j.approx_clusters);
+  r.pod(j.events);
+}
+
+// Ingest stage: advance the simulator and copy the scan into the frame.
+static void ingest_scan(TargetSim2D& sim, int step, ScanFrame& f) {
+  sim.step();
+  f.step = step;
+  f.truth = sim.truth();
+  f.z_buf.clear();
+  f.id_buf.clear();
+  for (const auto& m : sim.last_measurements()) {
+    f.z_buf.push_back(m.z);
+    f.id_buf.push_back(m.true_id);
+  }
+  f.polar = sim.last_polar();
+  f.z = MeasSpan(f.z_buf);
+  f.ids = f.id_buf.data();
+}
+
+// Ingest stage for --replay: the frame points straight into the mapping.
+static void ingest_replay(const ScanFile& file, int step, ScanFrame& f) {
+  const ScanView v = file.scan((size_t)step);
+  f.step = step;
+  f.truth.clear();
+  f.z = v.z;
+  f.ids = v.ids;
+}
+
+// Identity of a run for --restore: the seed, every setting that shapes the
+// scans or the tracker's answers, and which hashes are kept. The tracker
+// part is the save_config() record, so it covers every field the checkpoint
+// stores. Threads, pipelining and logging are left out, since output does
+// not depend on them; so is the step count, so a restored run may go on
+// longer than the one checkpointed.
+static uint64_t run_key(uint64_t seed, const SimConfig& s, bool replay, const TrackerConfig& t,
+                        double sigma_a, bool polar, const PolarModel& pm, bool hash_stages) {
+  Fnv1a64 h;
+  auto d = [&](double v) {
+    uint64_t b;
+    std::memcpy(&b, &v, sizeof(b));
+    h.add_u64(b);
+  };
+  auto i = [&](int64_t v) { h.add_u64((uint64_t)v); };
+  h.add("RUN_KEY_V2\n");
+  i((int64_t)seed);
+  i(replay);
+  d(s.dt); i(s.num_targets); d(s.sigma_z); d(s.p_detect);
+  i(s.enable_clutter); i(s.clutter_per_step); d(s.clutter_area_half);
+  i(s.scenario_cross); i(s.scenario_maneuver); i(s.scenario_massive);
+  d(s.area_half); d(s.birth_rate); d(s.death_prob);
+  d(sigma_a);
+  i(polar);
+  if (polar) { d(pm.sigma_az); d(pm.sigma_rr); i((int)pm.filter); i(pm.doppler); d(pm.gate); }
+  std::vector<uint8_t> cfg;
+  StateWriter w(cfg);
+  save_config(w, t);
+  i((int64_t)cfg.size());
+  for (uint8_t c : cfg) h.add_byte(c);
+  i(hash_stages);
+  return h.h;
+}
+
+static int32_t meas_id(const ScanFrame& f, size_t i) { return f.ids ? f.ids[i] : 0; }
+
+// Track stage tail: snapshot what the output stage needs, since the tracker
+// moves on to the next scan while this one is being written.
+static void snapshot_tracks(const MultiTargetTracker& tracker, ScanFrame& f) {
+  const auto& tracks = tracker.tracks();
+  const auto& info = tracker.track_info();
+  const auto& innovs = tracker.last_innovations();
+  const auto& Ss = tracker.last_S();
+
+  f.tracks.resize(tracks.size());
+  for (size_t i = 0; i < tracks.size(); ++i) {
+    const auto& tr = tracks[i];
+    TrackRow& r = f.tracks[i];
+    r.id = info[i].id;
+    r.confirmed = tr.confirmed;
+    r.x = tr.kf.x;
+    r.misses = tr.misses;
+    r.maha2 = info[i].last_maha2;
+    r.hits_window = tr.hits_in_window();
+    r.innov = innovs[i];
+    r.S = Ss[i];
+    r.P = tr.kf.P;
+  }
+}
+
+// Golden hash of one scan's output, streamed by the output stage: u32 step,
+// u32 track count, then hash_track_record() per track in tracker order.
+static void hash_scan(Fnv1a64& h, const ScanFrame& f) {
+  h.add_u32((uint32_t)f.step);
+  h.add_u32((uint32_t)f.tracks.size());
+  for (const auto& tr : f.tracks) {
+    hash_track_record(h, tr.id, tr.confirmed, tr.x, tr.P, tr.misses, tr.hits_window);
+  }
+}
+
+// --hash_stages, track stage tail: digests of what each stage of this scan
+// produced, so two runs that diverge can be told apart at the first scan
+// and stage that differs. predict: the gate cache (predicted positions,
+// gate boxes, S); association: track -> measurement; initiation: the
+// candidate count and the tracks born this scan (ids above prev_max_id).
+static void digest_stages(const MultiTargetTracker& tracker, uint32_t prev_max_id, ScanFrame& f) {
+  WordHash64 hp;
+  hp.add_u64(tracker.gate_cache().size());
+  for (const auto& g : tracker.gate_cache()) {
+    hp.add_f64(g.center(0));
+    hp.add_f64(g.center(1));
+    hp.add_f64(g.half(0));
+    hp.add_f64(g.half(1));
+    hp.add_f64(g.ic.S(0,0));
+    hp.add_f64(g.ic.S(0,1));
+    hp.add_f64(g.ic.S(1,1));
+  }
+
+  WordHash64 ha;
+  const auto& t2m = tracker.last_association().track_to_meas;
+  ha.add_u64(t2m.size());
+  for (int mi : t2m) ha.add_u64((uint64_t)(int64_t)mi);
+
+  WordHash64 hi;
+  hi.add_u64(tracker.num_candidates());
+  const auto& tracks = tracker.tracks();
+  const auto& info = tracker.track_info();
+  for (size_t i = 0; i < tracks.size(); ++i) {
+    if (info[i].id <= prev_max_id) continue;
+    const Track& t = tracks[i];
+    hash_track_record(hi, info[i].id, t.confirmed, t.kf.x, t.kf.P, t.misses, t.hits_in_window());
+  }
+
+  f.stage_hash[kHashPredict] = hp.h;
+  f.stage_hash[kHashAssoc] = ha.h;
+  f.stage_hash[kHashInit] = hi.h;
+}
+
+static void accumulate_totals(const ScanFrame& f, RunTotals& tot) {
+  tot.scans++;
+  tot.total_meas += f.z.size();
+  for (size_t i = 0; i < f.z.size(); ++i) if (meas_id(f, i) == 0) tot.total_clutter++;
+
+  for (const auto& tr : f.tracks) {
+    tot.max_track_id_seen = std::max(tot.max_track_id_seen, tr.id);
+    if (tr.maha2 > 0.0) {
+      tot.assoc_updates++;
+      tot.maha2_sum += tr.maha2;
+    }
+  }
+}
+
+// Output stage, text logs (--log_format csv).
+struct CsvLogs {
+  Csv truth;
+  Csv meas;
+  Csv tracks;
+  Csv resid;
+
+  explicit CsvLogs(const std::string& dir)
+    : truth(dir + "/truth.csv"), meas(dir + "/meas.csv"),
+      tracks(dir + "/tracks.csv"), resid(dir + "/residuals.csv") {
+    truth.header("step,true_id,x,y,vx,vy");
+    meas.header("step,true_id,zx,zy");
+    tracks.header("step,track_id,confirmed,x,y,vx,vy,misses,maha2,hits_window");
+    resid.header("step,track_id,innov_x,innov_y,S00,S01,S10,S11");
+  }
+
+  void write(const ScanFrame& f) {
+    const int step = f.step;
+
+    for (const auto& t : f.truth) {
+      truth.out << step << "," << t.id << ","
+                << std::setprecision(17) << t.pos.x() << ","
+                << std::setprecision(17) << t.pos.y() << ","
+                << std::setprecision(17) << t.vel.x() << ","
+                << std::setprecision(17) << t.vel.y() << "\n";
+    }
+
+    for (size_t i = 0; i < f.z.size(); ++i) {
+      meas.out << step << "," << meas_id(f, i) << ","
+               << std::setprecision(17) << f.z[i].x() << ","
+               << std::setprecision(17) << f.z[i].y() << "\n";
+    }
+
+    for (const auto& tr : f.tracks) {
+      tracks.out << step << "," << tr.id << "," << (tr.confirmed ? 1 : 0) << ","
+                 << std::setprecision(17) << tr.x(0) << ","
+                 << std::setprecision(17) << tr.x(1) << ","
+                 << std::setprecision(17) << tr.x(2) << ","
+                 << std::setprecision(17) << tr.x(3) << ","
+                 << tr.misses << ","
+                 << std::setprecision(17) << tr.maha2 << ","
+                 << tr.hits_window
+                 << "\n";
+
+      resid.out << step << "," << tr.id << ","
+                << std::setprecision(17) << tr.innov.x() << ","
+                << std::setprecision(17) << tr.innov.y() << ","
+                << std::setprecision(17) << tr.S(0,0) << ","
+                << std::setprecision(17) << tr.S(0,1) << ","
+                << std::setprecision(17) << tr.S(1,0) << ","
+                << std::setprecision(17) << tr.S(1,1)
+                << "\n";
+    }
+  }
+};
+
+// Output stage, binary columnar logs (--log_format bin). Same tables and
+// columns as the CSVs; tools/binlog.py converts back.
+struct BinLogs {
+  BinLog truth;
+  BinLog meas;
+  BinLog tracks;
+  BinLog resid;
+
+  BinLogs(const std::string& dir, bool compress)
+    : truth(dir + "/truth.bin", "step:i32,true_id:i32,x:f64,y:f64,vx:f64,vy:f64", compress),
+      meas(dir + "/meas.bin", "step:i32,true_id:i32,zx:f64,zy:f64", compress),
+      tracks(dir + "/tracks.bin",
+             "step:i32,track_id:u32,confirmed:u8,x:f64,y:f64,vx:f64,vy:f64,"
+             "misses:i32,maha2:f64,hits_window:i32", compress),
+      resid(dir + "/residuals.bin",
+            "step:i32,track_id:u32,innov_x:f64,innov_y:f64,S00:f64,S01:f64,S10:f64,S11:f64",
+            compress) {}
+
+  void write(const ScanFrame& f) {
+    const int step = f.step;
+    for (const auto& t : f.truth)
+      truth.row(step, t.id, t.pos.x(), t.pos.y(), t.vel.x(), t.vel.y());
+    for (size_t i = 0; i < f.z.size(); ++i)
+      meas.row(step, meas_id(f, i), f.z[i].x(), f.z[i].y());
+    for (const auto& tr : f.tracks) {
+      tracks.row(step, tr.id, tr.confirmed ? 1 : 0, tr.x(0), tr.x(1), tr.x(2), tr.x(3),
+                 tr.misses, tr.maha2, tr.hits_window);
+      resid.row(step, tr.id, tr.innov.x(), tr.innov.y(),
+                tr.S(0,0), tr.S(0,1), tr.S(1,0), tr.S(1,1));
+    }
+  }
+};
+
+// Tracker instrumentation: stage latencies in us, then per-scan counts.
+static void print_tracker_stats(const TrackerStats& st) {
+  if (!TrackerStats::kEnabled) {
+    std::cout << "tracker stats: not compiled in (configure with -DRADAR_STATS=ON)\n";
+    return;
+  }
+  std::cout << "tracker stats (" << st.stage(TrackerStage::Step).total << " scans):\n";
+  for (int s = 0; s < TrackerStats::kStages; ++s) {
+    const LatencyHistogram& h = st.stage_ns[s];
+    if (h.total == 0 && (TrackerStage)s == TrackerStage::Retrodict) continue;
+    std::cout << "  " << std::left << std::setw(10) << stage_name((TrackerStage)s) << std::right
+              << std::fixed << std::setprecision(1)
+              << " p50=" << h.percentile(0.50) * 1e-3
+              << " p99=" << h.percentile(0.99) * 1e-3
+              << " p99.9=" << h.percentile(0.999) * 1e-3
+              << " max=" << h.max_ns * 1e-3
+              << " us\n" << std::defaultfloat;
+  }
+  const struct { const char* name; const LatencyHistogram* h; } counts[] = {
+    {"pairs", &st.pairs},
+    {"gated", &st.gated},
+    {"cluster", &st.cluster_rows},
+    {"cands", &st.candidates},
+    {"tracks", &st.tracks},
+  };
+  for (const auto& c : counts) {
+    std::cout << "  " << std::left << std::setw(10) << c.name << std::right
+              << " p50=" << c.h->percentile(0.50)
+              << " p99=" << c.h->percentile(0.99)
+              << " p99.9=" << c.h->percentile(0.999)
+              << " max=" << c.h->max_ns
+              << " mean=" << std::setprecision(4) << c.h->mean()
+              << "\n";
+  }
+}
+
+static void print_stage(const char* name, const LatencyHistogram& h) {
+  std::cout << "  " << std::left << std::setw(10) << name << std::right
+            << std::fixed << std::setprecision(1)
+            << " p50=" << h.percentile(0.50) * 1e-3
+            << " p99=" << h.percentile(0.99) * 1e-3
+            << " max=" << h.max_ns * 1e-3
+            << " us\n" << std::defaultfloat;
+}
+
 int main(int argc, char** argv) {
   uint64_t seed = 12345;
   int steps = 400;
@@ -104,17 +475,59 @@ int main(int argc, char** argv) {
 
   double gate_maha2 = 9.21;
   int max_misses = 8;
+  double max_pos_sigma = 0.0;
 
   int confirm_M = 3;
   int confirm_N = 5;
 
-  int use_hungarian = 1;
+  AssocMethod assoc = AssocMethod::Hungarian;
+  bool auction_warm = false;
+  int mht_k = 8;
+  int mht_n_scan = 3;
+  int jpda_exact = JpdaParams().max_exact_rows;
+  MotionModel motion = MotionModel::Cv;
+  double imm_turn_rate = ImmParams().turn_rate;
+  int use_grid = 1;
+  int num_threads = 1;
+  CovUpdate cov_update = CovUpdate::Standard;
+
+  // polar radar measurements
+  int polar = 0;
+  PolarFilter polar_filter = PolarFilter::Ekf;
+  int doppler = 1;
+  double sigma_az = PolarModel().sigma_az;
+  double sigma_rr = PolarModel().sigma_rr;
+
+  // streaming runtime
+  int use_pipeline = 0;
+  int pipeline_depth = 4;
+
+  // recorded scans
+  std::string record_path;
+  std::string replay_path;
+
+  // checkpoint / restart
+  std::string ckpt_path;
+  int ckpt_every = 100;
+  std::string restore_path;
+
+  // logging
+  bool log_binary = false;
+  int log_compress = 1;
+  int print_stats = 0;
+  int hash_stages = 0;
 
   // demo
   int assoc_demo = 0;
 
   // scenario
   bool scenario_cross = false;
+  bool scenario_maneuver = false;
+  bool scenario_massive = false;
+  double area_half = 0.0;
+  double birth_rate = 0.0;
+  double death_prob = 0.0;
+  int sim_threads = 1;
 
   std::string out_dir = "out";
 
@@ -133,17 +546,74 @@ int main(int argc, char** argv) {
 
     else if (arg_eq(argv[i], "--gate_maha2") && i + 1 < argc) gate_maha2 = parse_d(argv[++i]);
     else if (arg_eq(argv[i], "--max_misses") && i + 1 < argc) max_misses = parse_i(argv[++i]);
+    else if (arg_eq(argv[i], "--max_pos_sigma") && i + 1 < argc) max_pos_sigma = parse_d(argv[++i]);
 
     else if (arg_eq(argv[i], "--confirm_M") && i + 1 < argc) confirm_M = parse_i(argv[++i]);
     else if (arg_eq(argv[i], "--confirm_N") && i + 1 < argc) confirm_N = parse_i(argv[++i]);
 
-    else if (arg_eq(argv[i], "--hungarian") && i + 1 < argc) use_hungarian = parse_b(argv[++i]);
+    else if (arg_eq(argv[i], "--hungarian") && i + 1 < argc) {
+      assoc = parse_b(argv[++i]) ? AssocMethod::Hungarian : AssocMethod::Greedy;
+    }
+    else if (arg_eq(argv[i], "--assoc") && i + 1 < argc) {
+      std::string s = argv[++i];
+      if (s == "greedy") assoc = AssocMethod::Greedy;
+      else if (s == "auction") assoc = AssocMethod::Auction;
+      else if (s == "mht") assoc = AssocMethod::Mht;
+      else if (s == "jpda") assoc = AssocMethod::Jpda;
+      else assoc = AssocMethod::Hungarian;
+    }
+    else if (arg_eq(argv[i], "--auction_warm") && i + 1 < argc) auction_warm = parse_b(argv[++i]);
+    else if (arg_eq(argv[i], "--mht_k") && i + 1 < argc) mht_k = parse_i(argv[++i]);
+    else if (arg_eq(argv[i], "--mht_n_scan") && i + 1 < argc) mht_n_scan = parse_i(argv[++i]);
+    else if (arg_eq(argv[i], "--jpda_exact") && i + 1 < argc) jpda_exact = parse_i(argv[++i]);
+    else if (arg_eq(argv[i], "--motion") && i + 1 < argc) {
+      std::string s = argv[++i];
+      motion = (s == "imm") ? MotionModel::Imm : MotionModel::Cv;
+    }
+    else if (arg_eq(argv[i], "--imm_turn_rate") && i + 1 < argc) imm_turn_rate = parse_d(argv[++i]);
+    else if (arg_eq(argv[i], "--grid") && i + 1 < argc) use_grid = parse_b(argv[++i]);
+    else if (arg_eq(argv[i], "--threads") && i + 1 < argc) num_threads = parse_i(argv[++i]);
+    else if (arg_eq(argv[i], "--cov_update") && i + 1 < argc) {
+      std::string s = argv[++i];
+      if (s == "symmetric") cov_update = CovUpdate::Symmetric;
+      else if (s == "joseph") cov_update = CovUpdate::Joseph;
+      else if (s == "sqrt") cov_update = CovUpdate::SquareRoot;
+      else cov_update = CovUpdate::Standard;
+    }
+    else if (arg_eq(argv[i], "--polar") && i + 1 < argc) polar = parse_b(argv[++i]);
+    else if (arg_eq(argv[i], "--polar_filter") && i + 1 < argc) {
+      std::string s = argv[++i];
+      polar_filter = (s == "ukf") ? PolarFilter::Ukf : PolarFilter::Ekf;
+    }
+    else if (arg_eq(argv[i], "--doppler") && i + 1 < argc) doppler = parse_b(argv[++i]);
+    else if (arg_eq(argv[i], "--sigma_az") && i + 1 < argc) sigma_az = parse_d(argv[++i]);
+    else if (arg_eq(argv[i], "--sigma_rr") && i + 1 < argc) sigma_rr = parse_d(argv[++i]);
+    else if (arg_eq(argv[i], "--pipeline") && i + 1 < argc) use_pipeline = parse_b(argv[++i]);
+    else if (arg_eq(argv[i], "--pipeline_depth") && i + 1 < argc) pipeline_depth = parse_i(argv[++i]);
+    else if (arg_eq(argv[i], "--log_format") && i + 1 < argc) {
+      std::string s = argv[++i];
+      log_binary = (s == "bin");
+    }
+    else if (arg_eq(argv[i], "--log_compress") && i + 1 < argc) log_compress = parse_b(argv[++i]);
+    else if (arg_eq(argv[i], "--stats") && i + 1 < argc) print_stats = parse_b(argv[++i]);
+    else if (arg_eq(argv[i], "--hash_stages") && i + 1 < argc) hash_stages = parse_b(argv[++i]);
+    else if (arg_eq(argv[i], "--record") && i + 1 < argc) record_path = argv[++i];
+    else if (arg_eq(argv[i], "--replay") && i + 1 < argc) replay_path = argv[++i];
+    else if (arg_eq(argv[i], "--checkpoint") && i + 1 < argc) ckpt_path = argv[++i];
+    else if (arg_eq(argv[i], "--checkpoint_every") && i + 1 < argc) ckpt_every = parse_i(argv[++i]);
+    else if (arg_eq(argv[i], "--restore") && i + 1 < argc) restore_path = argv[++i];
     else if (arg_eq(argv[i], "--assoc_demo") && i + 1 < argc) assoc_demo = parse_b(argv[++i]);
 
     else if (arg_eq(argv[i], "--scenario") && i + 1 < argc) {
       std::string s = argv[++i];
       scenario_cross = (s == "cross");
+      scenario_maneuver = (s == "maneuver");
+      scenario_massive = (s == "massive");
     }
+    else if (arg_eq(argv[i], "--area_half") && i + 1 < argc) area_half = parse_d(argv[++i]);
+    else if (arg_eq(argv[i], "--birth_rate") && i + 1 < argc) birth_rate = parse_d(argv[++i]);
+    else if (arg_eq(argv[i], "--death_prob") && i + 1 < argc) death_prob = parse_d(argv[++i]);
+    else if (arg_eq(argv[i], "--sim_threads") && i + 1 < argc) sim_threads = parse_i(argv[++i]);
 
     else if (arg_eq(argv[i], "--out") && i + 1 < argc) out_dir = argv[++i];
     else if (arg_eq(argv[i], "--help")) {
@@ -161,11 +631,42 @@ int main(int argc, char** argv) {
         << "  --clutter_A METERS\n"
         << "  --gate_maha2\n"
         << "  --max_misses\n"
+        << "  --max_pos_sigma K   (drop tracks above K sigma_z position sigma, 0 = off)\n"
         << "  --confirm_M M\n"
-        << "  --confirm_N N\n"
-        << "  --hungarian 0|1\n"
+        << "  --confirm_N N       (1..64)\n"
+        << "  --hungarian 0|1     (same as --assoc hungarian|greedy)\n"
+        << "  --assoc greedy|hungarian|auction|mht|jpda\n"
+        << "  --auction_warm 0|1  (auction: start from last scan's track prices)\n"
+        << "  --mht_k K           (mht: global hypotheses kept, default 8)\n"
+        << "  --mht_n_scan N      (mht: pruning depth in scans, default 3)\n"
+        << "  --jpda_exact N      (jpda: largest cluster enumerated exactly, default 10)\n"
+        << "  --motion cv|imm     (imm: CV + coordinated turns; greedy/hungarian/auction)\n"
+        << "  --imm_turn_rate W   (imm: turn model rate in rad/s, default 0.5)\n"
+        << "  --grid 0|1\n"
+        << "  --threads N\n"
+        << "  --cov_update standard|symmetric|joseph|sqrt\n"
+        << "  --polar 0|1         (range / azimuth / range-rate detections, --sigma_z = range noise)\n"
+        << "  --polar_filter ekf|ukf\n"
+        << "  --doppler 0|1       (polar: gate and update on range rate, default 1)\n"
+        << "  --sigma_az RAD      (polar: azimuth noise, default 0.01)\n"
+        << "  --sigma_rr M/S      (polar: range-rate noise, default 0.5)\n"
+        << "  --pipeline 0|1      (ingest / track / output on separate threads)\n"
+        << "  --pipeline_depth N  (scans in flight, default 4)\n"
+        << "  --log_format csv|bin\n"
+        << "  --log_compress 0|1  (bin only, default 1)\n"
+        << "  --stats 0|1         (per-stage tracker latency, needs RADAR_STATS build)\n"
+        << "  --hash_stages 0|1   (predict / association / initiation sub-hashes, hashes.csv)\n"
+        << "  --record FILE       (write the run's scans to a recording)\n"
+        << "  --replay FILE       (track a recording instead of the simulator)\n"
+        << "  --checkpoint FILE   (snapshot the run in the background for --restore)\n"
+        << "  --checkpoint_every N (scans between checkpoints, default 100)\n"
+        << "  --restore FILE      (continue a run from its checkpoint; same flags)\n"
         << "  --assoc_demo 0|1\n"
-        << "  --scenario random|cross\n"
+        << "  --scenario random|cross|maneuver|massive\n"
+        << "  --area_half METERS  (massive: target/clutter area, default 100*sqrt(targets))\n"
+        << "  --birth_rate R      (massive: expected new targets per scan)\n"
+        << "  --death_prob P      (massive: per target per scan)\n"
+        << "  --sim_threads N     (massive: generation threads, output identical)\n"
         << "  --out DIR\n";
       return 0;
     }
@@ -177,11 +678,64 @@ int main(int argc, char** argv) {
   }
 
   if (confirm_N < 1) confirm_N = 1;
+  if (confirm_N > 64) confirm_N = 64;
   if (confirm_M < 1) confirm_M = 1;
   if (confirm_M > confirm_N) confirm_M = confirm_N;
 
+  if (polar && (!replay_path.empty() || scenario_massive || assoc == AssocMethod::Mht ||
+                assoc == AssocMethod::Jpda || motion == MotionModel::Imm)) {
+    std::cerr << "--polar needs the random, cross or maneuver scene, CV motion and "
+                 "greedy, hungarian or auction association\n";
+    return 1;
+  }
+
+  if ((!ckpt_path.empty() || !restore_path.empty()) && assoc == AssocMethod::Mht) {
+    std::cerr << "--checkpoint / --restore do not support --assoc mht\n";
+    return 1;
+  }
+  if (!restore_path.empty() && !record_path.empty()) {
+    std::cerr << "--record needs a run from the first scan, not --restore\n";
+    return 1;
+  }
+  if (ckpt_every < 1) ckpt_every = 1;
+
   std::filesystem::create_directories(out_dir);
 
+  ScanFile replay;
+  double replay_read_ms = 0.0;
+  uint64_t replay_bytes = 0;
+  if (!replay_path.empty()) {
+    if (!replay.open(replay_path)) {
+      std::cerr << "cannot open recording: " << replay_path << "\n";
+      return 1;
+    }
+    steps = (int)replay.num_scans();
+    dt = replay.dt();
+    replay_bytes = replay.total_meas() * (sizeof(Vec2) + (replay.has_ids() ? sizeof(int32_t) : 0));
+
+    // Raw read rate of the mapping: touch every measurement once.
+    const auto r0 = std::chrono::steady_clock::now();
+    double sink = 0.0;
+    for (size_t k = 0; k < replay.num_scans(); ++k) {
+      const ScanView v = replay.scan(k);
+      for (const auto& z : v.z) sink += z.x() + z.y();
+      if (v.ids) for (size_t i = 0; i < v.z.size(); ++i) sink += v.ids[i];
+    }
+    const auto r1 = std::chrono::steady_clock::now();
+    replay_read_ms = std::chrono::duration<double, std::milli>(r1 - r0).count();
+    volatile double keep = sink;
+    (void)keep;
+  }
+
+  std::unique_ptr<ScanWriter> recorder;
+  if (!record_path.empty()) {
+    recorder = std::make_unique<ScanWriter>(record_path, dt, true);
+    if (!recorder->ok()) {
+      std::cerr << "cannot create recording: " << record_path << "\n";
+      return 1;
+    }
+  }
+
   SimConfig scfg;
   scfg.num_targets = num_targets;
   scfg.dt = dt;
@@ -192,120 +746,222 @@ int main(int argc, char** argv) {
   scfg.clutter_per_step = clutter_per_step;
   scfg.clutter_area_half = clutter_area_half;
   scfg.scenario_cross = scenario_cross;
+  scfg.scenario_maneuver = scenario_maneuver;
+  scfg.scenario_massive = scenario_massive;
+  scfg.area_half = area_half;
+  scfg.birth_rate = birth_rate;
+  scfg.death_prob = death_prob;
+  scfg.sim_threads = sim_threads;
+  scfg.polar = (polar != 0);
+  scfg.sigma_r = sigma_z;
+  scfg.sigma_az = sigma_az;
+  scfg.sigma_rr = sigma_rr;
 
   TargetSim2D sim(seed, scfg);
 
+  PolarModel polar_model;
+  polar_model.sensor = scfg.polar_sensor;
+  polar_model.sigma_r = scfg.sigma_r;
+  polar_model.sigma_az = scfg.sigma_az;
+  polar_model.sigma_rr = scfg.sigma_rr;
+  polar_model.filter = polar_filter;
+  polar_model.doppler = (doppler != 0);
+  if (!polar_model.doppler) polar_model.gate = gate_maha2;
+
   TrackerConfig tcfg;
   tcfg.gate_maha2 = gate_maha2;
   tcfg.max_misses = max_misses;
+  tcfg.max_pos_sigma = max_pos_sigma;
   tcfg.confirm_M = confirm_M;
   tcfg.confirm_N = confirm_N;
-  tcfg.use_hungarian = (use_hungarian != 0);
+  tcfg.assoc = assoc;
+  tcfg.auction_warm_start = auction_warm;
+  tcfg.mht_hypotheses = mht_k;
+  tcfg.mht_n_scan = mht_n_scan;
+  tcfg.jpda.max_exact_rows = jpda_exact;
+  tcfg.motion = motion;
+  tcfg.imm.turn_rate = imm_turn_rate;
+  tcfg.p_detect = p_detect;
+  if (scfg.enable_clutter && scfg.clutter_per_step > 0) {
+    tcfg.clutter_density = (double)scfg.clutter_per_step /
+                               (4.0 * scfg.clutter_area_half * scfg.clutter_area_half);
+  }
+  tcfg.use_gating_grid = (use_grid != 0);
+  tcfg.cov_update = cov_update;
+  tcfg.num_threads = num_threads;
 
   MultiTargetTracker tracker(tcfg);
 
-  Csv truth_csv(out_dir + "/truth.csv");
-  Csv meas_csv(out_dir + "/meas.csv");
-  Csv tracks_csv(out_dir + "/tracks.csv");
-  Csv resid_csv(out_dir + "/residuals.csv");
-
-  truth_csv.header("step,true_id,x,y,vx,vy");
-  meas_csv.header("step,true_id,zx,zy");
-  tracks_csv.header("step,track_id,confirmed,x,y,vx,vy,misses,maha2,hits_window");
-  resid_csv.header("step,track_id,innov_x,innov_y,S00,S01,S10,S11");
+  std::unique_ptr<CsvLogs> csv_logs;
+  std::unique_ptr<BinLogs> bin_logs;
+  if (log_binary) bin_logs = std::make_unique<BinLogs>(out_dir, log_compress != 0);
+  else csv_logs = std::make_unique<CsvLogs>(out_dir);
 
   Fnv1a64 fnv;
-  fnv.add("RADAR_TRACKING_V8\n");
+  fnv.add("RADAR_TRACKING_V9\n");
   fnv.add_u64(seed);
 
-  uint64_t total_meas = 0;
-  uint64_t total_clutter = 0;
-
-  uint32_t max_track_id_seen = 0;
-  uint64_t assoc_updates = 0;
-  double maha2_sum = 0.0;
-
-  const auto t0 = std::chrono::steady_clock::now();
-
-  for (int step = 0; step < steps; ++step) {
-    sim.step();
+  RunTotals tot;
+  uint64_t tracker_ns = 0;
+  MhtScanInfo mht_tot; // summed over scans (MHT mode)
+  JpdaInfo jpda_tot;   // summed over scans (JPDA mode)
 
-    for (const auto& t : sim.truth()) {
-      truth_csv.out << step << "," << t.id << ","
-                    << std::setprecision(17) << t.pos.x() << ","
-                    << std::setprecision(17) << t.pos.y() << ","
-                    << std::setprecision(17) << t.vel.x() << ","
-                    << std::setprecision(17) << t.vel.y() << "\n";
+  // Run section of a checkpoint: key, next scan, hash and totals so far.
+  WordHash64 stage_tot[kNumHashStages]; // --hash_stages: folded per-scan digests
+  const uint64_t key = run_key(seed, scfg, !replay_path.empty(), tcfg, sigma_a, polar != 0, polar_model,
+                               hash_stages != 0);
+  int start_step = 0;
+  if (!restore_path.empty()) {
+    CheckpointImage img;
+    std::string err;
+    if (!read_checkpoint(restore_path, img, &err)) {
+      std::cerr << "cannot restore " << restore_path << ": " << err << "\n";
+      return 1;
     }
+    StateReader run(img.run);
+    uint64_t saved_key = 0;
+    run.pod(saved_key);
+    run.pod(start_step);
+    run.pod(fnv.h);
+    for (auto& sh : stage_tot) run.pod(sh.h);
+    load_totals(run, tot, jpda_tot);
+    if (!run.done() || saved_key != key) {
+      std::cerr << "checkpoint " << restore_path << " is from another seed, scene or tracker setup\n";
+      return 1;
+    }
+    StateReader trk(img.tracker);
+    StateReader sm(img.sim);
+    if (!tracker.load_state(trk) || !trk.done() ||
+        (replay_path.empty() && (!sim.load_state(sm) || !sm.done()))) {
+      std::cerr << "checkpoint " << restore_path << " is malformed\n";
+      return 1;
+    }
+    start_step = std::min(std::max(start_step, 0), steps);
+  }
+  const int run_steps = steps - start_step;
 
-    std::vector<Vec2> z;
-    z.reserve(sim.last_measurements().size());
-
-    total_meas += sim.last_measurements().size();
-    for (const auto& m : sim.last_measurements()) {
-      if (m.true_id == 0) total_clutter++;
-      z.push_back(m.z);
+  std::unique_ptr<Csv> hash_log;
+  if (hash_stages) {
+    hash_log = std::make_unique<Csv>(out_dir + "/hashes.csv");
+    hash_log->header("step,fnv,predict,assoc,init");
+  }
 
-      meas_csv.out << step << "," << m.true_id << ","
-                   << std::setprecision(17) << m.z.x() << ","
-                   << std::setprecision(17) << m.z.y() << "\n";
-    }
+  std::unique_ptr<CheckpointWriter> ckpt_writer;
+  if (!ckpt_path.empty()) ckpt_writer = std::make_unique<CheckpointWriter>(ckpt_path);
+  uint64_t ckpt_due_n = 0;
+  uint64_t ckpt_capture_ns = 0;
+  size_t ckpt_bytes = 0;
+  auto ns_since = [](std::chrono::steady_clock::time_point a) {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - a).count();
+  };
 
-    tracker.step(z, dt, sigma_a, sigma_z);
-
-    const auto& tracks = tracker.tracks();
-    const auto& innovs = tracker.last_innovations();
-    const auto& Ss = tracker.last_S();
-
-    for (size_t i = 0; i < tracks.size(); ++i) {
-      const auto& tr = tracks[i];
-      max_track_id_seen = std::max(max_track_id_seen, tr.id);
-
-      const int hits_window = tr.hits_in_window();
-
-      tracks_csv.out << step << "," << tr.id << "," << (tr.confirmed ? 1 : 0) << ","
-                     << std::setprecision(17) << tr.kf.x(0) << ","
-                     << std::setprecision(17) << tr.kf.x(1) << ","
-                     << std::setprecision(17) << tr.kf.x(2) << ","
-                     << std::setprecision(17) << tr.kf.x(3) << ","
-                     << tr.misses << ","
-                     << std::setprecision(17) << tr.last_maha2 << ","
-                     << hits_window
-                     << "\n";
-
-      resid_csv.out << step << "," << tr.id << ","
-                    << std::setprecision(17) << innovs[i].x() << ","
-                    << std::setprecision(17) << innovs[i].y() << ","
-                    << std::setprecision(17) << Ss[i](0,0) << ","
-                    << std::setprecision(17) << Ss[i](0,1) << ","
-                    << std::setprecision(17) << Ss[i](1,0) << ","
-                    << std::setprecision(17) << Ss[i](1,1)
-                    << "\n";
-
-      if (tr.last_maha2 > 0.0) {
-        assoc_updates++;
-        maha2_sum += tr.last_maha2;
+  const PipelineStats ps = run_pipeline<ScanFrame>(
+    run_steps, pipeline_depth, use_pipeline != 0,
+    [&](ScanFrame& f, int item) {
+      const int step = start_step + item;
+      if (replay_path.empty()) ingest_scan(sim, step, f);
+      else ingest_replay(replay, step, f);
+      f.ckpt_due = ckpt_writer && (step + 1) % ckpt_every == 0;
+      f.ckpt_ns = 0;
+      if (f.ckpt_due) {
+        const auto c = std::chrono::steady_clock::now();
+        StateWriter w(f.ckpt.sim);
+        if (replay_path.empty()) sim.save_state(w);
+        f.ckpt_ns += ns_since(c);
       }
-    }
-  }
+    },
+    [&](ScanFrame& f) {
+      uint32_t prev_max_id = 0;
+      if (hash_stages) {
+        for (const auto& ti : tracker.track_info()) prev_max_id = std::max(prev_max_id, ti.id);
+      }
+      const auto a = std::chrono::steady_clock::now();
+      if (polar) tracker.step_polar(f.polar, dt, sigma_a, polar_model);
+      else tracker.step(f.z, dt, sigma_a, sigma_z);
+      tracker_ns += (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - a).count();
+      if (hash_stages) digest_stages(tracker, prev_max_id, f);
+      const MhtScanInfo& mi = tracker.last_mht();
+      mht_tot.hypotheses += mi.hypotheses;
+      mht_tot.clusters += mi.clusters;
+      mht_tot.cluster_reuse += mi.cluster_reuse;
+      mht_tot.augmentations += mi.augmentations;
+      mht_tot.n_scan_pruned += mi.n_scan_pruned;
+      const JpdaInfo& ji = tracker.last_jpda();
+      jpda_tot.exact_clusters += ji.exact_clusters;
+      jpda_tot.approx_clusters += ji.approx_clusters;
+      jpda_tot.events += ji.events;
+      snapshot_tracks(tracker, f);
+      if (f.ckpt_due) {
+        const auto c = std::chrono::steady_clock::now();
+        StateWriter w(f.ckpt.tracker);
+        tracker.save_state(w);
+        f.ckpt_jpda = jpda_tot;
+        f.ckpt_ns += ns_since(c);
+      }
+    },
+    [&](ScanFrame& f) {
+      if (bin_logs) bin_logs->write(f);
+      else csv_logs->write(f);
+      accumulate_totals(f, tot);
+      hash_scan(fnv, f);
+      if (hash_log) {
+        for (int k = 0; k < kNumHashStages; ++k) stage_tot[k].add_u64(f.stage_hash[k]);
+        hash_log->out << f.step << std::hex << "," << fnv.h << "," << f.stage_hash[kHashPredict]
+                      << "," << f.stage_hash[kHashAssoc] << "," << f.stage_hash[kHashInit]
+                      << std::dec << "\n";
+      }
+      if (recorder) recorder->append(f.z, f.ids, (double)f.step * dt);
+      if (f.ckpt_due) {
+        const auto c = std::chrono::steady_clock::now();
+        StateWriter w(f.ckpt.run);
+        w.pod(key);
+        w.pod(f.step + 1);
+        w.pod(fnv.h);
+        for (const auto& sh : stage_tot) w.pod(sh.h);
+        save_totals(w, tot, f.ckpt_jpda);
+        ckpt_bytes = f.ckpt.run.size() + f.ckpt.tracker.size() + f.ckpt.sim.size();
+        ckpt_writer->submit(f.ckpt);
+        ckpt_capture_ns += f.ckpt_ns + ns_since(c);
+        ckpt_due_n++;
+      }
+    });
+  if (recorder) recorder->finish();
+  if (ckpt_writer) ckpt_writer->flush();
 
-  const auto t1 = std::chrono::steady_clock::now();
-  const double elapsed_ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
-  const double ms_per_step = (steps > 0) ? (elapsed_ms / (double)steps) : 0.0;
+  const double elapsed_ms = ps.wall_ms;
+  const double ms_per_step = (run_steps > 0) ? (elapsed_ms / (double)run_steps) : 0.0;
   const double steps_per_sec = (ms_per_step > 0.0) ? (1000.0 / ms_per_step) : 0.0;
+  const double tracker_ms_per_step = (run_steps > 0) ? ((double)tracker_ns * 1e-6 / (double)run_steps) : 0.0;
 
   int confirmed_final = 0;
   for (const auto& tr : tracker.tracks()) if (tr.confirmed) confirmed_final++;
 
-  const double maha2_avg = (assoc_updates > 0) ? (maha2_sum / (double)assoc_updates) : 0.0;
+  const double maha2_avg = (tot.assoc_updates > 0) ? (tot.maha2_sum / (double)tot.assoc_updates) : 0.0;
 
   std::cerr << "FNV1A64=" << std::hex << fnv.h << std::dec << "\n";
+  if (hash_stages) {
+    std::cerr << "STAGE_HASH predict=" << std::hex << stage_tot[kHashPredict].h
+              << " assoc=" << stage_tot[kHashAssoc].h
+              << " init=" << stage_tot[kHashInit].h << std::dec << "\n";
+  }
   std::cout << "Wrote logs to: " << out_dir << "\n";
-  std::cout << "Files: truth.csv, meas.csv, tracks.csv, residuals.csv\n";
+  if (log_binary) std::cout << "Files: truth.bin, meas.bin, tracks.bin, residuals.bin\n";
+  else std::cout << "Files: truth.csv, meas.csv, tracks.csv, residuals.csv\n";
 
   std::cout << "\n=== RUN SUMMARY ===\n";
-  std::cout << "scenario=" << (scenario_cross ? "cross" : "random") << "\n";
-  std::cout << "hungarian=" << (tcfg.use_hungarian ? 1 : 0) << "\n";
+  std::cout << "scenario=" << (scenario_massive ? "massive" : scenario_cross ? "cross" :
+                                scenario_maneuver ? "maneuver" : "random") << "\n";
+  std::cout << "hungarian=" << (tcfg.assoc == AssocMethod::Hungarian ? 1 : 0)
+            << " assoc=" << assoc_name(tcfg.assoc)
+            << " motion=" << (motion == MotionModel::Imm ? "imm" : "cv") << "\n";
+  if (polar) {
+    std::cout << "polar=1 filter=" << (polar_filter == PolarFilter::Ukf ? "ukf" : "ekf")
+              << " doppler=" << doppler
+              << " sigma_r=" << scfg.sigma_r << " sigma_az=" << scfg.sigma_az
+              << " sigma_rr=" << scfg.sigma_rr << "\n";
+  }
   std::cout << "steps=" << steps
             << " dt=" << dt
             << " targets=" << (scenario_cross ? 2 : num_targets)
@@ -316,20 +972,85 @@ int main(int argc, char** argv) {
             << " clutter_A=" << scfg.clutter_area_half
             << "\n";
   std::cout << "confirm_M=" << confirm_M << " confirm_N=" << confirm_N << "\n";
-  std::cout << "measurements_total=" << total_meas
-            << " clutter_total=" << total_clutter
+  std::cout << "measurements_total=" << tot.total_meas
+            << " clutter_total=" << tot.total_clutter
             << "\n";
-  std::cout << "tracks_created_estimate=" << max_track_id_seen
+  std::cout << "tracks_created_estimate=" << tot.max_track_id_seen
             << " tracks_alive_final=" << tracker.tracks().size()
             << " confirmed_final=" << confirmed_final
             << "\n";
-  std::cout << "assoc_updates=" << assoc_updates
+  std::cout << "assoc_updates=" << tot.assoc_updates
             << " maha2_avg=" << std::setprecision(6) << maha2_avg
             << "\n";
   std::cout << "elapsed_ms=" << std::setprecision(3) << elapsed_ms
             << " ms_per_step=" << std::setprecision(6) << ms_per_step
             << " steps_per_sec=" << std::setprecision(3) << steps_per_sec
             << "\n";
+  std::cout << "tracker_ms_per_step=" << std::setprecision(6) << tracker_ms_per_step
+            << " pipeline=" << use_pipeline
+            << "\n";
+  if (!restore_path.empty()) {
+    std::cout << "restored=" << restore_path << " from_step=" << start_step << "\n";
+  }
+  if (ckpt_writer) {
+    const uint64_t written = ckpt_writer->written();
+    std::cout << "checkpoint=" << ckpt_path
+              << " every=" << ckpt_every
+              << " written=" << written
+              << " skipped=" << ckpt_writer->skipped()
+              << " failed=" << ckpt_writer->failed()
+              << " bytes=" << ckpt_bytes
+              << " capture_us_avg=" << std::setprecision(4)
+              << (ckpt_due_n ? (double)ckpt_capture_ns * 1e-3 / (double)ckpt_due_n : 0.0)
+              << " write_ms_avg=" << std::setprecision(4)
+              << (written ? ckpt_writer->write_ms() / (double)written : 0.0)
+              << "\n";
+  }
+  // Per-scan averages over every scan the totals cover, including those
+  // carried over from a --restore.
+  if (tcfg.assoc == AssocMethod::Mht && tot.scans > 0) {
+    const double n = (double)tot.scans;
+    std::cout << "mht_k=" << mht_k << " mht_n_scan=" << mht_n_scan
+              << " hypotheses_avg=" << std::setprecision(4) << mht_tot.hypotheses / n
+              << " clusters_avg=" << std::setprecision(4) << mht_tot.clusters / n
+              << " reused_avg=" << std::setprecision(4) << mht_tot.cluster_reuse / n
+              << " augment_avg=" << std::setprecision(4) << (double)mht_tot.augmentations / n
+              << " pruned_avg=" << std::setprecision(4) << mht_tot.n_scan_pruned / n
+              << "\n";
+  }
+  if (tcfg.assoc == AssocMethod::Jpda && tot.scans > 0) {
+    const double n = (double)tot.scans;
+    std::cout << "jpda_exact=" << jpda_exact
+              << " exact_clusters_avg=" << std::setprecision(4) << jpda_tot.exact_clusters / n
+              << " approx_clusters_avg=" << std::setprecision(4) << jpda_tot.approx_clusters / n
+              << " events_avg=" << std::setprecision(4) << (double)jpda_tot.events / n
+              << "\n";
+  }
+  if (!replay_path.empty()) {
+    const double gb = (double)replay_bytes * 1e-9;
+    std::cout << "replay=" << replay_path
+              << " scans=" << replay.num_scans()
+              << " meas=" << replay.total_meas()
+              << " bytes=" << replay_bytes
+              << "\n";
+    if (replay_read_ms > 0.0) {
+      std::cout << "replay_read scans_per_sec=" << std::setprecision(4) << (double)steps / (replay_read_ms * 1e-3)
+                << " GB_per_s=" << std::setprecision(4) << gb / (replay_read_ms * 1e-3)
+                << "\n";
+    }
+    if (elapsed_ms > 0.0) {
+      std::cout << "replay_run scans_per_sec=" << std::setprecision(4) << (double)steps / (elapsed_ms * 1e-3)
+                << " GB_per_s=" << std::setprecision(4) << gb / (elapsed_ms * 1e-3)
+                << "\n";
+    }
+  }
+  std::cout << "stage latency:\n";
+  print_stage("ingest", ps.ingest);
+  print_stage("track", ps.process);
+  print_stage("output", ps.emit);
+  print_stage("scan", ps.end_to_end);
+
+  if (print_stats) print_tracker_stats(tracker.stats());
 
   return 0;
 }
\ No newline at end of file
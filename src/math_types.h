@@ -1,4 +1,6 @@
 #pragma once
+#include <cstddef>
+#include <vector>
 #include <Eigen/Dense>
 
 using Vec2 = Eigen::Vector2d;
@@ -6,4 +8,37 @@ using Vec4 = Eigen::Matrix<double, 4, 1>;
 using Mat2 = Eigen::Matrix<double, 2, 2>;
 using Mat4 = Eigen::Matrix<double, 4, 4>;
 using Mat2x4 = Eigen::Matrix<double, 2, 4>;
-using Mat4x2 = Eigen::Matrix<double, 4, 2>;
\ No newline at end of file
+using Mat4x2 = Eigen::Matrix<double, 4, 2>;
+using Vec3 = Eigen::Matrix<double, 3, 1>;
+using Mat3 = Eigen::Matrix<double, 3, 3>;
+using Mat4x3 = Eigen::Matrix<double, 4, 3>;
+
+// Fixed-size shapes of the templated filters (kalman_nd.h).
+template <int N>
+using VecN = Eigen::Matrix<double, N, 1>;
+template <int R, int C>
+using MatN = Eigen::Matrix<double, R, C>;
+
+// Radar detection in sensor coordinates: range (m), azimuth (rad, from +x
+// toward +y) and range rate (m/s, positive when receding).
+struct PolarMeas {
+  double range = 0.0;
+  double azimuth = 0.0;
+  double range_rate = 0.0;
+};
+// Read-only view of one scan's measurements: a std::vector owned by the caller
+// or a slice of a memory-mapped recording (see scan_file.h).
+struct MeasSpan {
+  const Vec2* ptr = nullptr;
+  size_t n = 0;
+
+  MeasSpan() = default;
+  MeasSpan(const Vec2* p, size_t count) : ptr(p), n(count) {}
+  MeasSpan(const std::vector<Vec2>& v) : ptr(v.data()), n(v.size()) {}
+
+  size_t size() const { return n; }
+  bool empty() const { return n == 0; }
+  const Vec2& operator[](size_t i) const { return ptr[i]; }
+  const Vec2* begin() const { return ptr; }
+  const Vec2* end() const { return ptr + n; }
+};
@@ -0,0 +1,396 @@
+// Track-oriented multiple-hypothesis mode of MultiTargetTracker
+// (TrackerConfig::assoc = AssocMethod::Mht).
+//
+// Per scan: the distinct track nodes of all hypotheses are predicted and
+// gated once; each hypothesis splits into gate clusters, and every distinct
+// cluster (same nodes, hence the same problem) gets one lazy k-best list.
+// A hypothesis' children are one solution per cluster, enumerated in
+// ascending total cost; the mht_hypotheses best children over all
+// hypotheses survive, then N-scan pruning drops the ones that disagree with
+// the best hypothesis mht_n_scan scans back. Track initiation follows the
+// best hypothesis and new tracks join every hypothesis.
+#include "tracker.h"
+#include "scratch.h"
+#include "fnv1a.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+namespace {
+const double kLog2Pi = 1.8378770664093453;
+}
+
+// Cluster with these node rows and measurement columns: reused when an
+// earlier hypothesis of this scan had the same nodes, solved otherwise.
+int MultiTargetTracker::mht_cluster(const std::vector<int>& rows, const std::vector<int>& cols) {
+  Fnv1a64 h;
+  for (int u : rows) h.add_u64((uint64_t)u);
+  auto range = mht_cluster_index_.equal_range(h.h);
+  for (auto it = range.first; it != range.second; ++it) {
+    if (mht_clusters_[it->second].rows == rows) {
+      mht_info_.cluster_reuse++;
+      return it->second;
+    }
+  }
+
+  const int cid = mht_num_clusters_++;
+  if ((int)mht_clusters_.size() < mht_num_clusters_) mht_clusters_.emplace_back();
+  MhtCluster& c = mht_clusters_[cid];
+  c.rows = rows;
+  c.cols = cols;
+  mht_cluster_index_.emplace(h.h, cid);
+
+  std::vector<int>& col_local = assign_ws_.col_local;
+  for (int k = 0; k < (int)cols.size(); ++k) col_local[cols[k]] = k;
+  mht_sub_.reset((int)rows.size(), (int)cols.size());
+  for (int r = 0; r < (int)rows.size(); ++r) {
+    for (int e = sparse_cost_.row_start[rows[r]]; e < sparse_cost_.row_start[rows[r] + 1]; ++e) {
+      mht_sub_.add(r, col_local[sparse_cost_.col[e]], sparse_cost_.cost[e]);
+    }
+  }
+  mht_sub_.finish();
+
+  c.kbest.reset(mht_sub_, mht_miss_.data(), cfg_.mht_hypotheses);
+  c.kbest.ensure(0);
+  c.delta = c.kbest.ensure(1) ? c.kbest.cost(1) - c.kbest.cost(0) : std::numeric_limits<double>::infinity();
+  stats_.cluster_rows.record((uint64_t)rows.size());
+  return cid;
+}
+
+void MultiTargetTracker::mht_n_scan_prune() {
+  std::vector<MhtHypothesis>& hyps = next_hyps_;
+  const int N = cfg_.mht_n_scan;
+  auto ancestor = [N](const MhtTrackNode* nd) {
+    for (int d = 0; d < N && nd; ++d) nd = nd->parent.get();
+    return nd;
+  };
+
+  // Hypotheses are best first. Merge exact duplicates (branches that only
+  // differed in tracks both have since deleted) into the better one.
+  std::unordered_multimap<uint64_t, int> seen;
+  size_t w = 0;
+  for (size_t h = 0; h < hyps.size(); ++h) {
+    Fnv1a64 sig;
+    for (const auto& nd : hyps[h].tracks) sig.add_u64((uint64_t)(uintptr_t)nd.get());
+    bool dup = false;
+    auto range = seen.equal_range(sig.h);
+    for (auto it = range.first; it != range.second && !dup; ++it) dup = hyps[(size_t)it->second].tracks == hyps[h].tracks;
+    if (dup) {
+      mht_info_.merged++;
+      continue;
+    }
+    if (w != h) hyps[w] = std::move(hyps[h]);
+    seen.emplace(sig.h, (int)w);
+    ++w;
+  }
+  hyps.resize(w);
+
+  // N-scan pruning: the state mht_n_scan scans back is decided by the best
+  // hypothesis; branches that disagree there are dropped.
+  std::unordered_map<uint32_t, const MhtTrackNode*> best_anc;
+  for (const auto& nd : hyps[0].tracks) {
+    if (const MhtTrackNode* a = ancestor(nd.get())) best_anc[nd->id] = a;
+  }
+  w = 1;
+  for (size_t h = 1; h < hyps.size(); ++h) {
+    bool agree = true;
+    for (const auto& nd : hyps[h].tracks) {
+      const MhtTrackNode* a = ancestor(nd.get());
+      if (!a) continue;
+      auto it = best_anc.find(nd->id);
+      if (it != best_anc.end() && it->second != a) {
+        agree = false;
+        break;
+      }
+    }
+    if (!agree) {
+      mht_info_.n_scan_pruned++;
+      continue;
+    }
+    if (w != h) hyps[w] = std::move(hyps[h]);
+    ++w;
+  }
+  hyps.resize(w);
+
+  const double best = hyps[0].score;
+  for (auto& hyp : hyps) {
+    hyp.score -= best;
+    // Everything below the decided ancestor is common history: cut it so
+    // memory stays at about hypotheses x tracks x mht_n_scan nodes.
+    for (const auto& nd : hyp.tracks) {
+      MhtTrackNode* a = nd.get();
+      for (int d = 0; d < N && a; ++d) a = a->parent.get();
+      if (a) a->parent.reset();
+    }
+  }
+}
+
+void MultiTargetTracker::step_mht(MeasSpan meas, double dt, double sigma_a, double sigma_z) {
+  StatsClock step_clk;
+  StatsClock clk;
+  ++scan_;
+  mht_info_ = MhtScanInfo{};
+  MhtScanInfo& si = mht_info_;
+  const int K = cfg_.mht_hypotheses;
+  const int M = (int)meas.size();
+  if (hyps_.empty()) hyps_.emplace_back();
+  const int H = (int)hyps_.size();
+
+  // 1) distinct nodes become the rows of tracks_, predicted and gated once
+  mht_node_index_.clear();
+  mht_nodes_.clear();
+  mht_rows_.resize((size_t)H);
+  for (int h = 0; h < H; ++h) {
+    std::vector<int>& rows = mht_rows_[h];
+    rows.clear();
+    for (const auto& nd : hyps_[h].tracks) {
+      auto ins = mht_node_index_.emplace(nd.get(), (int)mht_nodes_.size());
+      if (ins.second) mht_nodes_.push_back(nd);
+      rows.push_back(ins.first->second);
+    }
+  }
+  const int U = (int)mht_nodes_.size();
+  si.unique_tracks = U;
+  tracks_.clear();
+  for (const auto& nd : mht_nodes_) tracks_.push_back(nd->trk);
+  info_.resize(tracks_.size());
+  predict_all(dt, sigma_a, sigma_z, true);
+  clk.lap(stats_, TrackerStage::Predict);
+
+  build_gate_cache();
+  gate(meas);
+  clk.lap(stats_, TrackerStage::Gating);
+  stats_.pairs.record(pairs_evaluated_);
+  stats_.gated.record(gated_.size());
+
+  // 2) costs: -log(pd N(z; zhat, S) / clutter_density) per pair,
+  // -log(1 - pd) per missed track; a measurement left over is clutter (0)
+  const double pd = std::min(std::max(cfg_.p_detect, 1e-6), 1.0 - 1e-6);
+  const double miss_cost = -std::log(1.0 - pd);
+  const double pair_offset = kLog2Pi - std::log(pd) + std::log(std::max(cfg_.clutter_density, 1e-300));
+  sparse_cost_.reset(U, M);
+  mht_m2_.clear();
+  for (const auto& e : gated_) {
+    sparse_cost_.add(e.ti, e.mi, 0.5 * (e.m2 + gate_cache_[e.ti].log_det_S) + pair_offset);
+    mht_m2_.push_back(e.m2);
+  }
+  sparse_cost_.finish();
+
+  // 3) gate clusters of each hypothesis, sorted by the cost of their second
+  // best solution so the children below come out in order
+  mht_num_clusters_ = 0;
+  mht_cluster_index_.clear();
+  scratch_resize(assign_ws_.col_local, (size_t)M);
+  mht_hyp_clusters_.resize((size_t)H);
+  scratch_resize(mht_branching_, (size_t)H);
+  scratch_resize(mht_base_, (size_t)H);
+  for (int h = 0; h < H; ++h) {
+    mht_sorted_ = mht_rows_[h];
+    std::sort(mht_sorted_.begin(), mht_sorted_.end());
+    const int nr = (int)mht_sorted_.size();
+    mht_sub_.reset(nr, M);
+    for (int r = 0; r < nr; ++r) {
+      const int u = mht_sorted_[r];
+      for (int e = sparse_cost_.row_start[u]; e < sparse_cost_.row_start[u + 1]; ++e) {
+        mht_sub_.add(r, sparse_cost_.col[e], sparse_cost_.cost[e]);
+      }
+    }
+    mht_sub_.finish();
+    build_gate_clusters(mht_sub_, mht_gc_);
+
+    const GateClusters& gc = mht_gc_;
+    double base = hyps_[h].score;
+    int clustered_rows = 0;
+    std::vector<int>& list = mht_hyp_clusters_[h];
+    list.clear();
+    for (int k = 0; k < gc.count(); ++k) {
+      mht_tmp_rows_.clear();
+      for (int r = gc.row_start[k]; r < gc.row_start[k + 1]; ++r) mht_tmp_rows_.push_back(mht_sorted_[gc.rows[r]]);
+      mht_tmp_cols_.assign(gc.cols.begin() + gc.col_start[k], gc.cols.begin() + gc.col_start[k + 1]);
+      clustered_rows += (int)mht_tmp_rows_.size();
+      scratch_assign(mht_miss_, mht_tmp_rows_.size(), miss_cost);
+      const int cid = mht_cluster(mht_tmp_rows_, mht_tmp_cols_);
+      base += mht_clusters_[cid].kbest.cost(0);
+      list.push_back(cid);
+    }
+    base += miss_cost * (double)(nr - clustered_rows); // tracks with nothing in the gate
+
+    std::sort(list.begin(), list.end(), [&](int a, int b) {
+      const double da = mht_clusters_[a].delta;
+      const double db = mht_clusters_[b].delta;
+      return da != db ? da < db : a < b;
+    });
+    int branching = 0;
+    while (branching < (int)list.size() && mht_clusters_[list[branching]].kbest.count() > 1) ++branching;
+    mht_branching_[h] = branching;
+    mht_base_[h] = base;
+  }
+  si.clusters = mht_num_clusters_;
+
+  // 4) best children over all hypotheses. A child picks solution index
+  // i_c in each branching cluster c (clusters sorted by delta); from the
+  // last changed position p a combo spawns: i_p + 1; i_{p+1} = 1; and, if
+  // i_p == 1, i_p = 0 with i_{p+1} = 1. Every index vector is reached exactly
+  // once and never before a cheaper one.
+  mht_combos_.clear();
+  mht_heap_.clear();
+  mht_selected_.clear();
+  auto worse = [&](int a, int b) {
+    const MhtCombo& x = mht_combos_[a];
+    const MhtCombo& y = mht_combos_[b];
+    return x.score != y.score ? x.score > y.score : a > b;
+  };
+  auto push = [&](const MhtCombo& c) {
+    mht_combos_.push_back(c);
+    mht_heap_.push_back((int)mht_combos_.size() - 1);
+    std::push_heap(mht_heap_.begin(), mht_heap_.end(), worse);
+  };
+  for (int h = 0; h < H; ++h) push({mht_base_[h], h, -1, 0, -1});
+  while ((int)mht_selected_.size() < K && !mht_heap_.empty()) {
+    std::pop_heap(mht_heap_.begin(), mht_heap_.end(), worse);
+    const int id = mht_heap_.back();
+    mht_heap_.pop_back();
+    mht_selected_.push_back(id);
+
+    const MhtCombo c = mht_combos_[id];
+    const std::vector<int>& list = mht_hyp_clusters_[c.hyp];
+    const int C = mht_branching_[c.hyp];
+    if (c.pos == -1) {
+      if (C > 0) push({c.score + mht_clusters_[list[0]].delta, c.hyp, 0, 1, id});
+      continue;
+    }
+    MhtCluster& cl = mht_clusters_[list[c.pos]];
+    if (cl.kbest.ensure(c.idx + 1)) {
+      push({c.score - cl.kbest.cost(c.idx) + cl.kbest.cost(c.idx + 1), c.hyp, c.pos, c.idx + 1, c.parent});
+    }
+    if (c.pos + 1 < C) {
+      const double next = mht_clusters_[list[c.pos + 1]].delta;
+      push({c.score + next, c.hyp, c.pos + 1, 1, id});
+      if (c.idx == 1) push({c.score - cl.delta + next, c.hyp, c.pos + 1, 1, c.parent});
+    }
+  }
+  for (int k = 0; k < mht_num_clusters_; ++k) si.augmentations += mht_clusters_[k].kbest.augmentations();
+  clk.lap(stats_, TrackerStage::Assign);
+
+  // 5) child hypotheses. Nodes are shared: a (node, measurement) pair is
+  // updated once however many children pick it.
+  mht_children_.clear();
+  auto child_node = [&](int u, int mi) {
+    std::shared_ptr<MhtTrackNode>& slot = mht_children_[(uint64_t)u * (uint64_t)(M + 1) + (uint64_t)(mi + 1)];
+    if (slot) return slot;
+    slot = std::make_shared<MhtTrackNode>(tracks_[u]);
+    MhtTrackNode& nd = *slot;
+    nd.id = mht_nodes_[u]->id;
+    nd.scan = scan_;
+    nd.meas = mi;
+    nd.parent = mht_nodes_[u];
+    Track& t = nd.trk;
+    t.hits.push(mi != -1, cfg_.confirm_N);
+    if (mi == -1) {
+      t.misses += 1;
+    } else {
+      t.kf.update_pos(meas[mi], gate_cache_[u].ic, cfg_.cov_update, &nd.innov);
+      nd.S = gate_cache_[u].ic.S;
+      for (int e = sparse_cost_.row_start[u]; e < sparse_cost_.row_start[u + 1]; ++e) {
+        if (sparse_cost_.col[e] == mi) nd.last_maha2 = mht_m2_[e];
+      }
+      t.misses = 0;
+    }
+    t.confirmed = (t.hits_in_window() >= cfg_.confirm_M);
+    si.nodes_created++;
+    return slot;
+  };
+
+  scratch_assign(mht_meas_of_, (size_t)U, -1);
+  next_hyps_.resize(mht_selected_.size());
+  for (size_t s = 0; s < mht_selected_.size(); ++s) {
+    const MhtCombo& c = mht_combos_[mht_selected_[s]];
+    const std::vector<int>& list = mht_hyp_clusters_[c.hyp];
+    scratch_assign(mht_sol_idx_, list.size(), 0);
+    for (int q = mht_selected_[s]; mht_combos_[q].pos != -1; q = mht_combos_[q].parent) {
+      mht_sol_idx_[mht_combos_[q].pos] = mht_combos_[q].idx;
+    }
+
+    for (int u : mht_rows_[c.hyp]) mht_meas_of_[u] = -1;
+    for (size_t p = 0; p < list.size(); ++p) {
+      const MhtCluster& cl = mht_clusters_[list[p]];
+      const int* a = cl.kbest.assignment(mht_sol_idx_[p]);
+      for (size_t r = 0; r < cl.rows.size(); ++r) mht_meas_of_[cl.rows[r]] = a[r] == -1 ? -1 : cl.cols[a[r]];
+    }
+
+    MhtHypothesis& child = next_hyps_[s];
+    child.score = c.score;
+    child.tracks.clear();
+    for (int u : mht_rows_[c.hyp]) {
+      const std::shared_ptr<MhtTrackNode>& nd = child_node(u, mht_meas_of_[u]);
+      if (track_lost(nd->trk)) continue;
+      child.tracks.push_back(nd);
+    }
+  }
+  clk.lap(stats_, TrackerStage::Update);
+
+  // 6) merge, N-scan prune, renormalize
+  mht_n_scan_prune();
+  hyps_.swap(next_hyps_);
+  // Drop this scan's references to pruned branches and old nodes.
+  for (auto& hyp : next_hyps_) hyp.tracks.clear();
+  mht_nodes_.clear();
+  mht_children_.clear();
+  clk.lap(stats_, TrackerStage::Prune);
+
+  // 7) output the best hypothesis; initiation runs on what it left unassigned
+  const MhtHypothesis& best = hyps_[0];
+  const size_t T = best.tracks.size();
+  tracks_.clear();
+  info_.clear();
+  scratch_assign(assoc_.track_to_meas, T, -1);
+  scratch_assign(assoc_.meas_to_track, (size_t)M, -1);
+  for (size_t i = 0; i < T; ++i) {
+    const MhtTrackNode& nd = *best.tracks[i];
+    tracks_.push_back(nd.trk);
+    TrackInfo info;
+    info.id = nd.id;
+    info.last_maha2 = nd.last_maha2;
+    info_.push_back(info);
+    if (nd.meas != -1) {
+      assoc_.track_to_meas[i] = nd.meas;
+      assoc_.meas_to_track[nd.meas] = (int)i;
+    }
+  }
+
+  // A new track joins every hypothesis that left its measurement unused;
+  // elsewhere that measurement already belongs to a track.
+  initiate_from_unassigned_candidates(meas, assoc_, dt, sigma_a, sigma_z);
+  if (tracks_.size() > T) {
+    std::vector<std::shared_ptr<MhtTrackNode>> born;
+    for (size_t i = T; i < tracks_.size(); ++i) {
+      born.push_back(std::make_shared<MhtTrackNode>(tracks_[i]));
+      born.back()->id = info_[i].id;
+      born.back()->scan = scan_;
+      si.nodes_created++;
+    }
+    for (auto& hyp : hyps_) {
+      scratch_assign(mht_meas_of_, (size_t)M, -1);
+      for (const auto& nd : hyp.tracks) {
+        if (nd->meas != -1) mht_meas_of_[nd->meas] = 1;
+      }
+      for (size_t b = 0; b < born.size(); ++b) {
+        const int mi = born_meas_[b];
+        if (mi == -1 || mht_meas_of_[mi] == -1) hyp.tracks.push_back(born[b]);
+      }
+    }
+  }
+
+  scratch_assign(last_innovs_, tracks_.size(), Vec2::Zero());
+  scratch_assign(last_S_, tracks_.size(), Mat2::Zero());
+  for (size_t i = 0; i < T; ++i) {
+    last_innovs_[i] = best.tracks[i]->innov;
+    last_S_[i] = best.tracks[i]->S;
+  }
+  si.hypotheses = (int)hyps_.size();
+  clk.lap(stats_, TrackerStage::Initiate);
+  step_clk.lap(stats_, TrackerStage::Step);
+  stats_.candidates.record(cands_.size());
+  stats_.tracks.record(tracks_.size());
+}
@@ -0,0 +1,295 @@
+#include "murty.h"
+#include "scratch.h"
+#include <algorithm>
+#include <limits>
+
+static const double kInf = std::numeric_limits<double>::infinity();
+
+void KBestAssignment::reset(const SparseCost& g, const double* miss_cost, int max_solutions) {
+  n_ = g.rows;
+  m_ = g.cols;
+  size_ = n_ + m_;
+  max_solutions_ = max_solutions;
+  started_ = false;
+  expand_ = -1;
+  seq_ = 0;
+  augmentations_ = 0;
+  queue_.clear();
+  free_nodes_.clear();
+  for (int id = (int)nodes_.size() - 1; id >= 0; --id) free_nodes_.push_back(id);
+  sol_cost_.clear();
+  sol_assign_.clear();
+
+  // Square problem. Track row i: its gated columns, then its miss column
+  // m + i. Clutter row n + j: column j, then the miss column of every track
+  // gated with j, all at cost 0, so a clutter row can stand in for a track
+  // that missed only when that track could have taken its column.
+  const int num_edges = g.row_start[n_];
+  scratch_assign(start_, (size_t)size_ + 1, 0);
+  for (int i = 0; i < n_; ++i) start_[i + 1] = g.row_start[i + 1] - g.row_start[i] + 1;
+  for (int e = 0; e < num_edges; ++e) start_[n_ + g.col[e] + 1]++;
+  for (int j = 0; j < m_; ++j) start_[n_ + j + 1] += 1;
+  for (int r = 0; r < size_; ++r) start_[r + 1] += start_[r];
+
+  const size_t total = (size_t)start_[size_];
+  scratch_resize(col_, total);
+  scratch_resize(cost_, total);
+  scratch_resize(edge_row_, total);
+  scratch_assign(edge_forbidden_, total, 0);
+
+  std::vector<int>& cursor = touched_; // free until the first augment
+  scratch_resize(cursor, (size_t)size_);
+  for (int r = 0; r < size_; ++r) cursor[r] = start_[r];
+  for (int j = 0; j < m_; ++j) {
+    const int k = cursor[n_ + j]++;
+    col_[k] = j;
+    cost_[k] = 0.0;
+  }
+  for (int i = 0; i < n_; ++i) {
+    for (int e = g.row_start[i]; e < g.row_start[i + 1]; ++e) {
+      int k = cursor[i]++;
+      col_[k] = g.col[e];
+      cost_[k] = g.cost[e];
+      k = cursor[n_ + g.col[e]]++;
+      col_[k] = m_ + i;
+      cost_[k] = 0.0;
+    }
+    const int k = cursor[i]++;
+    col_[k] = m_ + i;
+    cost_[k] = miss_cost[i];
+  }
+  for (int r = 0; r < size_; ++r) {
+    for (int k = start_[r]; k < start_[r + 1]; ++k) edge_row_[k] = r;
+  }
+  cursor.clear();
+
+  scratch_assign(col_excluded_, (size_t)size_, 0);
+  scratch_assign(dist_, (size_t)size_, kInf);
+  scratch_assign(done_, (size_t)size_, 0);
+  scratch_resize(prev_edge_, (size_t)size_);
+}
+
+int KBestAssignment::alloc_node() {
+  if (!free_nodes_.empty()) {
+    const int id = free_nodes_.back();
+    free_nodes_.pop_back();
+    return id;
+  }
+  nodes_.emplace_back();
+  return (int)nodes_.size() - 1;
+}
+
+void KBestAssignment::release_node(int id) { free_nodes_.push_back(id); }
+
+// Heap order: lower cost first, then older node.
+void KBestAssignment::push_queue(int id) {
+  queue_.push_back(id);
+  std::push_heap(queue_.begin(), queue_.end(), [&](int a, int b) {
+    const Node& x = nodes_[a];
+    const Node& y = nodes_[b];
+    return x.cost != y.cost ? x.cost > y.cost : x.seq > y.seq;
+  });
+}
+
+int KBestAssignment::pop_queue() {
+  std::pop_heap(queue_.begin(), queue_.end(), [&](int a, int b) {
+    const Node& x = nodes_[a];
+    const Node& y = nodes_[b];
+    return x.cost != y.cost ? x.cost > y.cost : x.seq > y.seq;
+  });
+  const int id = queue_.back();
+  queue_.pop_back();
+  return id;
+}
+
+// Only max_solutions - count() more solutions can be reported, so any queued
+// subproblem beyond that many better ones is dead weight.
+void KBestAssignment::trim_queue() {
+  const size_t keep = (size_t)std::max(max_solutions_ - count(), 0);
+  if (queue_.size() <= keep) return;
+  auto better = [&](int a, int b) {
+    const Node& x = nodes_[a];
+    const Node& y = nodes_[b];
+    return x.cost != y.cost ? x.cost < y.cost : x.seq < y.seq;
+  };
+  std::nth_element(queue_.begin(), queue_.begin() + (std::ptrdiff_t)keep, queue_.end(), better);
+  for (size_t q = keep; q < queue_.size(); ++q) release_node(queue_[q]);
+  queue_.resize(keep);
+  std::make_heap(queue_.begin(), queue_.end(), [&](int a, int b) { return better(b, a); });
+}
+
+double KBestAssignment::matching_cost(const Node& nd) const {
+  double c = 0.0;
+  for (int i = 0; i < n_; ++i) c += cost_[nd.row_edge[i]];
+  return c;
+}
+
+// Shortest augmenting path from free row s on reduced costs (Dijkstra),
+// skipping forbidden edges and excluded columns. Stops at the first free
+// column reached; columns settled before it shift their duals by
+// dist - dist*, which keeps every reduced cost >= 0 and the new matched
+// edges tight, so the next augmentation can start from these duals.
+bool KBestAssignment::augment(Node& nd, int s) {
+  for (int j : touched_) {
+    dist_[j] = kInf;
+    done_[j] = 0;
+  }
+  touched_.clear();
+  heap_.clear();
+
+  auto later = [](const HeapItem& a, const HeapItem& b) {
+    if (a.d != b.d) return a.d > b.d;
+    return a.j > b.j;
+  };
+  auto relax_row = [&](int i, double di) {
+    for (int e = start_[i]; e < start_[i + 1]; ++e) {
+      if (edge_forbidden_[e]) continue;
+      const int j = col_[e];
+      if (col_excluded_[j] || done_[j]) continue;
+      const double d = di + cost_[e] - nd.u[i] - nd.v[j];
+      if (d < dist_[j]) {
+        if (dist_[j] == kInf) touched_.push_back(j);
+        dist_[j] = d;
+        prev_edge_[j] = e;
+        heap_.push_back({d, j});
+        std::push_heap(heap_.begin(), heap_.end(), later);
+      }
+    }
+  };
+
+  relax_row(s, 0.0);
+  int end_col = -1;
+  while (!heap_.empty()) {
+    std::pop_heap(heap_.begin(), heap_.end(), later);
+    const HeapItem it = heap_.back();
+    heap_.pop_back();
+    if (done_[it.j] || it.d > dist_[it.j]) continue;
+    done_[it.j] = 1;
+    const int i = nd.col_row[it.j];
+    if (i == -1) {
+      end_col = it.j;
+      break;
+    }
+    relax_row(i, it.d);
+  }
+  if (end_col == -1) return false;
+  augmentations_++;
+
+  const double d_end = dist_[end_col];
+  for (int j : touched_) {
+    if (!done_[j]) continue;
+    const double delta = dist_[j] - d_end;
+    nd.v[j] += delta;
+    const int i = nd.col_row[j];
+    if (i != -1) nd.u[i] -= delta;
+  }
+  nd.u[s] += d_end;
+
+  for (int j = end_col;;) {
+    const int e = prev_edge_[j];
+    const int i = edge_row_[e];
+    const int next = nd.row_edge[i] == -1 ? -1 : col_[nd.row_edge[i]];
+    nd.row_edge[i] = e;
+    nd.col_row[j] = i;
+    if (i == s) break;
+    j = next;
+  }
+  return true;
+}
+
+// Murty partition of a reported solution: child k keeps the solution's pairs
+// for free rows [0, k), forbids free row k its pair, and leaves the rest
+// free. Each child starts from the parent's matching and duals minus row k's
+// pair, so one augmenting path from row k re-solves it.
+void KBestAssignment::expand(int id) {
+  for (int e : nodes_[id].forbidden) edge_forbidden_[e] = 1;
+
+  // Rows fixed by earlier branching keep their columns.
+  scratch_assign(row_free_, (size_t)n_, 0);
+  for (int r : nodes_[id].free_rows) row_free_[r] = 1;
+  for (int i = 0; i < n_; ++i) {
+    if (!row_free_[i]) col_excluded_[col_[nodes_[id].row_edge[i]]] = 1;
+  }
+
+  const int num_free = (int)nodes_[id].free_rows.size();
+  for (int k = 0; k < num_free; ++k) {
+    const int cid = alloc_node();
+    Node& c = nodes_[cid];
+    const Node& p = nodes_[id];
+    const int r = p.free_rows[k];
+    const int e = p.row_edge[r];
+    const int j = col_[e];
+
+    c.row_edge = p.row_edge;
+    c.col_row = p.col_row;
+    c.u = p.u;
+    c.v = p.v;
+    c.row_edge[r] = -1;
+    c.col_row[j] = -1;
+
+    edge_forbidden_[e] = 1;
+    const bool ok = augment(c, r);
+    edge_forbidden_[e] = 0;
+
+    if (ok) {
+      c.cost = matching_cost(c);
+      c.seq = seq_++;
+      c.free_rows.assign(p.free_rows.begin() + k, p.free_rows.end());
+      c.forbidden = p.forbidden;
+      c.forbidden.push_back(e);
+      push_queue(cid);
+    } else {
+      release_node(cid);
+    }
+    col_excluded_[j] = 1; // row r is fixed for the remaining children
+  }
+
+  for (int e : nodes_[id].forbidden) edge_forbidden_[e] = 0;
+  std::fill(col_excluded_.begin(), col_excluded_.end(), 0);
+  release_node(id);
+  trim_queue();
+}
+
+bool KBestAssignment::ensure(int k) {
+  if (k >= max_solutions_) return false;
+  while (count() <= k) {
+    if (!started_) {
+      started_ = true;
+      const int id = alloc_node();
+      Node& nd = nodes_[id];
+      nd.row_edge.assign((size_t)size_, -1);
+      nd.col_row.assign((size_t)size_, -1);
+      nd.u.assign((size_t)size_, 0.0);
+      nd.v.assign((size_t)size_, kInf);
+      // Every column has an incoming edge; start at its cheapest one.
+      for (int e = 0; e < start_[size_]; ++e) nd.v[col_[e]] = std::min(nd.v[col_[e]], cost_[e]);
+      bool ok = true;
+      for (int s = 0; s < size_ && ok; ++s) ok = augment(nd, s);
+      if (!ok) {
+        release_node(id);
+        return false;
+      }
+      nd.cost = matching_cost(nd);
+      nd.seq = seq_++;
+      nd.free_rows.resize((size_t)n_);
+      for (int i = 0; i < n_; ++i) nd.free_rows[i] = i;
+      nd.forbidden.clear();
+      push_queue(id);
+    } else if (expand_ != -1) {
+      const int id = expand_;
+      expand_ = -1;
+      expand(id);
+    }
+    if (queue_.empty()) return false;
+
+    const int id = pop_queue();
+    const Node& nd = nodes_[id];
+    sol_cost_.push_back(nd.cost);
+    for (int i = 0; i < n_; ++i) {
+      const int c = col_[nd.row_edge[i]];
+      sol_assign_.push_back(c < m_ ? c : -1);
+    }
+    expand_ = id;
+  }
+  return true;
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include "hungarian.h"
+
+// k-best assignments of one track/measurement cluster (Murty 1968), in
+// ascending cost.
+//
+// Every row (track) takes one of its gated columns or its own miss option
+// (miss_cost[r]); columns nobody takes are clutter at cost 0. Internally the
+// problem is made square, with one clutter row per column and one miss
+// column per row, and solved with shortest augmenting paths that keep the
+// dual potentials. A Murty subproblem differs from its parent by one
+// forbidden pair, so it is re-solved from the parent's solution and duals
+// with a single augmenting path (Miller, Stone & Cox 1997) instead of from
+// scratch. Only track rows are branched on, so two solutions never differ
+// in clutter bookkeeping alone.
+//
+// Memory is bounded by max_solutions: the subproblem queue is trimmed to the
+// number of solutions that can still be reported.
+class KBestAssignment {
+public:
+  // g: rows x cols costs of the gated pairs (any sign); miss_cost[r]: row r
+  // undetected. Discards earlier solutions but keeps buffer capacity.
+  void reset(const SparseCost& g, const double* miss_cost, int max_solutions);
+
+  // Makes solution k available; false if the problem has at most k solutions
+  // (or k >= max_solutions).
+  bool ensure(int k);
+
+  int rows() const { return n_; }
+  int count() const { return (int)sol_cost_.size(); }
+  double cost(int k) const { return sol_cost_[(size_t)k]; }
+  // Column of each row in solution k, -1 = miss.
+  const int* assignment(int k) const { return sol_assign_.data() + (size_t)k * (size_t)n_; }
+
+  // Shortest augmenting paths run since reset() (root solve included).
+  uint64_t augmentations() const { return augmentations_; }
+
+private:
+  // Solved subproblem: its matching and duals, and the Murty constraints
+  // that define it (rows still free to branch on, forbidden edges).
+  struct Node {
+    double cost = 0.0;
+    uint64_t seq = 0;               // creation order, breaks cost ties
+    std::vector<int> row_edge;      // matched edge of each square row
+    std::vector<int> col_row;       // matched row of each square column
+    std::vector<double> u, v;       // reduced cost = c - u[row] - v[col] >= 0
+    std::vector<int> free_rows;     // track rows not fixed, branch order
+    std::vector<int> forbidden;     // forbidden edges
+  };
+
+  int n_ = 0;     // track rows
+  int m_ = 0;     // measurement columns
+  int size_ = 0;  // square size n + m
+  int max_solutions_ = 0;
+  bool started_ = false;
+  int expand_ = -1; // node whose children are still to be generated
+  uint64_t seq_ = 0;
+  uint64_t augmentations_ = 0;
+
+  // square problem, CSR by row: tracks, then one clutter row per column
+  std::vector<int> start_, col_, edge_row_;
+  std::vector<double> cost_;
+  std::vector<char> edge_forbidden_;
+  std::vector<char> col_excluded_;
+  std::vector<char> row_free_;
+
+  std::vector<Node> nodes_;       // pool, reused across reset()
+  std::vector<int> free_nodes_;
+  std::vector<int> queue_;        // heap of node indices, best on top
+
+  std::vector<double> sol_cost_;
+  std::vector<int> sol_assign_;   // count() x n_
+
+  // Dijkstra scratch
+  struct HeapItem {
+    double d;
+    int j;
+  };
+  std::vector<double> dist_;
+  std::vector<int> prev_edge_;
+  std::vector<char> done_;
+  std::vector<int> touched_;
+  std::vector<HeapItem> heap_;
+
+  int alloc_node();
+  void release_node(int id);
+  void push_queue(int id);
+  int pop_queue();
+  void trim_queue();
+
+  double matching_cost(const Node& nd) const;
+  bool augment(Node& nd, int s);
+  void expand(int id);
+};
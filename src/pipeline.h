@@ -0,0 +1,140 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "latency_hist.h"
+#include "spsc_ring.h"
+
+// Three-stage streaming runtime: ingest -> process -> emit.
+//
+// Frames live in a fixed pool and travel between stages as pointers through
+// bounded SPSC rings; emitted frames return to ingest on a recycle ring, so the
+// steady state allocates nothing and the pool size bounds frames in flight
+// (backpressure). A null pointer marks end of stream.
+//
+// Threaded mode runs ingest and emit on their own threads and process on the
+// caller's thread; sequential mode runs the same stage functions inline.
+// Stage functions see frames in order either way, so output is identical.
+
+struct PipelineStats {
+  LatencyHistogram ingest;     // per-frame work, ns
+  LatencyHistogram process;
+  LatencyHistogram emit;
+  LatencyHistogram end_to_end; // ingest start -> emit done
+  double wall_ms = 0.0;
+};
+
+namespace pipeline_detail {
+
+inline uint64_t now_ns() {
+  return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Brief spin, then yield: stages are usually only a few microseconds apart.
+struct Backoff {
+  int spins = 0;
+  void pause() {
+    if (++spins > 64) std::this_thread::yield();
+  }
+};
+
+template <typename T>
+void push_wait(SpscRing<T>& r, const T& v) {
+  Backoff b;
+  while (!r.try_push(v)) b.pause();
+}
+
+template <typename T>
+T pop_wait(SpscRing<T>& r) {
+  T v{};
+  Backoff b;
+  while (!r.try_pop(v)) b.pause();
+  return v;
+}
+
+} // namespace pipeline_detail
+
+// ingest(Frame&, int item), process(Frame&), emit(Frame&) are each called once
+// per item, in item order. depth = number of frames in flight (>= 1).
+template <typename Frame, typename Ingest, typename Process, typename Emit>
+PipelineStats run_pipeline(int num_items, int depth, bool threaded,
+                           Ingest&& ingest, Process&& process, Emit&& emit) {
+  using pipeline_detail::now_ns;
+  struct Slot {
+    Frame frame;
+    uint64_t t_start = 0;
+  };
+
+  PipelineStats st;
+  if (depth < 1) depth = 1;
+  const uint64_t w0 = now_ns();
+
+  if (!threaded) {
+    Slot s;
+    for (int i = 0; i < num_items; ++i) {
+      const uint64_t a = now_ns();
+      ingest(s.frame, i);
+      const uint64_t b = now_ns();
+      process(s.frame);
+      const uint64_t c = now_ns();
+      emit(s.frame);
+      const uint64_t d = now_ns();
+      st.ingest.record(b - a);
+      st.process.record(c - b);
+      st.emit.record(d - c);
+      st.end_to_end.record(d - a);
+    }
+    st.wall_ms = (double)(now_ns() - w0) * 1e-6;
+    return st;
+  }
+
+  std::vector<Slot> pool((size_t)depth);
+  SpscRing<Slot*> free_ring((size_t)depth);
+  SpscRing<Slot*> in_ring((size_t)depth + 1);
+  SpscRing<Slot*> out_ring((size_t)depth + 1);
+  for (auto& s : pool) free_ring.try_push(&s);
+
+  std::thread ingest_thread([&] {
+    for (int i = 0; i < num_items; ++i) {
+      Slot* s = pipeline_detail::pop_wait(free_ring);
+      const uint64_t a = now_ns();
+      s->t_start = a;
+      ingest(s->frame, i);
+      st.ingest.record(now_ns() - a);
+      pipeline_detail::push_wait(in_ring, s);
+    }
+    pipeline_detail::push_wait(in_ring, (Slot*)nullptr);
+  });
+
+  std::thread emit_thread([&] {
+    for (;;) {
+      Slot* s = pipeline_detail::pop_wait(out_ring);
+      if (!s) break;
+      const uint64_t a = now_ns();
+      emit(s->frame);
+      const uint64_t b = now_ns();
+      st.emit.record(b - a);
+      st.end_to_end.record(b - s->t_start);
+      pipeline_detail::push_wait(free_ring, s);
+    }
+  });
+
+  for (;;) {
+    Slot* s = pipeline_detail::pop_wait(in_ring);
+    if (s) {
+      const uint64_t a = now_ns();
+      process(s->frame);
+      st.process.record(now_ns() - a);
+    }
+    pipeline_detail::push_wait(out_ring, s);
+    if (!s) break;
+  }
+
+  ingest_thread.join();
+  emit_thread.join();
+  st.wall_ms = (double)(now_ns() - w0) * 1e-6;
+  return st;
+}
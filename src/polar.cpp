@@ -0,0 +1,217 @@
+#include "polar.h"
+#include "kalman_sqrt.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const double kPi = 3.14159265358979323846;
+
+double wrap_angle(double a) {
+  if (a > kPi) a -= 2.0 * kPi * std::ceil((a - kPi) / (2.0 * kPi));
+  else if (a <= -kPi) a += 2.0 * kPi * std::ceil((-kPi - a) / (2.0 * kPi));
+  return a;
+}
+
+// h(x) for state x; the range is floored so a track on top of the sensor
+// stays finite.
+Vec3 measure(const Vec4& x, const Vec2& s) {
+  const double dx = x(0) - s(0), dy = x(1) - s(1);
+  const double r = std::max(std::sqrt(dx * dx + dy * dy), 1e-6);
+  return Vec3(r, std::atan2(dy, dx), (dx * x(2) + dy * x(3)) / r);
+}
+
+// C = P H^T and S = H P H^T (R added by the caller) with the analytic
+// Jacobian at x:
+//   dr/dp = d / r,  daz/dp = (-dy, dx) / r^2,
+//   drr/dp = (v - rr d / r) / r,  drr/dv = d / r.
+void linearize(const KalmanCV2D& kf, const Vec2& s, const Vec3& h, Mat3& S, Mat4x3& C) {
+  const double dx = kf.x(0) - s(0), dy = kf.x(1) - s(1);
+  const double r = h(0), rr = h(2);
+  const double ux = dx / r, uy = dy / r;
+  double H[3][4] = {
+    {ux, uy, 0.0, 0.0},
+    {-uy / r, ux / r, 0.0, 0.0},
+    {(kf.x(2) - rr * ux) / r, (kf.x(3) - rr * uy) / r, ux, uy},
+  };
+  for (int i = 0; i < 4; ++i) {
+    for (int k = 0; k < 3; ++k) {
+      double c = 0.0;
+      for (int j = 0; j < 4; ++j) c += kf.P(i,j) * H[k][j];
+      C(i,k) = c;
+    }
+  }
+  for (int a = 0; a < 3; ++a) {
+    for (int b = a; b < 3; ++b) {
+      double v = 0.0;
+      for (int j = 0; j < 4; ++j) v += H[a][j] * C(j,b);
+      S(a,b) = v;
+      S(b,a) = v;
+    }
+  }
+}
+
+// Unscented transform with alpha 1, beta 2, kappa 0 (lambda = 0): sigma
+// points x and x +- 2 L_i, mean weights 0 and 1/8, covariance weight 2 on
+// x. Azimuths are averaged as residuals from the center point's. Returns
+// false when P is not positive definite.
+bool unscented(const KalmanCV2D& kf, const Vec2& s, Vec3& h, Mat3& S, Mat4x3& C) {
+  Mat4 L;
+  if (!cholesky4(kf.P, L)) return false;
+
+  Vec3 z[9];
+  Vec4 dxs[9];
+  z[0] = measure(kf.x, s);
+  dxs[0].setZero();
+  for (int i = 0; i < 4; ++i) {
+    const Vec4 d = 2.0 * L.col(i);
+    dxs[1 + i] = d;
+    dxs[5 + i] = -d;
+    z[1 + i] = measure(kf.x + d, s);
+    z[5 + i] = measure(kf.x - d, s);
+  }
+  const double w = 1.0 / 8.0;
+  h = Vec3::Zero();
+  for (int k = 1; k < 9; ++k) {
+    z[k](1) = z[0](1) + wrap_angle(z[k](1) - z[0](1));
+    h += w * z[k];
+  }
+
+  S.setZero();
+  C.setZero();
+  for (int k = 0; k < 9; ++k) {
+    const double wc = k == 0 ? 2.0 : w;
+    const Vec3 dz = z[k] - h;
+    S += wc * (dz * dz.transpose());
+    C += wc * (dxs[k] * dz.transpose());
+  }
+  h(1) = wrap_angle(h(1));
+  return true;
+}
+
+} // namespace
+
+void polar_predict(const KalmanCV2D& kf, const PolarModel& m, PolarGate& g, Vec2& center, Vec2& half) {
+  if (m.filter != PolarFilter::Ukf || !unscented(kf, m.sensor, g.h, g.S, g.C)) {
+    g.h = measure(kf.x, m.sensor);
+    linearize(kf, m.sensor, g.h, g.S, g.C);
+  }
+  g.S(0,0) += m.sigma_r * m.sigma_r;
+  g.S(1,1) += m.sigma_az * m.sigma_az;
+  g.S(2,2) += m.sigma_rr * m.sigma_rr;
+
+  g.S_inv.setZero();
+  if (m.doppler) {
+    // Cofactors of the symmetric 3x3.
+    const Mat3& S = g.S;
+    const double c00 = S(1,1) * S(2,2) - S(1,2) * S(1,2);
+    const double c01 = S(0,2) * S(1,2) - S(0,1) * S(2,2);
+    const double c02 = S(0,1) * S(1,2) - S(0,2) * S(1,1);
+    const double inv_det = 1.0 / (S(0,0) * c00 + S(0,1) * c01 + S(0,2) * c02);
+    g.S_inv(0,0) = c00 * inv_det;
+    g.S_inv(0,1) = g.S_inv(1,0) = c01 * inv_det;
+    g.S_inv(0,2) = g.S_inv(2,0) = c02 * inv_det;
+    g.S_inv(1,1) = (S(0,0) * S(2,2) - S(0,2) * S(0,2)) * inv_det;
+    g.S_inv(1,2) = g.S_inv(2,1) = (S(0,2) * S(0,1) - S(0,0) * S(1,2)) * inv_det;
+    g.S_inv(2,2) = (S(0,0) * S(1,1) - S(0,1) * S(0,1)) * inv_det;
+    g.rr_half = std::sqrt(m.gate * g.S(2,2)) * (1.0 + 1e-9) + 1e-9;
+  } else {
+    const double inv_det = 1.0 / (g.S(0,0) * g.S(1,1) - g.S(0,1) * g.S(0,1));
+    g.S_inv(0,0) = g.S(1,1) * inv_det;
+    g.S_inv(0,1) = g.S_inv(1,0) = -g.S(0,1) * inv_det;
+    g.S_inv(1,1) = g.S(0,0) * inv_det;
+    g.rr_half = 0.0;
+  }
+
+  // Every (r, az) in the gate has |r - r_pred| <= dr and |az - az_pred| <=
+  // daz: an annular sector, which lies inside the rectangle along the line
+  // of sight u of half extents dr + r_pred (1 - cos daz) along u and
+  // (r_pred + dr) sin daz across it. The box is that rectangle's bounding
+  // box, widened like the Cartesian gate boxes. From daz = pi/2 on the
+  // sector reaches behind the sensor, so the box is the square around the
+  // sensor that holds the disc of radius r_pred + dr.
+  const double dr = std::sqrt(m.gate * g.S(0,0));
+  const double daz = std::sqrt(m.gate * g.S(1,1));
+  if (daz >= 0.5 * kPi) {
+    const double r_max = (g.h(0) + dr) * (1.0 + 1e-9) + 1e-9;
+    center = m.sensor;
+    half = Vec2(r_max, r_max);
+    return;
+  }
+  const Vec2 u(std::cos(g.h(1)), std::sin(g.h(1)));
+  const double a = dr + g.h(0) * (1.0 - std::cos(daz));
+  const double b = (g.h(0) + dr) * std::sin(daz);
+  center = m.sensor + g.h(0) * u;
+  half = Vec2((a * std::abs(u(0)) + b * std::abs(u(1))) * (1.0 + 1e-9) + 1e-9,
+              (a * std::abs(u(1)) + b * std::abs(u(0))) * (1.0 + 1e-9) + 1e-9);
+}
+
+bool polar_maha2(const PolarGate& g, const PolarMeas& z, const PolarModel& m, double& m2) {
+  const double yrr = z.range_rate - g.h(2);
+  if (m.doppler && std::abs(yrr) > g.rr_half) return false;
+  const double y[3] = {z.range - g.h(0), wrap_angle(z.azimuth - g.h(1)), m.doppler ? yrr : 0.0};
+  double s = 0.0;
+  for (int a = 0; a < 3; ++a) {
+    s += g.S_inv(a,a) * y[a] * y[a];
+    for (int b = a + 1; b < 3; ++b) s += 2.0 * g.S_inv(a,b) * y[a] * y[b];
+  }
+  m2 = s;
+  return true;
+}
+
+void polar_update(KalmanCV2D& kf, const PolarGate& g, const PolarMeas& z, const PolarModel& m,
+                  Vec2* out_innovation) {
+  const double y[3] = {z.range - g.h(0), wrap_angle(z.azimuth - g.h(1)),
+                       m.doppler ? z.range_rate - g.h(2) : 0.0};
+
+  // K = C S^-1; without Doppler the third column of S^-1 is zero, and so K's.
+  double K[4][3];
+  for (int i = 0; i < 4; ++i) {
+    for (int b = 0; b < 3; ++b) {
+      K[i][b] = g.C(i,0) * g.S_inv(0,b) + g.C(i,1) * g.S_inv(1,b) + g.C(i,2) * g.S_inv(2,b);
+    }
+    kf.x(i) += K[i][0] * y[0] + K[i][1] * y[1] + K[i][2] * y[2];
+  }
+  for (int i = 0; i < 4; ++i) {
+    for (int j = i; j < 4; ++j) {
+      kf.P(i,j) -= K[i][0] * g.C(j,0) + K[i][1] * g.C(j,1) + K[i][2] * g.C(j,2);
+    }
+  }
+  for (int i = 1; i < 4; ++i) for (int j = 0; j < i; ++j) kf.P(i,j) = kf.P(j,i);
+
+  if (out_innovation) *out_innovation = Vec2(y[0], y[1]);
+}
+
+void polar_init(KalmanCV2D& kf, const PolarMeas& z, const PolarModel& m, double vel_sigma) {
+  const Vec2 u(std::cos(z.azimuth), std::sin(z.azimuth));
+  const Vec2 n(-u(1), u(0));
+  const double var_r = m.sigma_r * m.sigma_r;
+  const double var_c = z.range * z.range * m.sigma_az * m.sigma_az;
+  const double var_rr = m.doppler ? m.sigma_rr * m.sigma_rr : vel_sigma * vel_sigma;
+  const double var_vc = vel_sigma * vel_sigma;
+  const Vec2 p = polar_to_cart(z, m.sensor);
+  const Vec2 v = m.doppler ? Vec2(z.range_rate * u) : Vec2::Zero();
+  kf.x << p(0), p(1), v(0), v(1);
+  kf.P.setZero();
+  for (int i = 0; i < 2; ++i) {
+    for (int j = 0; j < 2; ++j) {
+      kf.P(i,j) = var_r * u(i) * u(j) + var_c * n(i) * n(j);
+      kf.P(2 + i, 2 + j) = var_rr * u(i) * u(j) + var_vc * n(i) * n(j);
+    }
+  }
+}
+
+Vec2 polar_to_cart(const PolarMeas& z, const Vec2& sensor) {
+  return sensor + z.range * Vec2(std::cos(z.azimuth), std::sin(z.azimuth));
+}
+
+PolarMeas cart_to_polar(const Vec2& pos, const Vec2& vel, const Vec2& sensor) {
+  Vec4 x;
+  x << pos(0), pos(1), vel(0), vel(1);
+  const Vec3 h = measure(x, sensor);
+  PolarMeas z;
+  z.range = h(0);
+  z.azimuth = h(1);
+  z.range_rate = h(2);
+  return z;
+}
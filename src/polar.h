@@ -0,0 +1,58 @@
+#pragma once
+#include "kalman.h"
+
+// Nonlinear update of KalmanCV2D from polar radar detections (PolarMeas):
+//   h(x) = [ |p - s|,  atan2(p_y - s_y, p_x - s_x),  (p - s) . v / |p - s| ]
+// for a sensor at s, with R = diag(sigma_r^2, sigma_az^2, sigma_rr^2).
+//
+// Per track and scan, polar_predict() computes the predicted detection h,
+// S = H P H^T + R and the cross covariance C = P H^T once: EKF with the
+// analytic Jacobian H, or UKF from 9 sigma points (alpha 1, beta 2,
+// kappa 0). Gating then runs in measurement space and tests range rate on
+// its own first, a subtraction and a compare against the gate ellipsoid's
+// range-rate extent, so clutter at the wrong Doppler never reaches the full
+// test and nothing the full test would pass is lost. The update is
+//   x += K y,  P -= K C^T,  K = C S^-1,
+// with the azimuth residual wrapped to (-pi, pi]. Fixed-size, no allocation.
+enum class PolarFilter {
+  Ekf,
+  Ukf,
+};
+
+struct PolarModel {
+  Vec2 sensor = Vec2::Zero();
+  double sigma_r = 3.0;      // m
+  double sigma_az = 0.01;    // rad
+  double sigma_rr = 0.5;     // m/s
+  PolarFilter filter = PolarFilter::Ekf;
+  // Range rate as a gate and update dimension; off = range / azimuth only.
+  bool doppler = true;
+  double gate = 11.34; // chi-square gate: 3 dof at 99% (use 9.21 without Doppler)
+};
+
+// Per-track prediction of one scan.
+struct PolarGate {
+  Vec3 h = Vec3::Zero();
+  Mat3 S = Mat3::Zero();
+  Mat3 S_inv = Mat3::Zero(); // inverse of the used block (2x2 without Doppler), zero elsewhere
+  Mat4x3 C = Mat4x3::Zero();
+  double rr_half = 0.0;      // range-rate pre-gate: sqrt(gate * S_rr)
+};
+
+// Also returns a Cartesian box around the predicted position that holds
+// the whole gate, for the measurement grid.
+void polar_predict(const KalmanCV2D& kf, const PolarModel& m, PolarGate& g, Vec2& center, Vec2& half);
+// Squared Mahalanobis distance of z, or false when it fails the range-rate pre-gate.
+bool polar_maha2(const PolarGate& g, const PolarMeas& z, const PolarModel& m, double& m2);
+// innovation, if given, gets the range and azimuth residuals.
+void polar_update(KalmanCV2D& kf, const PolarGate& g, const PolarMeas& z, const PolarModel& m,
+                  Vec2* out_innovation = nullptr);
+
+// New track from one detection: position from z with its polar covariance
+// (sigma_r along the line of sight, range * sigma_az across it). With
+// Doppler the radial velocity starts at the range rate with sigma_rr, so
+// only the cross-range velocity starts at 0 with vel_sigma.
+void polar_init(KalmanCV2D& kf, const PolarMeas& z, const PolarModel& m, double vel_sigma);
+
+Vec2 polar_to_cart(const PolarMeas& z, const Vec2& sensor);
+PolarMeas cart_to_polar(const Vec2& pos, const Vec2& vel, const Vec2& sensor);
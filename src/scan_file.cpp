@@ -0,0 +1,176 @@
+#include "scan_file.h"
+#include <cstring>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const char kScanMagic[8] = {'R', 'T', 'S', 'C', 'A', 'N', '1', '\0'};
+
+// ---------------- writer ----------------
+
+ScanWriter::ScanWriter(const std::string& path, double dt, bool with_ids)
+  : out_(path, std::ios::binary) {
+  std::memcpy(hdr_.magic, kScanMagic, 8);
+  hdr_.version = 1;
+  hdr_.has_ids = with_ids ? 1u : 0u;
+  hdr_.dt = dt;
+  write(&hdr_, sizeof(hdr_)); // rewritten by finish()
+}
+
+ScanWriter::~ScanWriter() { finish(); }
+
+void ScanWriter::write(const void* p, size_t n) {
+  out_.write(static_cast<const char*>(p), (std::streamsize)n);
+  pos_ += n;
+}
+
+void ScanWriter::pad16() {
+  static const char zeros[16] = {};
+  if (pos_ % 16) write(zeros, (size_t)(16 - pos_ % 16));
+}
+
+void ScanWriter::append(MeasSpan z, const int32_t* ids, double t) {
+  ScanIndexEntry e{};
+  e.offset = pos_;
+  e.count = z.size();
+  e.t = t;
+  index_.push_back(e);
+
+  for (const auto& m : z) {
+    const double xy[2] = {m.x(), m.y()};
+    write(xy, sizeof(xy));
+  }
+  if (hdr_.has_ids) {
+    if (ids) {
+      write(ids, z.size() * sizeof(int32_t));
+    } else {
+      const int32_t zero = 0;
+      for (size_t i = 0; i < z.size(); ++i) write(&zero, sizeof(zero));
+    }
+  }
+  pad16();
+  hdr_.total_meas += z.size();
+}
+
+void ScanWriter::finish() {
+  if (finished_) return;
+  finished_ = true;
+  hdr_.num_scans = index_.size();
+  hdr_.index_offset = pos_;
+  if (!index_.empty()) write(index_.data(), index_.size() * sizeof(ScanIndexEntry));
+  out_.seekp(0);
+  out_.write(reinterpret_cast<const char*>(&hdr_), sizeof(hdr_));
+  out_.close();
+}
+
+// ---------------- reader ----------------
+
+ScanFile::~ScanFile() { close(); }
+
+bool ScanFile::open(const std::string& path) {
+  close();
+
+#ifdef _WIN32
+  HANDLE f = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                         FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (f == INVALID_HANDLE_VALUE) return false;
+  LARGE_INTEGER sz;
+  if (!GetFileSizeEx(f, &sz) || sz.QuadPart < (LONGLONG)sizeof(ScanFileHeader)) {
+    CloseHandle(f);
+    return false;
+  }
+  HANDLE m = CreateFileMappingA(f, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (!m) {
+    CloseHandle(f);
+    return false;
+  }
+  void* p = MapViewOfFile(m, FILE_MAP_READ, 0, 0, 0);
+  if (!p) {
+    CloseHandle(m);
+    CloseHandle(f);
+    return false;
+  }
+  file_ = f;
+  mapping_ = m;
+  base_ = static_cast<const uint8_t*>(p);
+  size_ = (uint64_t)sz.QuadPart;
+#else
+  const int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) return false;
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(ScanFileHeader)) {
+    ::close(fd);
+    return false;
+  }
+  void* p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (p == MAP_FAILED) {
+    ::close(fd);
+    return false;
+  }
+  madvise(p, (size_t)st.st_size, MADV_SEQUENTIAL);
+  fd_ = fd;
+  base_ = static_cast<const uint8_t*>(p);
+  size_ = (uint64_t)st.st_size;
+#endif
+
+  // The index is read in place, so it must be aligned and must fit in the
+  // file; num_scans is checked by division, as the product can overflow.
+  hdr_ = reinterpret_cast<const ScanFileHeader*>(base_);
+  if (std::memcmp(hdr_->magic, kScanMagic, 8) != 0 || hdr_->version != 1 ||
+      hdr_->index_offset > size_ || hdr_->index_offset % alignof(ScanIndexEntry) != 0 ||
+      hdr_->num_scans > (size_ - hdr_->index_offset) / sizeof(ScanIndexEntry)) {
+    close();
+    return false;
+  }
+  index_ = reinterpret_cast<const ScanIndexEntry*>(base_ + hdr_->index_offset);
+
+  const uint64_t row_bytes = sizeof(Vec2) + (hdr_->has_ids ? sizeof(int32_t) : 0);
+  for (uint64_t i = 0; i < hdr_->num_scans; ++i) {
+    const ScanIndexEntry& e = index_[i];
+    if (e.offset % 16 != 0 || e.offset > hdr_->index_offset ||
+        e.count > (hdr_->index_offset - e.offset) / row_bytes) {
+      close();
+      return false;
+    }
+  }
+  num_scans_ = (size_t)hdr_->num_scans;
+  return true;
+}
+
+void ScanFile::close() {
+  if (!base_) return;
+#ifdef _WIN32
+  UnmapViewOfFile(base_);
+  CloseHandle((HANDLE)mapping_);
+  CloseHandle((HANDLE)file_);
+  mapping_ = file_ = nullptr;
+#else
+  munmap(const_cast<uint8_t*>(base_), (size_t)size_);
+  ::close(fd_);
+  fd_ = -1;
+#endif
+  base_ = nullptr;
+  size_ = 0;
+  hdr_ = nullptr;
+  index_ = nullptr;
+  num_scans_ = 0;
+}
+
+ScanView ScanFile::scan(size_t i) const {
+  const ScanIndexEntry& e = index_[i];
+  ScanView v;
+  const Vec2* z = reinterpret_cast<const Vec2*>(base_ + e.offset);
+  v.z = MeasSpan(z, (size_t)e.count);
+  if (hdr_->has_ids) v.ids = reinterpret_cast<const int32_t*>(base_ + e.offset + e.count * sizeof(Vec2));
+  v.t = e.t;
+  return v;
+}
@@ -0,0 +1,105 @@
+#pragma once
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "math_types.h"
+
+// Recorded-scan file: a sequence of measurement scans for replay.
+//
+// Layout (little-endian, every section 16-byte aligned):
+//   header  64 bytes, see ScanFileHeader
+//   scans   per scan: n x {f64 x, f64 y}, then n x i32 true_id (if has_ids),
+//           zero-padded to 16 bytes
+//   index   num_scans x ScanIndexEntry, at header.index_offset
+//
+// Measurement arrays are laid out exactly like Vec2, so the reader maps the
+// file and hands out MeasSpan views into it without copying.
+struct ScanFileHeader {
+  char magic[8];          // "RTSCAN1\0"
+  uint32_t version;       // 1
+  uint32_t has_ids;       // 1 = per-measurement true ids are stored
+  uint64_t num_scans;
+  uint64_t index_offset;
+  uint64_t total_meas;
+  double dt;
+  uint64_t reserved[2];
+};
+static_assert(sizeof(ScanFileHeader) == 64, "ScanFileHeader layout");
+
+struct ScanIndexEntry {
+  uint64_t offset;        // byte offset of the scan's measurement array
+  uint64_t count;
+  double t;               // scan time [s]
+  uint64_t reserved;
+};
+static_assert(sizeof(ScanIndexEntry) == 32, "ScanIndexEntry layout");
+static_assert(sizeof(Vec2) == 16, "Vec2 must be two packed doubles");
+
+struct ScanView {
+  MeasSpan z;
+  const int32_t* ids = nullptr; // null when the file has no ids
+  double t = 0.0;
+};
+
+// Appends scans to a new recording; finish() (or the destructor) writes the index.
+class ScanWriter {
+public:
+  ScanWriter(const std::string& path, double dt, bool with_ids);
+  ~ScanWriter();
+
+  ScanWriter(const ScanWriter&) = delete;
+  ScanWriter& operator=(const ScanWriter&) = delete;
+
+  bool ok() const { return (bool)out_; }
+
+  // ids may be null when the writer was created without ids.
+  void append(MeasSpan z, const int32_t* ids, double t);
+  void finish();
+
+private:
+  std::ofstream out_;
+  ScanFileHeader hdr_{};
+  std::vector<ScanIndexEntry> index_;
+  uint64_t pos_ = 0;
+  bool finished_ = false;
+
+  void write(const void* p, size_t n);
+  void pad16();
+};
+
+// Read-only memory mapping of a recording (mmap on POSIX, MapViewOfFile on Windows).
+class ScanFile {
+public:
+  ScanFile() = default;
+  ~ScanFile();
+
+  ScanFile(const ScanFile&) = delete;
+  ScanFile& operator=(const ScanFile&) = delete;
+
+  // Returns false if the file cannot be mapped or is not a valid recording.
+  bool open(const std::string& path);
+  void close();
+
+  size_t num_scans() const { return num_scans_; }
+  double dt() const { return hdr_ ? hdr_->dt : 0.0; }
+  uint64_t total_meas() const { return hdr_ ? hdr_->total_meas : 0; }
+  uint64_t size_bytes() const { return size_; }
+  bool has_ids() const { return hdr_ && hdr_->has_ids != 0; }
+
+  ScanView scan(size_t i) const;
+
+private:
+  const uint8_t* base_ = nullptr;
+  uint64_t size_ = 0;
+  const ScanFileHeader* hdr_ = nullptr;
+  const ScanIndexEntry* index_ = nullptr;
+  size_t num_scans_ = 0;
+
+#ifdef _WIN32
+  void* file_ = nullptr;
+  void* mapping_ = nullptr;
+#else
+  int fd_ = -1;
+#endif
+};
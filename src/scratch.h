@@ -0,0 +1,25 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+// Helpers for per-scan scratch vectors that live across scans. assign()/resize()
+// to a new maximum reallocate to exactly that size, so a slowly rising peak
+// reallocates again and again; these grow capacity geometrically instead, so a
+// warm tracker stops touching the allocator.
+template <typename T>
+void scratch_reserve(std::vector<T>& v, size_t n) {
+  if (n > v.capacity()) v.reserve(std::max(n, v.capacity() + v.capacity() / 2));
+}
+
+template <typename T>
+void scratch_assign(std::vector<T>& v, size_t n, const typename std::vector<T>::value_type& value) {
+  scratch_reserve(v, n);
+  v.assign(n, value);
+}
+
+template <typename T>
+void scratch_resize(std::vector<T>& v, size_t n) {
+  scratch_reserve(v, n);
+  v.resize(n);
+}
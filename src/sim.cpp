@@ -1,12 +1,27 @@
 #include "sim.h"
+#include "polar.h"
+#include "checkpoint.h"
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+// CounterRng stream ids outside the range of target ids.
+static constexpr uint64_t kBirthStream = 1ull << 62;
+static constexpr uint64_t kClutterStream = 1ull << 63; // + tile index
+static constexpr double kPi = 3.14159265358979323846;
 
 TargetSim2D::TargetSim2D(uint64_t seed, const SimConfig& cfg)
-  : cfg_(cfg), rng_(seed) {
+  : cfg_(cfg), rng_(seed), seed_(seed) {
   step_idx_ = 0;
   truth_.clear();
   last_meas_.clear();
 
-  if (cfg_.scenario_cross) init_cross();
+  next_scan_.clear();
+  for (const SensorSpec& sp : cfg_.sensors) next_scan_.push_back(sp.offset);
+
+  if (cfg_.scenario_massive) init_massive();
+  else if (cfg_.scenario_cross) init_cross();
+  else if (cfg_.scenario_maneuver) init_maneuver();
   else init_random();
 }
 
@@ -39,8 +54,41 @@ void TargetSim2D::init_cross() {
   truth_.push_back(b);
 }
 
+void TargetSim2D::init_maneuver() {
+  truth_.reserve(cfg_.num_targets);
+  for (int i = 0; i < cfg_.num_targets; ++i) {
+    TruthTarget t;
+    t.id = i + 1;
+    t.pos = Vec2(rng_.uniform(-120.0, 120.0), rng_.uniform(-120.0, 120.0));
+    const double heading = rng_.uniform(-kPi, kPi);
+    t.vel = cfg_.maneuver_speed * Vec2(std::cos(heading), std::sin(heading));
+    truth_.push_back(t);
+  }
+}
+
+// Exact coordinated-turn motion over one dt for turning targets, straight
+// otherwise.
+void TargetSim2D::step_maneuver() {
+  const double time = step_idx_ * cfg_.dt;
+  for (auto& t : truth_) {
+    const double phase = std::fmod(0.37 * t.id, 1.0);
+    const int leg = (int)std::floor(time / std::max(cfg_.maneuver_leg, 1e-9) + 4.0 * phase) % 4;
+    const double w = leg == 1 ? cfg_.maneuver_turn_rate : leg == 3 ? -cfg_.maneuver_turn_rate : 0.0;
+    if (w == 0.0) {
+      t.pos = t.pos + t.vel * cfg_.dt;
+      continue;
+    }
+    const double s = std::sin(w * cfg_.dt);
+    const double c = std::cos(w * cfg_.dt);
+    const Vec2 v = t.vel;
+    t.pos = t.pos + Vec2(s * v.x() - (1.0 - c) * v.y(), (1.0 - c) * v.x() + s * v.y()) / w;
+    t.vel = Vec2(c * v.x() - s * v.y(), s * v.x() + c * v.y());
+  }
+}
+
 void TargetSim2D::gen_measurements() {
   last_meas_.clear();
+  last_polar_.clear();
 
   // true detections
   for (const auto& t : truth_) {
@@ -48,6 +96,16 @@ void TargetSim2D::gen_measurements() {
 
     Measurement m;
     m.true_id = t.id;
+    if (cfg_.polar) {
+      PolarMeas p = cart_to_polar(t.pos, t.vel, cfg_.polar_sensor);
+      p.range += rng_.normal(0.0, cfg_.sigma_r);
+      p.azimuth += rng_.normal(0.0, cfg_.sigma_az);
+      p.range_rate += rng_.normal(0.0, cfg_.sigma_rr);
+      m.z = polar_to_cart(p, cfg_.polar_sensor);
+      last_polar_.push_back(p);
+      last_meas_.push_back(m);
+      continue;
+    }
     const double nx = rng_.normal(0.0, cfg_.sigma_z);
     const double ny = rng_.normal(0.0, cfg_.sigma_z);
     m.z = t.pos + Vec2(nx, ny);
@@ -62,15 +120,330 @@ void TargetSim2D::gen_measurements() {
       const double x = rng_.uniform(-cfg_.clutter_area_half, cfg_.clutter_area_half);
       const double y = rng_.uniform(-cfg_.clutter_area_half, cfg_.clutter_area_half);
       m.z = Vec2(x, y);
+      if (cfg_.polar) {
+        PolarMeas p = cart_to_polar(m.z, Vec2::Zero(), cfg_.polar_sensor);
+        p.range_rate = rng_.uniform(-cfg_.clutter_rr_max, cfg_.clutter_rr_max);
+        last_polar_.push_back(p);
+      }
       last_meas_.push_back(m);
     }
   }
 }
 
 void TargetSim2D::step() {
+  if (cfg_.scenario_massive) {
+    step_massive();
+    step_idx_++;
+    return;
+  }
+
+  if (cfg_.scenario_maneuver) {
+    step_maneuver();
+  } else {
+    for (auto& t : truth_) {
+      t.pos = t.pos + t.vel * cfg_.dt;
+    }
+  }
+  if (cfg_.sensors.empty()) gen_measurements();
+  else step_sensors();
+  step_idx_++;
+}
+
+static void save_meas_list(StateWriter& w, const std::vector<Measurement>& v) {
+  w.pod((uint64_t)v.size());
+  for (const Measurement& m : v) {
+    w.pod(m.true_id);
+    w.mat(m.z);
+  }
+}
+
+static bool load_meas_list(StateReader& r, std::vector<Measurement>& v) {
+  uint64_t n = 0;
+  if (!r.count(n, sizeof(int) + sizeof(Vec2))) return false;
+  v.resize((size_t)n);
+  for (Measurement& m : v) {
+    r.pod(m.true_id);
+    r.mat(m.z);
+  }
+  return r.ok();
+}
+
+void TargetSim2D::save_state(StateWriter& w) const {
+  // mt19937_64 has no raw state accessor; its text form is the portable one.
+  std::ostringstream eng;
+  eng << rng_.eng;
+  w.str(eng.str());
+  w.pod(step_idx_);
+  w.pod(next_id_);
+
+  w.pod((uint64_t)truth_.size());
+  for (const TruthTarget& t : truth_) {
+    w.pod(t.id);
+    w.mat(t.pos);
+    w.mat(t.vel);
+  }
+
+  w.vec(next_scan_);
+  w.pod((uint64_t)in_flight_.size());
+  for (const SensorScan& sc : in_flight_) {
+    w.pod(sc.sensor);
+    w.pod(sc.t);
+    w.pod(sc.arrival);
+    save_meas_list(w, sc.meas);
+  }
+}
+
+bool TargetSim2D::load_state(StateReader& r) {
+  std::string eng_text;
+  int step_idx = 0;
+  int next_id = 0;
+  r.str(eng_text);
+  r.pod(step_idx);
+  r.pod(next_id);
+  std::istringstream eng_in(eng_text);
+  std::mt19937_64 eng;
+  if (!r.ok() || !(eng_in >> eng)) return false;
+
+  uint64_t n = 0;
+  if (!r.count(n, sizeof(int) + 2 * sizeof(Vec2))) return false;
+  std::vector<TruthTarget> truth((size_t)n);
+  for (TruthTarget& t : truth) {
+    r.pod(t.id);
+    r.mat(t.pos);
+    r.mat(t.vel);
+  }
+
+  std::vector<double> next_scan;
+  if (!r.vec(next_scan) || next_scan.size() != next_scan_.size()) return false;
+  if (!r.count(n, sizeof(int) + 2 * sizeof(double) + sizeof(uint64_t))) return false;
+  std::vector<SensorScan> in_flight((size_t)n);
+  for (SensorScan& sc : in_flight) {
+    r.pod(sc.sensor);
+    r.pod(sc.t);
+    r.pod(sc.arrival);
+    if (!load_meas_list(r, sc.meas)) return false;
+  }
+  if (!r.ok()) return false;
+
+  rng_.eng = eng;
+  step_idx_ = step_idx;
+  next_id_ = next_id;
+  truth_ = std::move(truth);
+  next_scan_ = std::move(next_scan);
+  in_flight_ = std::move(in_flight);
+  last_meas_.clear();
+  last_polar_.clear();
+  last_scans_.clear();
+  return true;
+}
+
+// Every sensor due by the end of this step scans the current truth; scans
+// then wait in in_flight_ until their arrival time passes.
+void TargetSim2D::step_sensors() {
+  const double now = (step_idx_ + 1) * cfg_.dt;
+  const double eps = 1e-9 * cfg_.dt;
+  last_meas_.clear();
+  last_scans_.clear();
+
+  for (size_t s = 0; s < cfg_.sensors.size(); ++s) {
+    const SensorSpec& sp = cfg_.sensors[s];
+    if (next_scan_[s] > now + eps) continue;
+    next_scan_[s] += std::max(sp.period, cfg_.dt);
+
+    SensorScan scan;
+    scan.sensor = (int)s;
+    scan.t = now;
+    scan.arrival = now + sp.latency + (rng_.uniform01() < sp.late_prob ? sp.late_delay : 0.0);
+    for (const auto& t : truth_) {
+      if (rng_.uniform01() > sp.p_detect) continue;
+      Measurement m;
+      m.true_id = t.id;
+      const double nx = rng_.normal(0.0, sp.sigma_z);
+      const double ny = rng_.normal(0.0, sp.sigma_z);
+      m.z = t.pos + Vec2(nx, ny);
+      scan.meas.push_back(m);
+    }
+    for (int i = 0; i < sp.clutter_per_scan; ++i) {
+      Measurement m;
+      m.z = Vec2(rng_.uniform(-cfg_.clutter_area_half, cfg_.clutter_area_half),
+                 rng_.uniform(-cfg_.clutter_area_half, cfg_.clutter_area_half));
+      scan.meas.push_back(m);
+    }
+    last_meas_.insert(last_meas_.end(), scan.meas.begin(), scan.meas.end());
+    in_flight_.push_back(std::move(scan));
+  }
+
+  // Release the arrived scans, oldest arrival first (then sensor).
+  size_t w = 0;
+  for (size_t i = 0; i < in_flight_.size(); ++i) {
+    if (in_flight_[i].arrival <= now + eps) last_scans_.push_back(std::move(in_flight_[i]));
+    else {
+      if (w != i) in_flight_[w] = std::move(in_flight_[i]);
+      ++w;
+    }
+  }
+  in_flight_.resize(w);
+  std::stable_sort(last_scans_.begin(), last_scans_.end(), [](const SensorScan& a, const SensorScan& b) {
+    return a.arrival != b.arrival ? a.arrival < b.arrival : a.sensor < b.sensor;
+  });
+}
+TruthTarget TargetSim2D::spawn_massive(int id, CounterRng& rng) const {
+  TruthTarget t;
+  t.id = id;
+  t.pos = Vec2(rng.uniform(-half_, half_), rng.uniform(-half_, half_));
+  t.vel = Vec2(rng.uniform(-8.0, 8.0), rng.uniform(-8.0, 8.0));
+  return t;
+}
+
+void TargetSim2D::init_massive() {
+  half_ = cfg_.area_half > 0.0 ? cfg_.area_half
+                               : 100.0 * std::sqrt((double)std::max(1, cfg_.num_targets));
+  cfg_.tile_size = std::max(cfg_.tile_size, 1.0);
+  tiles_x_ = std::max(1, (int)std::ceil(2.0 * half_ / cfg_.tile_size));
+  tile_clutter_.resize((size_t)tiles_x_ * (size_t)tiles_x_);
+  if (cfg_.sim_threads > 1) pool_ = std::make_unique<ThreadPool>(cfg_.sim_threads);
+
+  truth_.resize((size_t)std::max(0, cfg_.num_targets));
+  next_id_ = (int)truth_.size() + 1;
+  parallel_for((int)truth_.size(), 4096, [&](int begin, int end, int) {
+    for (int i = begin; i < end; ++i) {
+      CounterRng rng(seed_, (uint64_t)(i + 1), 0);
+      truth_[i] = spawn_massive(i + 1, rng);
+    }
+  });
+}
+
+// One scan of the load-test scene. Sub-stream 0 of every stream is used by
+// init, so scan k draws from sub-stream k + 1.
+void TargetSim2D::step_massive() {
+  const uint32_t sub = (uint32_t)step_idx_ + 1u;
+  const int n = (int)truth_.size();
+
+  alive_.resize((size_t)n);
+  detected_.resize((size_t)n);
+  det_z_.resize((size_t)n);
+
+  // Targets: move (reflecting at the area edge), die, detect. Each target
+  // draws from its own stream and writes only its own slots.
+  parallel_for(n, 4096, [&](int begin, int end, int) {
+    for (int i = begin; i < end; ++i) {
+      TruthTarget& t = truth_[i];
+      CounterRng rng(seed_, (uint64_t)t.id, sub);
+
+      alive_[i] = !(cfg_.death_prob > 0.0) || rng.uniform01() >= cfg_.death_prob;
+      t.pos = t.pos + t.vel * cfg_.dt;
+      for (int k = 0; k < 2; ++k) {
+        if (t.pos(k) > half_) { t.pos(k) = 2.0 * half_ - t.pos(k); t.vel(k) = -t.vel(k); }
+        if (t.pos(k) < -half_) { t.pos(k) = -2.0 * half_ - t.pos(k); t.vel(k) = -t.vel(k); }
+      }
+
+      const double u = rng.uniform01();
+      detected_[i] = alive_[i] && u <= cfg_.p_detect;
+      if (detected_[i]) {
+        const double nx = rng.normal(0.0, cfg_.sigma_z);
+        const double ny = rng.normal(0.0, cfg_.sigma_z);
+        det_z_[i] = t.pos + Vec2(nx, ny);
+      }
+    }
+  });
+
+  // Clutter: Poisson count per tile, uniform inside the tile (clipped to the area).
+  const int tiles = tiles_x_ * tiles_x_;
+  const double area = 4.0 * half_ * half_;
+  parallel_for(cfg_.enable_clutter ? tiles : 0, 1, [&](int begin, int end, int) {
+    for (int ti = begin; ti < end; ++ti) {
+      std::vector<Measurement>& out = tile_clutter_[ti];
+      out.clear();
+      const double x0 = -half_ + (ti % tiles_x_) * cfg_.tile_size;
+      const double y0 = -half_ + (ti / tiles_x_) * cfg_.tile_size;
+      const double x1 = std::min(x0 + cfg_.tile_size, half_);
+      const double y1 = std::min(y0 + cfg_.tile_size, half_);
+
+      CounterRng rng(seed_, kClutterStream + (uint64_t)ti, sub);
+      const double mean = cfg_.clutter_per_step * (x1 - x0) * (y1 - y0) / area;
+      const uint64_t count = rng.poisson(mean);
+      for (uint64_t c = 0; c < count; ++c) {
+        Measurement m;
+        m.true_id = 0;
+        m.z = Vec2(rng.uniform(x0, x1), rng.uniform(y0, y1));
+        out.push_back(m);
+      }
+    }
+  });
+
+  // Serial merge in target order, then tile order.
+  last_meas_.clear();
+  for (int i = 0; i < n; ++i) {
+    if (!detected_[i]) continue;
+    Measurement m;
+    m.true_id = truth_[i].id;
+    m.z = det_z_[i];
+    last_meas_.push_back(m);
+  }
+  if (cfg_.enable_clutter) {
+    for (const auto& tc : tile_clutter_) last_meas_.insert(last_meas_.end(), tc.begin(), tc.end());
+  }
+
+  // Deaths (order preserved), then births appended with fresh ids.
+  if (cfg_.death_prob > 0.0) {
+    size_t w = 0;
+    for (int i = 0; i < n; ++i) {
+      if (alive_[i]) truth_[w++] = truth_[i];
+    }
+    truth_.resize(w);
+  }
+
+  if (cfg_.birth_rate > 0.0) {
+    CounterRng rng(seed_, kBirthStream, sub);
+    const uint64_t births = rng.poisson(cfg_.birth_rate);
+    for (uint64_t b = 0; b < births; ++b) truth_.push_back(spawn_massive(next_id_++, rng));
+  }
+}
+
+TargetSim3D::TargetSim3D(uint64_t seed, const Sim3DConfig& cfg) : cfg_(cfg), rng_(seed) {
+  truth_.reserve((size_t)cfg_.num_targets);
+  for (int i = 0; i < cfg_.num_targets; ++i) {
+    TruthTarget3D t;
+    t.id = i + 1;
+    t.pos = Vec3(rng_.uniform(-120.0, 120.0), rng_.uniform(-120.0, 120.0), rng_.uniform(-120.0, 120.0));
+    t.vel = Vec3(rng_.uniform(-8.0, 8.0), rng_.uniform(-8.0, 8.0), rng_.uniform(-3.0, 3.0));
+    truth_.push_back(t);
+  }
+}
+
+void TargetSim3D::step() {
+  const double dt = cfg_.dt;
+  const double time = step_idx_ * dt;
   for (auto& t : truth_) {
-    t.pos = t.pos + t.vel * cfg_.dt;
+    Vec3 a = Vec3::Zero();
+    if (cfg_.maneuver_accel > 0.0) {
+      const double phase = std::fmod(0.37 * t.id, 1.0);
+      const int leg = (int)std::floor(time / std::max(cfg_.maneuver_leg, 1e-9) + 2.0 * phase);
+      if (leg % 2 == 1) {
+        // Golden-angle headings so legs and targets differ; climbs alternate.
+        const double th = 2.39996 * leg + 1.1 * t.id;
+        const double up = (leg / 2) % 2 ? -0.4 : 0.4;
+        a = cfg_.maneuver_accel * Vec3(std::cos(th), std::sin(th), up).normalized();
+      }
+    }
+    t.pos += t.vel * dt + 0.5 * dt * dt * a;
+    t.vel += a * dt;
+  }
+
+  last_meas_.clear();
+  for (const auto& t : truth_) {
+    if (rng_.uniform01() > cfg_.p_detect) continue;
+    Measurement3D m;
+    m.true_id = t.id;
+    m.z = t.pos + Vec3(rng_.normal(0.0, cfg_.sigma_z), rng_.normal(0.0, cfg_.sigma_z),
+                       rng_.normal(0.0, cfg_.sigma_z));
+    last_meas_.push_back(m);
+  }
+  const double h = cfg_.clutter_area_half;
+  for (int i = 0; i < cfg_.clutter_per_step; ++i) {
+    Measurement3D m;
+    m.z = Vec3(rng_.uniform(-h, h), rng_.uniform(-h, h), rng_.uniform(-h, h));
+    last_meas_.push_back(m);
   }
-  gen_measurements();
   step_idx_++;
-}
\ No newline at end of file
+}
@@ -1,8 +1,14 @@
 #pragma once
 #include <vector>
 #include <cstdint>
+#include <memory>
 #include "math_types.h"
 #include "rng.h"
+#include "counter_rng.h"
+#include "thread_pool.h"
+
+class StateWriter;
+class StateReader;
 
 struct TruthTarget {
   int id = 0;
@@ -15,6 +21,26 @@ struct Measurement {
   Vec2 z = Vec2::Zero();
 };
 
+// One sensor of the multi-sensor scene (SimConfig::sensors).
+struct SensorSpec {
+  double period = 0.1;       // seconds between scans, on the dt grid
+  double offset = 0.0;       // time of the first scan
+  double sigma_z = 3.0;
+  double p_detect = 0.9;
+  int clutter_per_scan = 6;  // uniform over +-clutter_area_half
+  double latency = 0.0;      // seconds from scan time to arrival
+  double late_prob = 0.0;    // probability a scan arrives late_delay later still
+  double late_delay = 0.0;
+};
+
+// A scan of one sensor: measurement time t, and when it reached the tracker.
+struct SensorScan {
+  int sensor = 0;
+  double t = 0.0;
+  double arrival = 0.0;
+  std::vector<Measurement> meas;
+};
+
 struct SimConfig {
   int num_targets = 3;
   double dt = 0.05;
@@ -29,6 +55,91 @@ struct SimConfig {
 
   // scenario selection
   bool scenario_cross = false;
+
+  // Maneuvering scene: num_targets at maneuver_speed, each cycling through
+  // straight, left-turn, straight, right-turn legs of maneuver_leg seconds
+  // (coordinated turns at maneuver_turn_rate), phases staggered per target.
+  bool scenario_maneuver = false;
+  double maneuver_speed = 30.0;     // m/s
+  double maneuver_turn_rate = 0.5;  // rad/s
+  double maneuver_leg = 3.0;        // seconds
+
+  // Polar radar (single-sensor scenes): detections are drawn as range,
+  // azimuth and range rate seen from polar_sensor with these noises instead
+  // of x / y with sigma_z. last_polar() holds them, last_measurements() their
+  // Cartesian conversions. Clutter stays uniform over the area, with range
+  // rate uniform in +-clutter_rr_max.
+  bool polar = false;
+  Vec2 polar_sensor = Vec2(0.0, -400.0);
+  double sigma_r = 3.0;         // m
+  double sigma_az = 0.01;       // rad
+  double sigma_rr = 0.5;        // m/s
+  double clutter_rr_max = 30.0; // m/s
+
+  // Multi-sensor mode: the scene's targets (random, cross or maneuver) seen
+  // by every sensor here instead of one scan per step. Scans taken up to the
+  // end of a step and arrived by then come out of last_scans() in arrival
+  // order; last_measurements() holds everything measured during the step.
+  std::vector<SensorSpec> sensors;
+
+  // Load-test scene: num_targets spread over +-area_half, Poisson clutter with
+  // mean clutter_per_step per scan over the same area, optional birth/death.
+  // Drawn from CounterRng streams (per target, per clutter tile), so the scene
+  // depends only on the seed, never on sim_threads.
+  bool scenario_massive = false;
+  double area_half = 0.0;    // meters, <= 0 = 100 * sqrt(num_targets)
+  double birth_rate = 0.0;   // expected new targets per scan
+  double death_prob = 0.0;   // per target per scan
+  double tile_size = 2000.0; // clutter generation tile edge, meters
+  int sim_threads = 1;
+};
+
+// Air-target scene for the 3D trackers (TrackerND): num_targets in a
+// +-120 m cube with horizontal speeds up to 8 m/s and climb rates up to
+// 3 m/s, position noise sigma_z on every axis, clutter uniform over a
+// +-clutter_area_half cube. With maneuver_accel > 0 every second leg of
+// maneuver_leg seconds is a constant acceleration of that magnitude in a
+// direction fixed per target and leg, phases staggered per target.
+struct Sim3DConfig {
+  int num_targets = 20;
+  double dt = 0.05;
+  int steps = 400;
+
+  double sigma_z = 3.0;
+  double p_detect = 0.90;
+  int clutter_per_step = 20;
+  double clutter_area_half = 300.0;
+
+  double maneuver_accel = 0.0; // m/s^2
+  double maneuver_leg = 3.0;   // seconds
+};
+
+struct TruthTarget3D {
+  int id = 0;
+  Vec3 pos = Vec3::Zero();
+  Vec3 vel = Vec3::Zero();
+};
+
+struct Measurement3D {
+  int true_id = 0;   // 0 = clutter / false alarm
+  Vec3 z = Vec3::Zero();
+};
+
+class TargetSim3D {
+public:
+  TargetSim3D(uint64_t seed, const Sim3DConfig& cfg);
+
+  void step();
+
+  const std::vector<TruthTarget3D>& truth() const { return truth_; }
+  const std::vector<Measurement3D>& last_measurements() const { return last_meas_; }
+
+private:
+  Sim3DConfig cfg_;
+  Rng rng_;
+  int step_idx_ = 0;
+  std::vector<TruthTarget3D> truth_;
+  std::vector<Measurement3D> last_meas_;
 };
 
 class TargetSim2D {
@@ -39,16 +150,57 @@ public:
 
   const std::vector<TruthTarget>& truth() const { return truth_; }
   const std::vector<Measurement>& last_measurements() const { return last_meas_; }
+  const std::vector<SensorScan>& last_scans() const { return last_scans_; }
+  // Polar mode: indexed like last_measurements().
+  const std::vector<PolarMeas>& last_polar() const { return last_polar_; }
+
+  // Checkpoint image (checkpoint.h) of the scene between steps: RNG engine,
+  // step index, truth, next target id and the sensors' pending scans. A sim
+  // built with the same seed and config and restored with load_state() draws
+  // the same steps from there on as the one saved. last_*() are per-step
+  // output and are not kept.
+  void save_state(StateWriter& w) const;
+  bool load_state(StateReader& r);
 
 private:
   SimConfig cfg_;
   Rng rng_;
+  uint64_t seed_ = 0;
   int step_idx_ = 0;
 
   std::vector<TruthTarget> truth_;
   std::vector<Measurement> last_meas_;
+  std::vector<PolarMeas> last_polar_;
+
+  // multi-sensor state
+  std::vector<double> next_scan_;      // per sensor
+  std::vector<SensorScan> in_flight_;  // taken, not yet arrived
+  std::vector<SensorScan> last_scans_;
+
+  // scenario_massive state
+  std::unique_ptr<ThreadPool> pool_;
+  int next_id_ = 1;
+  double half_ = 0.0;
+  int tiles_x_ = 0;
+  std::vector<char> alive_;                    // per target, this scan
+  std::vector<char> detected_;                 // per target, this scan
+  std::vector<Vec2> det_z_;                    // per target, valid if detected_
+  std::vector<std::vector<Measurement>> tile_clutter_; // per tile
 
   void init_random();
   void init_cross();
+  void init_maneuver();
+  void step_maneuver();
   void gen_measurements();
+  void step_sensors();
+
+  void init_massive();
+  void step_massive();
+  TruthTarget spawn_massive(int id, CounterRng& rng) const;
+
+  template <typename Fn>
+  void parallel_for(int n, int grain, Fn&& fn) {
+    if (pool_) pool_->parallel_for(n, grain, fn);
+    else if (n > 0) fn(0, n, 0);
+  }
 };
\ No newline at end of file
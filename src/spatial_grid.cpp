@@ -0,0 +1,89 @@
+#include "spatial_grid.h"
+#include "scratch.h"
+#include <algorithm>
+#include <cmath>
+
+void PointGrid::build(MeasSpan pts, double cell_size) {
+  const int n = (int)pts.size();
+  items_.clear();
+  cell_start_.clear();
+
+  if (n == 0) {
+    nx_ = ny_ = 0;
+    cell_start_.push_back(0);
+    return;
+  }
+
+  double xmin = pts[0].x(), xmax = xmin;
+  double ymin = pts[0].y(), ymax = ymin;
+  for (int i = 1; i < n; ++i) {
+    xmin = std::min(xmin, pts[i].x()); xmax = std::max(xmax, pts[i].x());
+    ymin = std::min(ymin, pts[i].y()); ymax = std::max(ymax, pts[i].y());
+  }
+  const double w = std::max(xmax - xmin, 1e-9);
+  const double h = std::max(ymax - ymin, 1e-9);
+
+  // Auto size: about one point per cell on average.
+  if (!(cell_size > 0.0)) cell_size = std::sqrt(w * h / (double)n);
+
+  // Keep the cell count bounded by the point count so build stays O(M).
+  const double max_cells = 4.0 * (double)n + 16.0;
+  while ((w / cell_size + 1.0) * (h / cell_size + 1.0) > max_cells) cell_size *= 2.0;
+
+  cell_ = cell_size;
+  inv_cell_ = 1.0 / cell_;
+  x0_ = xmin;
+  y0_ = ymin;
+  nx_ = (int)(w * inv_cell_) + 1;
+  ny_ = (int)(h * inv_cell_) + 1;
+
+  const int ncells = nx_ * ny_;
+  scratch_assign(cell_start_, (size_t)ncells + 1, 0);
+  scratch_resize(cell_of_, (size_t)n);
+
+  for (int i = 0; i < n; ++i) {
+    const int c = clamp_y(pts[i].y()) * nx_ + clamp_x(pts[i].x());
+    cell_of_[i] = c;
+    cell_start_[c + 1] += 1;
+  }
+  for (int c = 0; c < ncells; ++c) cell_start_[c + 1] += cell_start_[c];
+
+  // Stable scatter: indices stay ascending inside each cell.
+  scratch_resize(items_, (size_t)n);
+  scratch_reserve(cursor_, cell_start_.size());
+  cursor_.assign(cell_start_.begin(), cell_start_.end() - 1);
+  for (int i = 0; i < n; ++i) items_[cursor_[cell_of_[i]]++] = i;
+}
+
+int PointGrid::clamp_x(double x) const {
+  const double c = std::floor((x - x0_) * inv_cell_);
+  if (!(c > 0.0)) return 0;
+  if (c >= (double)(nx_ - 1)) return nx_ - 1;
+  return (int)c;
+}
+
+int PointGrid::clamp_y(double y) const {
+  const double c = std::floor((y - y0_) * inv_cell_);
+  if (!(c > 0.0)) return 0;
+  if (c >= (double)(ny_ - 1)) return ny_ - 1;
+  return (int)c;
+}
+
+void PointGrid::query(const Vec2& lo, const Vec2& hi, std::vector<int>& out) const {
+  if (nx_ == 0 || ny_ == 0) return;
+
+  // Reject boxes entirely outside the occupied extent.
+  if (hi.x() < x0_ || hi.y() < y0_) return;
+  if (lo.x() > x0_ + nx_ * cell_ || lo.y() > y0_ + ny_ * cell_) return;
+
+  const int cx0 = clamp_x(lo.x()), cx1 = clamp_x(hi.x());
+  const int cy0 = clamp_y(lo.y()), cy1 = clamp_y(hi.y());
+
+  for (int cy = cy0; cy <= cy1; ++cy) {
+    const int row = cy * nx_;
+    for (int cx = cx0; cx <= cx1; ++cx) {
+      const int c = row + cx;
+      for (int k = cell_start_[c]; k < cell_start_[c + 1]; ++k) out.push_back(items_[k]);
+    }
+  }
+}
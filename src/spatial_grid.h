@@ -0,0 +1,36 @@
+#pragma once
+#include <vector>
+#include "math_types.h"
+
+// Uniform grid index over a set of 2D points, rebuilt once per scan.
+// Points are bucketed by cell with a counting sort (CSR layout: cell_start_ / items_),
+// so build is O(M) and a box query only touches the cells it overlaps.
+class PointGrid {
+public:
+  // cell_size <= 0 picks a size from the point extent and count.
+  void build(MeasSpan pts, double cell_size);
+
+  // Appends indices of all points in cells overlapping the box [lo, hi].
+  // Result is a superset of the points inside the box, in cell order.
+  void query(const Vec2& lo, const Vec2& hi, std::vector<int>& out) const;
+
+  double cell_size() const { return cell_; }
+  int cells_x() const { return nx_; }
+  int cells_y() const { return ny_; }
+
+private:
+  double cell_ = 1.0;
+  double inv_cell_ = 1.0;
+  double x0_ = 0.0;
+  double y0_ = 0.0;
+  int nx_ = 0;
+  int ny_ = 0;
+
+  std::vector<int> cell_start_; // size nx*ny + 1
+  std::vector<int> items_;      // point indices grouped by cell, ascending within a cell
+  std::vector<int> cell_of_;    // per-point cell index (build scratch)
+  std::vector<int> cursor_;     // scatter cursors (build scratch)
+
+  int clamp_x(double x) const;
+  int clamp_y(double y) const;
+};
@@ -0,0 +1,42 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Bounded lock-free single-producer / single-consumer ring.
+// Capacity is rounded up to a power of two. head_ is written only by the
+// consumer and tail_ only by the producer; they sit on separate cache lines.
+template <typename T>
+class SpscRing {
+public:
+  explicit SpscRing(size_t capacity) {
+    size_t n = 2;
+    while (n < capacity) n <<= 1;
+    buf_.resize(n);
+    mask_ = n - 1;
+  }
+
+  size_t capacity() const { return buf_.size(); }
+
+  bool try_push(const T& v) {
+    const size_t t = tail_.load(std::memory_order_relaxed);
+    if (t - head_.load(std::memory_order_acquire) == buf_.size()) return false;
+    buf_[t & mask_] = v;
+    tail_.store(t + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool try_pop(T& out) {
+    const size_t h = head_.load(std::memory_order_relaxed);
+    if (h == tail_.load(std::memory_order_acquire)) return false;
+    out = buf_[h & mask_];
+    head_.store(h + 1, std::memory_order_release);
+    return true;
+  }
+
+private:
+  std::vector<T> buf_;
+  size_t mask_ = 0;
+  alignas(64) std::atomic<size_t> head_{0};
+  alignas(64) std::atomic<size_t> tail_{0};
+};
@@ -0,0 +1,103 @@
+#include "thread_pool.h"
+#include <algorithm>
+
+ThreadPool::ThreadPool(int num_threads) {
+  const int n = std::max(1, num_threads);
+  for (int i = 0; i < n; ++i) queues_.push_back(std::make_unique<Queue>());
+  for (int i = 1; i < n; ++i) threads_.emplace_back([this, i] { worker_loop(i); });
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lk(wake_m_);
+    stop_ = true;
+  }
+  wake_cv_.notify_all();
+  for (auto& t : threads_) t.join();
+}
+
+void ThreadPool::run(int n, int grain, ChunkFn fn, void* ctx) {
+  if (n <= 0) return;
+  if (grain < 1) grain = 1;
+
+  const int chunks = num_chunks(n, grain);
+  if (queues_.size() == 1 || chunks == 1) {
+    for (int c = 0; c < chunks; ++c) fn(ctx, c * grain, std::min(n, (c + 1) * grain), 0);
+    return;
+  }
+
+  // Publish the job before any chunk becomes visible: a worker still draining
+  // from the previous wake-up may pick a chunk up as soon as it is queued.
+  fn_ = fn;
+  ctx_ = ctx;
+  remaining_.store(chunks, std::memory_order_release);
+
+  const int W = size();
+  for (int w = 0; w < W; ++w) {
+    std::lock_guard<std::mutex> lk(queues_[w]->m);
+    queues_[w]->chunks.clear();
+    queues_[w]->head = 0;
+  }
+  for (int c = 0; c < chunks; ++c) {
+    Queue& q = *queues_[c % W];
+    std::lock_guard<std::mutex> lk(q.m);
+    q.chunks.push_back({c * grain, std::min(n, (c + 1) * grain)});
+  }
+
+  {
+    std::lock_guard<std::mutex> lk(wake_m_);
+    generation_++;
+  }
+  wake_cv_.notify_all();
+
+  while (remaining_.load(std::memory_order_acquire) > 0) {
+    if (!run_one(0)) std::this_thread::yield();
+  }
+}
+
+bool ThreadPool::run_one(int worker) {
+  const int W = size();
+  Chunk task{0, 0};
+  bool found = false;
+
+  {
+    // Own queue: newest chunk first.
+    Queue& q = *queues_[worker];
+    std::lock_guard<std::mutex> lk(q.m);
+    if (q.chunks.size() > q.head) {
+      task = q.chunks.back();
+      q.chunks.pop_back();
+      found = true;
+    }
+  }
+
+  for (int k = 1; !found && k < W; ++k) {
+    // Steal the oldest chunk of another worker.
+    Queue& q = *queues_[(worker + k) % W];
+    std::lock_guard<std::mutex> lk(q.m);
+    if (q.chunks.size() > q.head) {
+      task = q.chunks[q.head++];
+      found = true;
+    }
+  }
+
+  if (!found) return false;
+  fn_(ctx_, task.begin, task.end, worker);
+  remaining_.fetch_sub(1, std::memory_order_acq_rel);
+  return true;
+}
+
+void ThreadPool::worker_loop(int worker) {
+  uint64_t seen = 0;
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lk(wake_m_);
+      wake_cv_.wait(lk, [&] { return stop_ || generation_ != seen; });
+      if (stop_) return;
+      seen = generation_;
+    }
+    while (remaining_.load(std::memory_order_acquire) > 0) {
+      if (!run_one(worker)) break;
+    }
+  }
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Fixed-size worker pool with per-worker task queues and work stealing.
+//
+// parallel_for(n, grain, fn) cuts [0, n) into chunks of `grain` items and
+// deals them round-robin onto the worker queues. Each worker pops its own
+// queue from the back and steals from the front of the others; the calling
+// thread acts as worker 0 and returns once every chunk has run.
+// fn(begin, end, worker) gets the worker index for per-thread scratch.
+//
+// Chunk boundaries depend only on (n, grain), never on timing, so callers
+// that write per-chunk or per-item results get identical output for any
+// thread count.
+class ThreadPool {
+public:
+  // num_threads counts the calling thread; 1 means run everything inline.
+  explicit ThreadPool(int num_threads);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  int size() const { return (int)queues_.size(); }
+
+  // Number of chunks parallel_for(n, grain, ...) will create.
+  static int num_chunks(int n, int grain) {
+    if (grain < 1) grain = 1;
+    return (n + grain - 1) / grain;
+  }
+
+  template <typename Fn>
+  void parallel_for(int n, int grain, Fn&& fn) {
+    using F = std::remove_reference_t<Fn>;
+    run(n, grain, &invoke<F>, (void*)&fn);
+  }
+
+private:
+  using ChunkFn = void (*)(void* ctx, int begin, int end, int worker);
+
+  template <typename F>
+  static void invoke(void* ctx, int begin, int end, int worker) {
+    (*static_cast<F*>(ctx))(begin, end, worker);
+  }
+
+  struct Chunk {
+    int begin;
+    int end;
+  };
+
+  struct Queue {
+    std::mutex m;
+    std::vector<Chunk> chunks; // [head, size) pending
+    size_t head = 0;
+  };
+
+  std::vector<std::unique_ptr<Queue>> queues_;
+  std::vector<std::thread> threads_;
+
+  std::mutex wake_m_;
+  std::condition_variable wake_cv_;
+  uint64_t generation_ = 0;
+  bool stop_ = false;
+
+  ChunkFn fn_ = nullptr;
+  void* ctx_ = nullptr;
+  std::atomic<int> remaining_{0};
+
+  void run(int n, int grain, ChunkFn fn, void* ctx);
+  bool run_one(int worker);
+  void worker_loop(int worker);
+};
@@ -0,0 +1,146 @@
+#include "track_bank.h"
+#include "checkpoint.h"
+#include <cmath>
+
+void TrackBank::resize(size_t n) {
+  for (auto* v : {&x, &y, &vx, &vy, &p00, &p01, &p02, &p03, &p11, &p12, &p13, &p22, &p23, &p33}) {
+    v->resize(n);
+  }
+}
+
+void TrackBank::load(size_t i, const KalmanCV2D& kf) {
+  x[i] = kf.x(0); y[i] = kf.x(1); vx[i] = kf.x(2); vy[i] = kf.x(3);
+  const Mat4& P = kf.P;
+  p00[i] = P(0,0); p01[i] = P(0,1); p02[i] = P(0,2); p03[i] = P(0,3);
+  p11[i] = P(1,1); p12[i] = P(1,2); p13[i] = P(1,3);
+  p22[i] = P(2,2); p23[i] = P(2,3);
+  p33[i] = P(3,3);
+}
+
+void TrackBank::store(size_t i, KalmanCV2D& kf) const {
+  kf.x(0) = x[i]; kf.x(1) = y[i]; kf.x(2) = vx[i]; kf.x(3) = vy[i];
+  Mat4& P = kf.P;
+  P(0,0) = p00[i]; P(0,1) = P(1,0) = p01[i]; P(0,2) = P(2,0) = p02[i]; P(0,3) = P(3,0) = p03[i];
+  P(1,1) = p11[i]; P(1,2) = P(2,1) = p12[i]; P(1,3) = P(3,1) = p13[i];
+  P(2,2) = p22[i]; P(2,3) = P(3,2) = p23[i];
+  P(3,3) = p33[i];
+}
+
+void TrackBank::save_state(StateWriter& w) const {
+  for (const auto* v : {&x, &y, &vx, &vy, &p00, &p01, &p02, &p03, &p11, &p12, &p13, &p22, &p23, &p33}) {
+    w.vec(*v);
+  }
+}
+
+bool TrackBank::load_state(StateReader& r) {
+  for (auto* v : {&x, &y, &vx, &vy, &p00, &p01, &p02, &p03, &p11, &p12, &p13, &p22, &p23, &p33}) {
+    if (!r.vec(*v) || v->size() != x.size()) return false;
+  }
+  return true;
+}
+
+void predict_cv_batch(TrackBank& b, double dt, double sigma_a) {
+  predict_cv_batch(b, 0, b.size(), dt, sigma_a);
+}
+
+void predict_cv_batch(TrackBank& b, size_t begin, size_t end, double dt, double sigma_a) {
+  const double dt2 = dt * dt;
+  const double dt3 = dt2 * dt;
+  const double dt4 = dt2 * dt2;
+  const double q = sigma_a * sigma_a;
+  const double q_pp = dt4/4.0 * q; // position-position
+  const double q_pv = dt3/2.0 * q; // position-velocity
+  const double q_vv = dt2 * q;     // velocity-velocity
+
+  double* x = b.x.data();
+  double* y = b.y.data();
+  const double* vx = b.vx.data();
+  const double* vy = b.vy.data();
+  for (size_t i = begin; i < end; ++i) {
+    x[i] = x[i] + dt * vx[i];
+    y[i] = y[i] + dt * vy[i];
+  }
+
+  double* p00 = b.p00.data();
+  double* p01 = b.p01.data();
+  double* p02 = b.p02.data();
+  double* p03 = b.p03.data();
+  double* p11 = b.p11.data();
+  double* p12 = b.p12.data();
+  double* p13 = b.p13.data();
+  const double* p22 = b.p22.data();
+  const double* p23 = b.p23.data();
+  const double* p33 = b.p33.data();
+
+  // Rows of F*P: fp0j = P0j + dt*P2j, fp1j = P1j + dt*P3j; rows 2,3 unchanged.
+  // Then (F*P)*F^T adds dt * column 2/3 into columns 0/1.
+  for (size_t i = begin; i < end; ++i) {
+    const double fp00 = p00[i] + dt * p02[i];
+    const double fp01 = p01[i] + dt * p12[i];
+    const double fp02 = p02[i] + dt * p22[i];
+    const double fp03 = p03[i] + dt * p23[i];
+    const double fp11 = p11[i] + dt * p13[i];
+    const double fp12 = p12[i] + dt * p23[i];
+    const double fp13 = p13[i] + dt * p33[i];
+
+    p00[i] = (fp00 + dt * fp02) + q_pp;
+    p01[i] = fp01 + dt * fp03;
+    p02[i] = fp02 + q_pv;
+    p03[i] = fp03;
+    p11[i] = (fp11 + dt * fp13) + q_pp;
+    p12[i] = fp12;
+    p13[i] = fp13 + q_pv;
+  }
+
+  double* p22w = b.p22.data();
+  double* p33w = b.p33.data();
+  for (size_t i = begin; i < end; ++i) {
+    p22w[i] = p22w[i] + q_vv;
+    p33w[i] = p33w[i] + q_vv;
+  }
+}
+
+void predict_ct_batch(TrackBank& b, size_t begin, size_t end, double dt, double sigma_a, double omega) {
+  const double s = std::sin(omega * dt);
+  const double c = std::cos(omega * dt);
+  // d(pos)/d(vel) along and across the velocity; CV limit for tiny turns.
+  const bool straight = std::abs(omega * dt) < 1e-9;
+  const double a = straight ? dt : s / omega;
+  const double d = straight ? 0.0 : (1.0 - c) / omega;
+
+  const double dt2 = dt * dt;
+  const double q = sigma_a * sigma_a;
+  const double q_pp = dt2 * dt2 / 4.0 * q;
+  const double q_pv = dt2 * dt / 2.0 * q;
+  const double q_vv = dt2 * q;
+
+  // F = [1 0 a -d; 0 1 d a; 0 0 c -s; 0 0 s c]
+  const double F[4][4] = {{1.0, 0.0, a, -d}, {0.0, 1.0, d, a}, {0.0, 0.0, c, -s}, {0.0, 0.0, s, c}};
+  for (size_t i = begin; i < end; ++i) {
+    const double vx = b.vx[i], vy = b.vy[i];
+    b.x[i] = b.x[i] + a * vx - d * vy;
+    b.y[i] = b.y[i] + d * vx + a * vy;
+    b.vx[i] = c * vx - s * vy;
+    b.vy[i] = s * vx + c * vy;
+
+    const double P[4][4] = {
+      {b.p00[i], b.p01[i], b.p02[i], b.p03[i]},
+      {b.p01[i], b.p11[i], b.p12[i], b.p13[i]},
+      {b.p02[i], b.p12[i], b.p22[i], b.p23[i]},
+      {b.p03[i], b.p13[i], b.p23[i], b.p33[i]},
+    };
+    double FP[4][4];
+    for (int r = 0; r < 4; ++r) {
+      for (int k = 0; k < 4; ++k) {
+        FP[r][k] = F[r][0] * P[0][k] + F[r][1] * P[1][k] + F[r][2] * P[2][k] + F[r][3] * P[3][k];
+      }
+    }
+    auto fpf = [&](int r, int k) {
+      return FP[r][0] * F[k][0] + FP[r][1] * F[k][1] + FP[r][2] * F[k][2] + FP[r][3] * F[k][3];
+    };
+    b.p00[i] = fpf(0, 0) + q_pp; b.p01[i] = fpf(0, 1);        b.p02[i] = fpf(0, 2) + q_pv; b.p03[i] = fpf(0, 3);
+    b.p11[i] = fpf(1, 1) + q_pp; b.p12[i] = fpf(1, 2);        b.p13[i] = fpf(1, 3) + q_pv;
+    b.p22[i] = fpf(2, 2) + q_vv; b.p23[i] = fpf(2, 3);
+    b.p33[i] = fpf(3, 3) + q_vv;
+  }
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+#include "kalman.h"
+
+class StateWriter;
+class StateReader;
+
+// Structure-of-arrays store of CV track states for batched kernels.
+// Each state component and each of the 10 unique covariance terms (upper
+// triangle of the symmetric 4x4 P) lives in its own contiguous array.
+// ImmBank keeps its models here; MultiTargetTracker's CV tracks predict in
+// place with the same closed form (KalmanCV2D::predict).
+struct TrackBank {
+  std::vector<double> x, y, vx, vy;
+  std::vector<double> p00, p01, p02, p03;
+  std::vector<double> p11, p12, p13;
+  std::vector<double> p22, p23;
+  std::vector<double> p33;
+
+  size_t size() const { return x.size(); }
+  void resize(size_t n);
+
+  // Copy state in/out of the AoS filter. load() reads the upper triangle of P;
+  // store() writes P back exactly symmetric.
+  void load(size_t i, const KalmanCV2D& kf);
+  void store(size_t i, KalmanCV2D& kf) const;
+
+  // Checkpoint image of the 14 columns (checkpoint.h). load_state() fails on
+  // columns of unequal length.
+  void save_state(StateWriter& w) const;
+  bool load_state(StateReader& r);
+};
+
+// Closed-form CV predict of every track in the bank (shared dt, sigma_a):
+// x <- F x, P <- F P F^T + Q. Plain loops over the column arrays so the
+// compiler can vectorize them.
+//
+// Terms are formed in the same order as the generic F*P*F^T product, so for a
+// symmetric P the result is bit-identical to KalmanCV2D::predict(). The only
+// difference from the AoS path comes from AoS covariances that have drifted
+// from exact symmetry (the (I-KH)P update); per call that stays at rounding
+// level, below 1e-12 relative on every term.
+void predict_cv_batch(TrackBank& b, double dt, double sigma_a);
+
+// Same on tracks [begin, end) only (chunks of a parallel loop).
+void predict_cv_batch(TrackBank& b, size_t begin, size_t end, double dt, double sigma_a);
+
+// Coordinated-turn predict at a known turn rate omega (rad/s) on tracks
+// [begin, end): the velocity rotates by omega*dt and the position follows the
+// arc. Same white-acceleration Q as the CV model.
+void predict_ct_batch(TrackBank& b, size_t begin, size_t end, double dt, double sigma_a, double omega);
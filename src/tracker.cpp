@@ -1,187 +1,699 @@
 #include "tracker.h"
+#include "scratch.h"
 #include "hungarian.h"
+#include "checkpoint.h"
 #include <limits>
 #include <algorithm>
+#include <cmath>
 
-Track::Track(uint32_t id_, const KalmanCV2D& model, const Vec2& z_init, int confirm_N)
-  : id(id_), kf(model) {
+namespace {
+const double kLog2Pi = 1.8378770664093453;
+
+bool load_flag(StateReader& r, bool& v) {
+  uint8_t b = 0;
+  if (!r.pod(b) || b > 1) return false;
+  v = (b != 0);
+  return true;
+}
+
+// Per-track checkpoint record: filter, then lifecycle.
+void save_track(StateWriter& w, const Track& t) {
+  w.mat(t.kf.x);
+  w.mat(t.kf.P);
+  w.pod(t.kf.dt);
+  w.pod(t.kf.sigma_a);
+  w.pod(t.kf.sigma_z);
+  w.pod(t.age);
+  w.pod(t.misses);
+  w.pod(t.hits.bits);
+  w.pod((uint8_t)t.confirmed);
+}
+
+bool load_track(StateReader& r, Track& t) {
+  r.mat(t.kf.x);
+  r.mat(t.kf.P);
+  r.pod(t.kf.dt);
+  r.pod(t.kf.sigma_a);
+  r.pod(t.kf.sigma_z);
+  r.pod(t.age);
+  r.pod(t.misses);
+  r.pod(t.hits.bits);
+  return load_flag(r, t.confirmed);
+}
+
+}
+
+// Config record, field by field so the image carries no struct padding and
+// does not depend on TrackerConfig's layout. Enums travel as int32, bools as
+// one byte; load_config rejects values outside their range.
+void save_config(StateWriter& w, const TrackerConfig& c) {
+  w.pod(c.gate_maha2);
+  w.pod(c.max_misses);
+  w.pod(c.max_pos_sigma);
+  w.pod(c.confirm_M);
+  w.pod(c.confirm_N);
+  w.pod(c.init_gate_dist);
+  w.pod(c.init_required_hits);
+  w.pod(c.init_max_age);
+  w.pod(c.init_vel_sigma);
+  w.pod(c.init_acc_sigma);
+  w.pod((uint8_t)c.use_init_grid);
+  w.pod((int32_t)c.assoc);
+  w.pod((uint8_t)c.cluster_assignment);
+  w.pod(c.auction.eps_final);
+  w.pod(c.auction.eps_factor);
+  w.pod((uint8_t)c.auction_warm_start);
+  w.pod(c.p_detect);
+  w.pod(c.clutter_density);
+  w.pod(c.mht_hypotheses);
+  w.pod(c.mht_n_scan);
+  w.pod(c.jpda.max_exact_rows);
+  w.pod(c.jpda.max_events);
+  w.pod(c.jpda.prune);
+  w.pod((int32_t)c.motion);
+  w.pod(c.imm.turn_rate);
+  w.pod(c.imm.p_switch);
+  w.pod(c.imm.init_cv);
+  w.pod((int32_t)c.cov_update);
+  w.pod((uint8_t)c.use_gating_grid);
+  w.pod(c.grid_cell_size);
+}
+
+namespace {
+template <typename E>
+bool load_enum(StateReader& r, E& v, E last) {
+  int32_t i = 0;
+  if (!r.pod(i) || i < 0 || i > (int32_t)last) return false;
+  v = (E)i;
+  return true;
+}
+
+bool load_config(StateReader& r, TrackerConfig& c) {
+  r.pod(c.gate_maha2);
+  r.pod(c.max_misses);
+  r.pod(c.max_pos_sigma);
+  r.pod(c.confirm_M);
+  r.pod(c.confirm_N);
+  r.pod(c.init_gate_dist);
+  r.pod(c.init_required_hits);
+  r.pod(c.init_max_age);
+  r.pod(c.init_vel_sigma);
+  r.pod(c.init_acc_sigma);
+  if (!load_flag(r, c.use_init_grid)) return false;
+  if (!load_enum(r, c.assoc, AssocMethod::Jpda)) return false;
+  if (!load_flag(r, c.cluster_assignment)) return false;
+  r.pod(c.auction.eps_final);
+  r.pod(c.auction.eps_factor);
+  if (!load_flag(r, c.auction_warm_start)) return false;
+  r.pod(c.p_detect);
+  r.pod(c.clutter_density);
+  r.pod(c.mht_hypotheses);
+  r.pod(c.mht_n_scan);
+  r.pod(c.jpda.max_exact_rows);
+  r.pod(c.jpda.max_events);
+  r.pod(c.jpda.prune);
+  if (!load_enum(r, c.motion, MotionModel::Imm)) return false;
+  r.pod(c.imm.turn_rate);
+  r.pod(c.imm.p_switch);
+  r.pod(c.imm.init_cv);
+  if (!load_enum(r, c.cov_update, CovUpdate::SquareRoot)) return false;
+  if (!load_flag(r, c.use_gating_grid)) return false;
+  r.pod(c.grid_cell_size);
+  return r.ok() && c.confirm_N >= 1 && c.confirm_N <= 64;
+}
+
+constexpr size_t kTrackBytes = sizeof(Vec4) + sizeof(Mat4) + 3 * sizeof(double) + 2 * sizeof(int) +
+                               sizeof(uint64_t) + 1;
+}
+
+Track::Track(const KalmanCV2D& model, const Vec2& z_init)
+  : kf(model) {
   kf.x.setZero();
   kf.x(0) = z_init.x();
   kf.x(1) = z_init.y();
   kf.P = Mat4::Identity();
+}
 
-  hit_hist.assign(std::max(1, confirm_N), 0);
+MultiTargetTracker::MultiTargetTracker(TrackerConfig cfg) : cfg_(cfg) {
+  cfg_.confirm_N = std::min(std::max(cfg_.confirm_N, 1), 64);
+  cfg_.mht_hypotheses = std::max(cfg_.mht_hypotheses, 1);
+  cfg_.mht_n_scan = std::max(cfg_.mht_n_scan, 1);
+  if (cfg_.assoc == AssocMethod::Mht || cfg_.assoc == AssocMethod::Jpda) cfg_.motion = MotionModel::Cv;
+  if (cfg_.num_threads > 1) pool_ = std::make_unique<ThreadPool>(cfg_.num_threads);
 }
 
-double MultiTargetTracker::maha2_for(const Track& t, const Vec2& z, Mat2* out_S, Vec2* out_innov) {
-  Mat2x4 H;
-  H.setZero();
-  H(0,0) = 1.0; H(1,1) = 1.0;
+#if RADAR_STATS
+const TrackerStats& MultiTargetTracker::stats() const { return stats_; }
+void MultiTargetTracker::reset_stats() { stats_.clear(); }
+#else
+const TrackerStats& MultiTargetTracker::stats() const {
+  static const TrackerStats empty;
+  return empty;
+}
+void MultiTargetTracker::reset_stats() {}
+#endif
+
+void MultiTargetTracker::build_gate_cache() {
+  scratch_resize(gate_cache_, tracks_.size());
 
-  Mat2 R = Mat2::Identity() * (t.kf.sigma_z * t.kf.sigma_z);
+  parallel_for((int)tracks_.size(), kTrackGrain, [&](int begin, int end, int) {
+    for (int ti = begin; ti < end; ++ti) {
+      const KalmanCV2D& kf = tracks_[ti].kf;
+      GateCacheEntry& g = gate_cache_[ti];
 
-  Vec2 innov = z - (H * t.kf.x);
-  Mat2 S = H * t.kf.P * H.transpose() + R;
+      g.ic = kf.innovation_cov();
+      g.log_det_S = std::log(g.ic.S(0,0) * g.ic.S(1,1) - g.ic.S(1,0) * g.ic.S(0,1));
+      g.center = Vec2(kf.x(0), kf.x(1));
 
-  const double m2 = innov.transpose() * S.inverse() * innov;
-  if (out_S) *out_S = S;
-  if (out_innov) *out_innov = innov;
-  return m2;
+      // The gate ellipse y^T S^-1 y <= g lies inside |y_x| <= sqrt(g*S00), |y_y| <= sqrt(g*S11).
+      // Widen slightly so pairs on the gate boundary are never lost to rounding.
+      g.half = Vec2(std::sqrt(cfg_.gate_maha2 * g.ic.S(0,0)) * (1.0 + 1e-9) + 1e-9,
+                    std::sqrt(cfg_.gate_maha2 * g.ic.S(1,1)) * (1.0 + 1e-9) + 1e-9);
+    }
+  });
 }
 
-AssocResult MultiTargetTracker::associate(const std::vector<Vec2>& meas) {
-  return cfg_.use_hungarian ? associate_hungarian(meas) : associate_greedy(meas);
+// Retrodiction without the process-noise correlation term (Bar-Shalom's
+// one-lag algorithm, simplified): with B = F(-lag),
+//   x_b = B x,  P_b = B (P + Q(lag)) B^T,  S = H P_b H^T + R,
+//   P_xz = P B^T H^T (cross covariance of x with the old measurement).
+// Ignoring the correlation of x with the noise over the lag only inflates
+// S, so the update below stays conservative.
+void MultiTargetTracker::build_oosm_gate_cache(double lag, double sigma_z) {
+  scratch_resize(gate_cache_, tracks_.size());
+  scratch_resize(oosm_cross_, tracks_.size());
+  const double r = sigma_z * sigma_z;
+
+  parallel_for((int)tracks_.size(), kTrackGrain, [&](int begin, int end, int) {
+    for (int ti = begin; ti < end; ++ti) {
+      const KalmanCV2D& kf = tracks_[ti].kf;
+      KalmanCV2D b = kf;
+      b.dt = -lag; // B Q(lag) B^T is Q evaluated at -lag
+      b.predict();
+
+      Mat4x2& c = oosm_cross_[ti];
+      for (int i = 0; i < 4; ++i) {
+        c(i,0) = kf.P(i,0) - lag * kf.P(i,2);
+        c(i,1) = kf.P(i,1) - lag * kf.P(i,3);
+      }
+
+      GateCacheEntry& g = gate_cache_[ti];
+      g.ic.S(0,0) = b.P(0,0) + r;
+      g.ic.S(0,1) = b.P(0,1);
+      g.ic.S(1,0) = b.P(1,0);
+      g.ic.S(1,1) = b.P(1,1) + r;
+      const double det = g.ic.S(0,0) * g.ic.S(1,1) - g.ic.S(1,0) * g.ic.S(0,1);
+      g.ic.S_inv(0,0) = g.ic.S(1,1) / det;
+      g.ic.S_inv(0,1) = -g.ic.S(0,1) / det;
+      g.ic.S_inv(1,0) = -g.ic.S(1,0) / det;
+      g.ic.S_inv(1,1) = g.ic.S(0,0) / det;
+      g.log_det_S = std::log(det);
+      g.center = Vec2(b.x(0), b.x(1));
+      g.half = Vec2(std::sqrt(cfg_.gate_maha2 * g.ic.S(0,0)) * (1.0 + 1e-9) + 1e-9,
+                    std::sqrt(cfg_.gate_maha2 * g.ic.S(1,1)) * (1.0 + 1e-9) + 1e-9);
+    }
+  });
 }
 
-AssocResult MultiTargetTracker::associate_greedy(const std::vector<Vec2>& meas) {
-  AssocResult ar;
-  ar.track_to_meas.assign(tracks_.size(), -1);
-  ar.meas_to_track.assign(meas.size(), -1);
+int MultiTargetTracker::update_oosm(MeasSpan meas, double lag, double sigma_z) {
+  if (cfg_.assoc == AssocMethod::Mht || cfg_.motion == MotionModel::Imm) return -1;
+  if (tracks_.empty() || meas.size() == 0 || !(lag > 0.0)) return 0;
+
+  StatsClock clk;
+  const AssocResult& ar = associate_at(meas, lag, sigma_z);
+  const bool sqrt_cov = sqrt_form();
+  int updated = 0;
+  for (size_t ti = 0; ti < tracks_.size(); ++ti) {
+    const int mi = ar.track_to_meas[ti];
+    if (mi == -1) continue;
+    // K = P_xz S^-1,  x += K (z - x_b),  P -= K P_xz^T.
+    const GateCacheEntry& g = gate_cache_[ti];
+    const Mat4x2& c = oosm_cross_[ti];
+    const Vec2 y = meas[mi] - g.center;
+    KalmanCV2D& kf = tracks_[ti].kf;
+    const Vec4 x_prior = kf.x;
+    const Mat4 P_prior = kf.P;
+    double K[4][2];
+    for (int i = 0; i < 4; ++i) {
+      K[i][0] = c(i,0) * g.ic.S_inv(0,0) + c(i,1) * g.ic.S_inv(1,0);
+      K[i][1] = c(i,0) * g.ic.S_inv(0,1) + c(i,1) * g.ic.S_inv(1,1);
+      kf.x(i) += K[i][0] * y(0) + K[i][1] * y(1);
+    }
+    for (int i = 0; i < 4; ++i) {
+      for (int j = i; j < 4; ++j) kf.P(i,j) -= K[i][0] * c(j,0) + K[i][1] * c(j,1);
+    }
+    for (int i = 1; i < 4; ++i) for (int j = 0; j < i; ++j) kf.P(i,j) = kf.P(j,i);
+    if (sqrt_cov) {
+      // An update that leaves P indefinite is dropped, as in step_polar().
+      Mat4 L;
+      if (!cholesky4(kf.P, L)) {
+        kf.x = x_prior;
+        kf.P = P_prior;
+        continue;
+      }
+      sqrt_P_[ti] = L;
+    }
+    ++updated;
+  }
+  clk.lap(stats_, TrackerStage::Retrodict);
+  return updated;
+}
+
+void MultiTargetTracker::build_polar_gate_cache() {
+  scratch_resize(gate_cache_, tracks_.size());
+  scratch_resize(polar_gate_, tracks_.size());
+  const PolarModel& model = *polar_model_;
+
+  parallel_for((int)tracks_.size(), kTrackGrain, [&](int begin, int end, int) {
+    for (int ti = begin; ti < end; ++ti) {
+      PolarGate& pg = polar_gate_[ti];
+      GateCacheEntry& g = gate_cache_[ti];
+      polar_predict(tracks_[ti].kf, model, pg, g.center, g.half);
+
+      // Range / azimuth block, for last_S() and logging.
+      g.ic.S = pg.S.topLeftCorner<2, 2>();
+      const double det = g.ic.S(0,0) * g.ic.S(1,1) - g.ic.S(1,0) * g.ic.S(0,1);
+      g.ic.S_inv(0,0) = g.ic.S(1,1) / det;
+      g.ic.S_inv(0,1) = -g.ic.S(0,1) / det;
+      g.ic.S_inv(1,0) = -g.ic.S(1,0) / det;
+      g.ic.S_inv(1,1) = g.ic.S(0,0) / det;
+      g.log_det_S = std::log(model.doppler ? det * pg.S(2,2) : det);
+    }
+  });
+}
 
-  struct Edge { int ti; int mi; double m2; };
-  std::vector<Edge> edges;
-  edges.reserve(tracks_.size() * meas.size());
+template <typename Maha2>
+void MultiTargetTracker::gate_range_with(MeasSpan meas, int begin, int end, double gate2, Maha2&& maha2_of,
+                                         std::vector<int>& hits, std::vector<GatedPair>& out,
+                                         uint64_t& pairs) const {
+  const int M = (int)meas.size();
 
-  for (int ti = 0; ti < (int)tracks_.size(); ++ti) {
-    for (int mi = 0; mi < (int)meas.size(); ++mi) {
-      double m2 = maha2_for(tracks_[ti], meas[mi], nullptr, nullptr);
-      if (m2 <= cfg_.gate_maha2) {
-        edges.push_back({ti, mi, m2});
+  if (!cfg_.use_gating_grid) {
+    for (int ti = begin; ti < end; ++ti) {
+      for (int mi = 0; mi < M; ++mi) {
+        double m2 = maha2_of(ti, mi);
+        if (m2 < 0.0) continue;
+        pairs++;
+        if (m2 <= gate2) out.push_back({ti, mi, m2});
       }
     }
+    return;
   }
 
-  std::sort(edges.begin(), edges.end(), [](const Edge& a, const Edge& b){
+  for (int ti = begin; ti < end; ++ti) {
+    const GateCacheEntry& g = gate_cache_[ti];
+    const Vec2& c = g.center;
+    const Vec2& h = g.half;
+
+    hits.clear();
+    meas_grid_.query(c - h, c + h, hits);
+    // Keep (ti, mi) order identical to the all-pairs loop.
+    std::sort(hits.begin(), hits.end());
+
+    for (int mi : hits) {
+      const Vec2 d = meas[mi] - c;
+      if (std::abs(d.x()) > h.x() || std::abs(d.y()) > h.y()) continue;
+      double m2 = maha2_of(ti, mi);
+      if (m2 < 0.0) continue;
+      pairs++;
+      if (m2 <= gate2) out.push_back({ti, mi, m2});
+    }
+  }
+}
+
+void MultiTargetTracker::gate_range(MeasSpan meas, int begin, int end,
+                                    std::vector<int>& hits, std::vector<GatedPair>& out,
+                                    uint64_t& pairs) const {
+  if (polar_meas_) {
+    // Polar detections: range-rate pre-gate, then the measurement-space test.
+    // Pairs cut by the pre-gate are not counted as tests.
+    const PolarModel& model = *polar_model_;
+    const PolarMeas* z = polar_meas_;
+    gate_range_with(meas, begin, end, model.gate, [&](int ti, int mi) {
+      double m2;
+      return polar_maha2(polar_gate_[ti], z[mi], model, m2) ? m2 : -1.0;
+    }, hits, out, pairs);
+    return;
+  }
+  gate_range_with(meas, begin, end, cfg_.gate_maha2, [&](int ti, int mi) {
+    return maha2_for(gate_cache_[ti], meas[mi]);
+  }, hits, out, pairs);
+}
+
+void MultiTargetTracker::gate(MeasSpan meas) {
+  gated_.clear();
+  pairs_evaluated_ = 0;
+
+  const int T = (int)tracks_.size();
+  const int M = (int)meas.size();
+  if (T == 0 || M == 0) return;
+
+  if (cfg_.use_gating_grid) {
+    double cell = cfg_.grid_cell_size;
+    if (!(cell > 0.0)) {
+      // Auto: about one gate width per cell, so a query touches ~4 cells.
+      double sum = 0.0;
+      for (const auto& g : gate_cache_) sum += g.half.x() + g.half.y();
+      cell = sum / (double)T;
+    }
+    meas_grid_.build(meas, cell);
+  }
+
+  if (!pool_) {
+    grid_hits_.resize(1);
+    gate_range(meas, 0, T, grid_hits_[0], gated_, pairs_evaluated_);
+    return;
+  }
+
+  // Each chunk gates a contiguous track range, appending to its worker's
+  // buffer and recording where its pairs landed; the pieces are concatenated
+  // in chunk order, so gated_ is the same for any thread count. Buffers are
+  // per worker rather than per chunk so their number stays fixed.
+  const int chunks = ThreadPool::num_chunks(T, kGateGrain);
+  const size_t W = (size_t)pool_->size();
+  grid_hits_.resize(W);
+  worker_gated_.resize(W);
+  for (auto& buf : worker_gated_) buf.clear();
+  scratch_resize(chunk_spans_, (size_t)chunks);
+
+  pool_->parallel_for(T, kGateGrain, [&](int begin, int end, int worker) {
+    std::vector<GatedPair>& buf = worker_gated_[worker];
+    ChunkSpan& span = chunk_spans_[begin / kGateGrain];
+    span.worker = worker;
+    span.begin = buf.size();
+    span.pairs = 0;
+    gate_range(meas, begin, end, grid_hits_[worker], buf, span.pairs);
+    span.end = buf.size();
+  });
+
+  size_t total = 0;
+  for (const auto& span : chunk_spans_) total += span.end - span.begin;
+  scratch_reserve(gated_, total);
+  for (const auto& span : chunk_spans_) {
+    const auto& buf = worker_gated_[span.worker];
+    gated_.insert(gated_.end(), buf.begin() + (std::ptrdiff_t)span.begin, buf.begin() + (std::ptrdiff_t)span.end);
+    pairs_evaluated_ += span.pairs;
+  }
+}
+
+const AssocResult& MultiTargetTracker::associate(MeasSpan meas) {
+  return associate_at(meas, 0.0, 0.0);
+}
+
+const AssocResult& MultiTargetTracker::associate_at(MeasSpan meas, double lag, double sigma_z) {
+  StatsClock clk;
+  if (lag > 0.0) build_oosm_gate_cache(lag, sigma_z);
+  else if (polar_model_) build_polar_gate_cache();
+  else build_gate_cache();
+  scratch_assign(assoc_.track_to_meas, tracks_.size(), -1);
+  scratch_assign(assoc_.meas_to_track, meas.size(), -1);
+  gate(meas);
+  // Late scans are timed whole as Retrodict by update_oosm().
+  const bool timed = !(lag > 0.0);
+  if (timed) {
+    clk.lap(stats_, TrackerStage::Gating);
+    stats_.pairs.record(pairs_evaluated_);
+    stats_.gated.record(gated_.size());
+  }
+
+  auction_bids_ = 0;
+  switch (lag > 0.0 ? AssocMethod::Hungarian : cfg_.assoc) {
+    case AssocMethod::Greedy: assign_greedy(gated_, assoc_, info_); break;
+    case AssocMethod::Hungarian: associate_hungarian(meas); break;
+    case AssocMethod::Auction: associate_auction(meas); break;
+    // MHT scans go through step_mht(); a standalone association (benchmarks)
+    // is the single best one.
+    case AssocMethod::Mht: associate_hungarian(meas); break;
+    case AssocMethod::Jpda: associate_jpda(meas); break;
+  }
+  if (timed) clk.lap(stats_, TrackerStage::Assign);
+  return assoc_;
+}
+
+void assign_greedy(std::vector<GatedPair>& gated, AssocResult& ar, std::vector<TrackInfo>& info) {
+  std::sort(gated.begin(), gated.end(), [](const GatedPair& a, const GatedPair& b){
     return a.m2 < b.m2;
   });
 
-  for (const auto& e : edges) {
+  for (const auto& e : gated) {
     if (ar.track_to_meas[e.ti] != -1) continue;
     if (ar.meas_to_track[e.mi] != -1) continue;
     ar.track_to_meas[e.ti] = e.mi;
     ar.meas_to_track[e.mi] = e.ti;
-    tracks_[e.ti].last_maha2 = e.m2;
+    info[e.ti].last_maha2 = e.m2;
   }
-
-  return ar;
 }
 
-AssocResult MultiTargetTracker::associate_hungarian(const std::vector<Vec2>& meas) {
-  AssocResult ar;
-  ar.track_to_meas.assign(tracks_.size(), -1);
-  ar.meas_to_track.assign(meas.size(), -1);
+void build_sparse_cost(const std::vector<GatedPair>& gated, int T, int M, SparseCost& g) {
+  g.reset(T, M);
+  for (const auto& e : gated) g.add(e.ti, e.mi, e.m2);
+  g.finish();
+}
 
-  const int T = (int)tracks_.size();
-  const int M = (int)meas.size();
-  if (T == 0 || M == 0) return ar;
+void assign_sparse(const SparseCost& g, const std::vector<int>& assign, AssocResult& ar,
+                   std::vector<TrackInfo>& info) {
+  for (int ti = 0; ti < g.rows; ++ti) {
+    int mi = assign[ti];
+    if (mi == -1) continue;
+    ar.track_to_meas[ti] = mi;
+    ar.meas_to_track[mi] = ti;
+    for (int e = g.row_start[ti]; e < g.row_start[ti + 1]; ++e) {
+      if (g.col[e] == mi) info[ti].last_maha2 = g.cost[e];
+    }
+  }
+}
 
+void assign_dense(const std::vector<GatedPair>& gated, int T, int M, std::vector<double>& cost,
+                  HungarianScratch& ws, std::vector<int>& assign, AssocResult& ar,
+                  std::vector<TrackInfo>& info) {
   // Build cost matrix = maha2, but gate-out becomes huge cost.
   // We'll allow unassigned by letting Hungarian pick expensive matches; we then post-filter by gate.
   const double BIG = 1e9;
 
-  std::vector<std::vector<double>> cost((size_t)T, std::vector<double>((size_t)M, BIG));
-  for (int ti = 0; ti < T; ++ti) {
-    for (int mi = 0; mi < M; ++mi) {
-      double m2 = maha2_for(tracks_[ti], meas[mi], nullptr, nullptr);
-      if (m2 <= cfg_.gate_maha2) cost[ti][mi] = m2;
-      else cost[ti][mi] = BIG;
-    }
-  }
+  scratch_assign(cost, (size_t)T * (size_t)M, BIG);
+  for (const auto& e : gated) cost[(size_t)e.ti * M + e.mi] = e.m2;
 
   // Solve assignment (row=track -> col=measurement)
-  std::vector<int> assign = hungarian_min_cost(cost);
+  hungarian_min_cost(cost.data(), T, M, ws, assign);
 
   // Apply assignment with gate post-check (BIG means invalid)
   for (int ti = 0; ti < T; ++ti) {
     int mi = assign[ti];
     if (mi < 0 || mi >= M) continue;
-    double c = cost[ti][mi];
+    double c = cost[(size_t)ti * M + mi];
     if (c >= BIG * 0.5) continue; // invalid
     if (ar.meas_to_track[mi] != -1) continue; // safety
     ar.track_to_meas[ti] = mi;
     ar.meas_to_track[mi] = ti;
-    tracks_[ti].last_maha2 = c;
+    info[ti].last_maha2 = c;
+  }
+}
+
+void MultiTargetTracker::associate_hungarian(MeasSpan meas) {
+  const int T = (int)tracks_.size();
+  const int M = (int)meas.size();
+  if (T == 0 || M == 0) return;
+
+  if (cfg_.cluster_assignment) {
+    // Gated pairs only, solved per connected component.
+    build_sparse_cost(gated_, T, M, sparse_cost_);
+
+    clustered_min_cost(sparse_cost_, assign_ws_, assign_, pool_.get());
+    const GateClusters& cl = assign_ws_.clusters;
+    for (int k = 0; k < cl.count(); ++k) stats_.cluster_rows.record((uint64_t)cl.num_rows(k));
+    assign_sparse(sparse_cost_, assign_, assoc_, info_);
+    return;
   }
 
-  return ar;
+  assign_dense(gated_, T, M, dense_cost_, dense_ws_, assign_, assoc_, info_);
 }
 
-void MultiTargetTracker::initiate_from_unassigned_candidates(const std::vector<Vec2>& meas,
-                                                            const AssocResult& ar,
-                                                            double dt, double sigma_a, double sigma_z) {
-  const double gate2 = cfg_.init_gate_dist * cfg_.init_gate_dist;
+void MultiTargetTracker::associate_auction(MeasSpan meas) {
+  const int T = (int)tracks_.size();
+  const int M = (int)meas.size();
+  if (T == 0 || M == 0) {
+    for (auto& info : info_) info.assign_price = 0.0;
+    return;
+  }
 
-  std::vector<char> cand_used(cands_.size(), 0);
+  build_sparse_cost(gated_, T, M, sparse_cost_);
 
-  for (int mi = 0; mi < (int)meas.size(); ++mi) {
-    if (ar.meas_to_track[mi] != -1) continue;
+  const double* warm = nullptr;
+  if (cfg_.auction_warm_start) {
+    scratch_resize(price_in_, (size_t)T);
+    for (int ti = 0; ti < T; ++ti) price_in_[ti] = info_[ti].assign_price;
+    warm = price_in_.data();
+  }
+  auction_bids_ = clustered_auction(sparse_cost_, warm, cfg_.auction, assign_ws_, assign_,
+                                    price_out_, pool_.get());
+  const GateClusters& cl = assign_ws_.clusters;
+  for (int k = 0; k < cl.count(); ++k) stats_.cluster_rows.record((uint64_t)cl.num_rows(k));
 
-    const Vec2 z = meas[mi];
+  for (int ti = 0; ti < T; ++ti) info_[ti].assign_price = price_out_[ti];
+  assign_sparse(sparse_cost_, assign_, assoc_, info_);
+}
 
-    int best_ci = -1;
-    double best_d2 = std::numeric_limits<double>::infinity();
+// Marginal association probabilities of every gated pair. The hard result
+// is for bookkeeping only: a track counts as detected (and reports a
+// measurement) when one measurement is its own with probability >= 0.5, and a
+// measurement belongs to the track that claims it most, so gated
+// measurements never seed new tracks.
+void MultiTargetTracker::associate_jpda(MeasSpan meas) {
+  AssocResult& ar = assoc_;
+  jpda_info_ = JpdaInfo();
 
-    for (int ci = 0; ci < (int)cands_.size(); ++ci) {
-      if (cand_used[ci]) continue;
-      const Vec2 d = z - cands_[ci].z;
-      const double d2 = d.squaredNorm();
-      if (d2 <= gate2 && d2 < best_d2) {
-        best_d2 = d2;
-        best_ci = ci;
+  const int T = (int)tracks_.size();
+  const int M = (int)meas.size();
+  scratch_assign(jpda_beta0_, (size_t)T, 1.0);
+  if (T == 0 || M == 0) return;
+
+  build_sparse_cost(gated_, T, M, sparse_cost_);
+
+  // pd N(z; z_pred, S) / lambda per pair, against 1 - pd for a miss. The
+  // density floor keeps the ratios finite with clutter switched off.
+  const double pd = std::min(std::max(cfg_.p_detect, 1e-6), 1.0 - 1e-6);
+  const double offset = kLog2Pi - std::log(pd) + std::log(std::max(cfg_.clutter_density, 1e-20));
+  jpda_g_ = sparse_cost_;
+  for (int ti = 0; ti < T; ++ti) {
+    const double log_det_S = gate_cache_[ti].log_det_S;
+    for (int e = jpda_g_.row_start[ti]; e < jpda_g_.row_start[ti + 1]; ++e) {
+      jpda_g_.cost[e] = std::exp(-(0.5 * (sparse_cost_.cost[e] + log_det_S) + offset));
+    }
+  }
+
+  jpda_info_ = clustered_jpda(jpda_g_, 1.0 - pd, cfg_.jpda, assign_ws_, jpda_beta_, jpda_beta0_,
+                              pool_.get());
+  const GateClusters& cl = assign_ws_.clusters;
+  for (int k = 0; k < cl.count(); ++k) stats_.cluster_rows.record((uint64_t)cl.num_rows(k));
+
+  // meas_to_track: highest beta per measurement, ties to the lower track.
+  scratch_assign(jpda_meas_beta_, (size_t)M, -1.0);
+  for (int ti = 0; ti < T; ++ti) {
+    int best_e = -1;
+    for (int e = sparse_cost_.row_start[ti]; e < sparse_cost_.row_start[ti + 1]; ++e) {
+      const int mi = sparse_cost_.col[e];
+      if (jpda_beta_[e] > jpda_meas_beta_[mi]) {
+        jpda_meas_beta_[mi] = jpda_beta_[e];
+        ar.meas_to_track[mi] = ti;
       }
+      if (best_e == -1 || jpda_beta_[e] > jpda_beta_[best_e]) best_e = e;
+    }
+    if (best_e != -1 && jpda_beta_[best_e] >= 0.5) {
+      ar.track_to_meas[ti] = sparse_cost_.col[best_e];
+      info_[ti].last_maha2 = sparse_cost_.cost[best_e];
     }
+  }
+}
+
+void MultiTargetTracker::update_jpda(int ti, MeasSpan meas) {
+  const GateCacheEntry& g = gate_cache_[ti];
+  Vec2 nu = Vec2::Zero();
+  Mat2 spread = Mat2::Zero();
+  for (int e = sparse_cost_.row_start[ti]; e < sparse_cost_.row_start[ti + 1]; ++e) {
+    const double b = jpda_beta_[e];
+    const Vec2 y = meas[sparse_cost_.col[e]] - g.center;
+    nu += b * y;
+    spread += b * (y * y.transpose());
+  }
+  spread -= nu * nu.transpose();
+  tracks_[ti].kf.update_pda(nu, spread, jpda_beta0_[ti], g.ic);
+  last_innovs_[ti] = nu;
+  last_S_[ti] = g.ic.S;
+}
+
+void MultiTargetTracker::match_candidates(MeasSpan meas, const AssocResult& ar, double sigma_z, bool frame) {
+  // Candidates that exist at scan start are indexed by position; ones created
+  // during the scan are already used, so they never need to be found.
+  const int num_indexed = (int)cands_.size();
+  scratch_assign(cand_used_, cands_.size(), 0);
+  if (cfg_.use_init_grid) {
+    scratch_resize(cand_pos_, cands_.size());
+    for (size_t ci = 0; ci < cands_.size(); ++ci) cand_pos_[ci] = cands_[ci].z;
+    cand_grid_.build(cand_pos_, cfg_.init_gate_dist);
+  }
+
+  for (int mi = 0; mi < (int)meas.size(); ++mi) {
+    if (ar.meas_to_track[mi] != -1) continue;
+
+    const Vec2 z = meas[mi];
+    const int best_ci = nearest_candidate(cands_, cand_used_, z, cfg_.init_gate_dist, num_indexed,
+                                          cfg_.use_init_grid ? &cand_grid_ : nullptr, cand_hits_);
 
     if (best_ci != -1) {
-      cand_used[best_ci] = 1;
-      cands_[best_ci].z = z;
-      cands_[best_ci].hits += 1;
-      cands_[best_ci].age = 0;
+      Candidate& c = cands_[best_ci];
+      cand_used_[best_ci] = 1;
+      c.z = z;
+      c.age = 0;
+      c.meas = frame ? -1 : mi;
+      c.sigma_z = sigma_z;
+      // In a frame, a candidate takes one hit however many scans see it.
+      if (!frame || !cand_frame_hit_[best_ci]) c.hits += 1;
+      if (frame) cand_frame_hit_[best_ci] = 1;
     } else {
       Candidate c;
       c.z = z;
       c.hits = 1;
       c.age = 0;
+      c.meas = frame ? -1 : mi;
+      c.sigma_z = sigma_z;
       cands_.push_back(c);
-      cand_used.push_back(1);
+      cand_used_.push_back(1);
+      if (frame) cand_frame_hit_.push_back(1);
     }
   }
+}
 
-  for (int ci = 0; ci < (int)cands_.size(); ++ci) {
-    if (!cand_used[ci]) cands_[ci].age += 1;
-  }
-
-  cands_.erase(std::remove_if(cands_.begin(), cands_.end(), [&](const Candidate& c){
-    return c.age > cfg_.init_max_age;
-  }), cands_.end());
-
-  KalmanCV2D model(dt, sigma_a, sigma_z);
-
-  std::vector<Candidate> keep;
-  keep.reserve(cands_.size());
+void MultiTargetTracker::promote_candidates(double dt, double sigma_a, const std::vector<char>& hit) {
+  // One in-place pass: age the unmatched, drop the stale, promote the mature,
+  // compact the rest (order preserved).
+  born_meas_.clear();
+  size_t w = 0;
+  for (size_t ci = 0; ci < cands_.size(); ++ci) {
+    Candidate c = cands_[ci];
+    if (!hit[ci]) {
+      c.age += 1;
+      c.meas = -1;
+    }
+    if (c.age > cfg_.init_max_age) continue;
 
-  for (const auto& c : cands_) {
     if (c.hits >= cfg_.init_required_hits) {
-      Track t(next_id_++, model, c.z, cfg_.confirm_N);
+      const double sigma_z = c.sigma_z;
+      Track t(KalmanCV2D(dt, sigma_a, sigma_z), c.z);
 
       t.kf.P.setZero();
       t.kf.P(0,0) = sigma_z*sigma_z;
       t.kf.P(1,1) = sigma_z*sigma_z;
       t.kf.P(2,2) = cfg_.init_vel_sigma * cfg_.init_vel_sigma;
       t.kf.P(3,3) = cfg_.init_vel_sigma * cfg_.init_vel_sigma;
+      if (polar_meas_ && c.meas >= 0) polar_init(t.kf, polar_meas_[c.meas], *polar_model_, cfg_.init_vel_sigma);
 
       t.age = 1;
       t.misses = 0;
 
-      for (int i = 0; i < (int)t.hit_hist.size() && i < c.hits; ++i) t.hit_hist[i] = 1;
-
+      t.hits.seed(c.hits, cfg_.confirm_N);
       t.confirmed = (t.hits_in_window() >= cfg_.confirm_M);
       tracks_.push_back(t);
+      if (cfg_.motion == MotionModel::Imm) imm_.push_back(t.kf, cfg_.imm);
+      if (sqrt_form()) {
+        sqrt_P_.emplace_back();
+        cholesky4(t.kf.P, sqrt_P_.back());
+      }
+      born_meas_.push_back(c.meas);
+      TrackInfo info;
+      info.id = next_id_++;
+      info_.push_back(info);
     } else {
-      keep.push_back(c);
+      cands_[w++] = c;
     }
   }
+  cands_.resize(w);
+}
 
-  cands_.swap(keep);
+void MultiTargetTracker::initiate_from_unassigned_candidates(MeasSpan meas,
+                                                            const AssocResult& ar,
+                                                            double dt, double sigma_a, double sigma_z) {
+  match_candidates(meas, ar, sigma_z, false);
+  promote_candidates(dt, sigma_a, cand_used_);
 }
 
 void MultiTargetTracker::prune_and_confirm() {
@@ -189,62 +701,338 @@ void MultiTargetTracker::prune_and_confirm() {
     t.confirmed = (t.hits_in_window() >= cfg_.confirm_M);
   }
 
-  tracks_.erase(std::remove_if(tracks_.begin(), tracks_.end(), [&](const Track& t){
-    return t.misses > cfg_.max_misses;
-  }), tracks_.end());
+  // Compact hot and cold arrays (and the IMM bank / factors) together.
+  const bool imm = (cfg_.motion == MotionModel::Imm);
+  const bool sqrt_cov = sqrt_form();
+  size_t w = 0;
+  for (size_t r = 0; r < tracks_.size(); ++r) {
+    if (track_lost(tracks_[r])) continue;
+    if (w != r) {
+      tracks_[w] = tracks_[r];
+      info_[w] = info_[r];
+      if (imm) imm_.move(r, w);
+      if (sqrt_cov) sqrt_P_[w] = sqrt_P_[r];
+    }
+    ++w;
+  }
+  tracks_.erase(tracks_.begin() + (std::ptrdiff_t)w, tracks_.end());
+  info_.resize(w);
+  if (imm) imm_.resize(w);
+  if (sqrt_cov) sqrt_P_.resize(w);
 }
 
-void MultiTargetTracker::step(const std::vector<Vec2>& measurements, double dt, double sigma_a, double sigma_z) {
-  // 1) predict all
-  for (auto& t : tracks_) {
-    t.kf.dt = dt;
-    t.kf.sigma_a = sigma_a;
-    t.kf.sigma_z = sigma_z;
-    t.kf.predict();
-    t.age += 1;
-    t.last_maha2 = 0.0;
+void MultiTargetTracker::predict_all(double dt, double sigma_a, double sigma_z, bool tick) {
+  const bool imm = (cfg_.motion == MotionModel::Imm);
+  const bool sqrt_cov = sqrt_form();
+  parallel_for((int)tracks_.size(), kTrackGrain, [&](int begin, int end, int) {
+    // IMM: mix and predict each model over the whole chunk, then combine.
+    if (imm) imm_.predict((size_t)begin, (size_t)end, dt, sigma_a, cfg_.imm);
+    for (int ti = begin; ti < end; ++ti) {
+      Track& t = tracks_[ti];
+      t.kf.dt = dt;
+      t.kf.sigma_a = sigma_a;
+      t.kf.sigma_z = sigma_z;
+      if (imm) imm_.combine((size_t)ti, t.kf);
+      else if (sqrt_cov) predict_sqrt(t.kf, sqrt_P_[ti]);
+      else t.kf.predict();
+      if (tick) t.age += 1;
+      info_[ti].last_maha2 = 0.0;
+    }
+  });
+}
+
+void MultiTargetTracker::update_assigned(MeasSpan measurements, const AssocResult& ar, double sigma_z,
+                                         bool tick) {
+  scratch_assign(last_innovs_, tracks_.size(), Vec2::Zero());
+  scratch_assign(last_S_, tracks_.size(), Mat2::Zero());
+
+  const bool jpda = (cfg_.assoc == AssocMethod::Jpda);
+  const bool imm = (cfg_.motion == MotionModel::Imm);
+  const bool sqrt_cov = sqrt_form();
+  parallel_for((int)tracks_.size(), kTrackGrain, [&](int begin, int end, int) {
+    for (int ti = begin; ti < end; ++ti) {
+      const int mi = ar.track_to_meas[ti];
+
+      // slide hit window, or only note the hit until end_frame()
+      if (tick) tracks_[ti].hits.push(mi != -1, cfg_.confirm_N);
+      else if (mi != -1) frame_hit_[ti] = 1;
+
+      // JPDA: weighted update from every gated measurement; the hard
+      // association only drives the miss count.
+      if (jpda) {
+        if (jpda_beta0_[ti] < 1.0) update_jpda(ti, measurements);
+        if (tick) tracks_[ti].misses = (mi == -1) ? tracks_[ti].misses + 1 : 0;
+        continue;
+      }
+
+      if (mi == -1) {
+        if (tick) tracks_[ti].misses += 1;
+        continue;
+      }
+
+      Vec2 innov;
+      if (imm) {
+        imm_.update((size_t)ti, measurements[mi], sigma_z);
+        imm_.combine((size_t)ti, tracks_[ti].kf);
+        innov = measurements[mi] - gate_cache_[ti].center;
+      } else if (sqrt_cov) {
+        update_pos_sqrt(tracks_[ti].kf, sqrt_P_[ti], measurements[mi], &innov);
+      } else {
+        tracks_[ti].kf.update_pos(measurements[mi], gate_cache_[ti].ic, cfg_.cov_update, &innov);
+      }
+
+      last_innovs_[ti] = innov;
+      last_S_[ti] = gate_cache_[ti].ic.S;
+
+      if (tick) tracks_[ti].misses = 0;
+    }
+  });
+}
+
+void MultiTargetTracker::step(MeasSpan measurements, double dt, double sigma_a, double sigma_z) {
+  if (cfg_.assoc == AssocMethod::Mht) {
+    step_mht(measurements, dt, sigma_a, sigma_z);
+    return;
   }
+  StatsClock step_clk;
+  StatsClock clk;
 
-  // 2) association (greedy or hungarian)
-  AssocResult ar = associate(measurements);
+  // 1) predict all
+  predict_all(dt, sigma_a, sigma_z, true);
+  clk.lap(stats_, TrackerStage::Predict);
 
-  last_innovs_.assign(tracks_.size(), Vec2::Zero());
-  last_S_.assign(tracks_.size(), Mat2::Zero());
+  // 2) gate cache + association (greedy or hungarian); timed inside
+  const AssocResult& ar = associate(measurements);
+  clk.restart();
 
   // 3) update associated tracks
-  for (int ti = 0; ti < (int)tracks_.size(); ++ti) {
-    int mi = ar.track_to_meas[ti];
+  update_assigned(measurements, ar, sigma_z, true);
+  clk.lap(stats_, TrackerStage::Update);
 
-    // slide hit window
-    if (!tracks_[ti].hit_hist.empty()) {
-      std::rotate(tracks_[ti].hit_hist.begin(), tracks_[ti].hit_hist.begin() + 1, tracks_[ti].hit_hist.end());
-      tracks_[ti].hit_hist.back() = (mi != -1) ? 1 : 0;
-    }
+  finish_scan(measurements, &ar, dt, sigma_a, sigma_z);
+  step_clk.lap(stats_, TrackerStage::Step);
+}
 
-    if (mi == -1) {
-      tracks_[ti].misses += 1;
-      continue;
-    }
+bool MultiTargetTracker::update_scan(MeasSpan measurements, double dt, double sigma_a, double sigma_z) {
+  if (cfg_.assoc == AssocMethod::Mht) return false;
+  StatsClock clk;
+  if (!frame_open_) {
+    scratch_assign(frame_hit_, tracks_.size(), 0);
+    scratch_assign(cand_frame_hit_, cands_.size(), 0);
+    frame_open_ = true;
+  }
+  frame_dt_ = dt;
+  frame_sigma_a_ = sigma_a;
+
+  predict_all(dt, sigma_a, sigma_z, false);
+  clk.lap(stats_, TrackerStage::Predict);
+
+  const AssocResult& ar = associate(measurements);
+  clk.restart();
 
-    Vec2 innov;
-    Mat2 S;
-    tracks_[ti].kf.update(measurements[mi], &innov, &S);
+  update_assigned(measurements, ar, sigma_z, false);
+  clk.lap(stats_, TrackerStage::Update);
 
-    last_innovs_[ti] = innov;
-    last_S_[ti] = S;
+  // Candidates only collect hits here; they age and promote in end_frame().
+  match_candidates(measurements, ar, sigma_z, true);
+  clk.lap(stats_, TrackerStage::Initiate);
+  return true;
+}
 
-    tracks_[ti].misses = 0;
+void MultiTargetTracker::end_frame() {
+  if (!frame_open_) return;
+  frame_open_ = false;
+  for (size_t ti = 0; ti < tracks_.size(); ++ti) {
+    const bool hit = frame_hit_[ti] != 0;
+    tracks_[ti].hits.push(hit, cfg_.confirm_N);
+    tracks_[ti].misses = hit ? 0 : tracks_[ti].misses + 1;
+    tracks_[ti].age += 1;
   }
+  finish_scan(MeasSpan(), nullptr, frame_dt_, frame_sigma_a_, 0.0);
+}
+
+bool MultiTargetTracker::step_polar(const std::vector<PolarMeas>& meas, double dt, double sigma_a,
+                                    const PolarModel& model) {
+  if (cfg_.assoc == AssocMethod::Mht || cfg_.assoc == AssocMethod::Jpda ||
+      cfg_.motion == MotionModel::Imm) return false;
+  StatsClock step_clk;
+  StatsClock clk;
+
+  scratch_resize(polar_pos_, meas.size());
+  for (size_t i = 0; i < meas.size(); ++i) polar_pos_[i] = polar_to_cart(meas[i], model.sensor);
+
+  predict_all(dt, sigma_a, model.sigma_r, true);
+  clk.lap(stats_, TrackerStage::Predict);
+
+  polar_meas_ = meas.data();
+  polar_model_ = &model;
+  const AssocResult& ar = associate(polar_pos_);
+  clk.restart();
+
+  scratch_assign(last_innovs_, tracks_.size(), Vec2::Zero());
+  scratch_assign(last_S_, tracks_.size(), Mat2::Zero());
+
+  // Innovations are (range, azimuth) residuals and last_S() their block of S.
+  // With the square-root form L is refactored from the updated P; when that
+  // P is no longer positive definite the update is dropped, and the track
+  // keeps its predicted state and factor and counts the scan as a miss.
+  const bool sqrt_cov = sqrt_form();
+  parallel_for((int)tracks_.size(), kTrackGrain, [&](int begin, int end, int) {
+    for (int ti = begin; ti < end; ++ti) {
+      const int mi = ar.track_to_meas[ti];
+      KalmanCV2D& kf = tracks_[ti].kf;
+      Vec2 innov;
+      bool updated = mi != -1;
+      if (updated && sqrt_cov) {
+        const Vec4 x_pred = kf.x;
+        const Mat4 P_pred = kf.P;
+        polar_update(kf, polar_gate_[ti], meas[(size_t)mi], model, &innov);
+        Mat4 L;
+        updated = cholesky4(kf.P, L);
+        if (updated) {
+          sqrt_P_[ti] = L;
+        } else {
+          kf.x = x_pred;
+          kf.P = P_pred;
+        }
+      } else if (updated) {
+        polar_update(kf, polar_gate_[ti], meas[(size_t)mi], model, &innov);
+      }
+
+      tracks_[ti].hits.push(updated, cfg_.confirm_N);
+      if (!updated) {
+        tracks_[ti].misses += 1;
+        continue;
+      }
+
+      last_innovs_[ti] = innov;
+      last_S_[ti] = gate_cache_[ti].ic.S;
+      tracks_[ti].misses = 0;
+    }
+  });
+  clk.lap(stats_, TrackerStage::Update);
+
+  finish_scan(polar_pos_, &ar, dt, sigma_a, model.sigma_r);
+  polar_meas_ = nullptr;
+  polar_model_ = nullptr;
+  step_clk.lap(stats_, TrackerStage::Step);
+  return true;
+}
 
+void MultiTargetTracker::finish_scan(MeasSpan meas, const AssocResult* ar,
+                                     double dt, double sigma_a, double sigma_z) {
+  StatsClock clk;
   // 4) initiate via candidates
   const size_t before_tracks = tracks_.size();
-  initiate_from_unassigned_candidates(measurements, ar, dt, sigma_a, sigma_z);
+  if (ar) initiate_from_unassigned_candidates(meas, *ar, dt, sigma_a, sigma_z);
+  else promote_candidates(dt, sigma_a, cand_frame_hit_);
 
   if (tracks_.size() > before_tracks) {
+    scratch_reserve(last_innovs_, tracks_.size());
+    scratch_reserve(last_S_, tracks_.size());
     last_innovs_.resize(tracks_.size(), Vec2::Zero());
     last_S_.resize(tracks_.size(), Mat2::Zero());
   }
+  clk.lap(stats_, TrackerStage::Initiate);
 
   // 5) confirm + prune
   prune_and_confirm();
-}
\ No newline at end of file
+  clk.lap(stats_, TrackerStage::Prune);
+  stats_.candidates.record(cands_.size());
+  stats_.tracks.record(tracks_.size());
+}
+
+bool MultiTargetTracker::save_state(StateWriter& w) const {
+  if (cfg_.assoc == AssocMethod::Mht) return false;
+
+  save_config(w, cfg_);
+  w.pod(next_id_);
+  w.pod(scan_);
+
+  w.pod((uint64_t)tracks_.size());
+  for (const Track& t : tracks_) save_track(w, t);
+  for (const TrackInfo& in : info_) {
+    w.pod(in.id);
+    w.pod(in.last_maha2);
+    w.pod(in.assign_price);
+  }
+
+  w.pod((uint64_t)cands_.size());
+  for (const Candidate& c : cands_) {
+    w.mat(c.z);
+    w.pod(c.hits);
+    w.pod(c.age);
+    w.pod(c.meas);
+    w.pod(c.sigma_z);
+  }
+
+  w.pod((uint64_t)sqrt_P_.size());
+  for (const Mat4& L : sqrt_P_) w.mat(L);
+  imm_.save_state(w);
+  return true;
+}
+
+bool MultiTargetTracker::load_state(StateReader& r) {
+  // Read into temporaries, so a malformed image changes nothing.
+  TrackerConfig cfg;
+  uint32_t next_id = 0;
+  int scan = 0;
+  if (!load_config(r, cfg)) return false;
+  r.pod(next_id);
+  r.pod(scan);
+  if (!r.ok() || cfg.assoc == AssocMethod::Mht) return false;
+
+  uint64_t n = 0;
+  if (!r.count(n, kTrackBytes)) return false;
+  std::vector<Track> tracks((size_t)n, Track(KalmanCV2D(), Vec2::Zero()));
+  for (Track& t : tracks) {
+    if (!load_track(r, t)) return false;
+  }
+  std::vector<TrackInfo> info(tracks.size());
+  for (TrackInfo& in : info) {
+    r.pod(in.id);
+    r.pod(in.last_maha2);
+    r.pod(in.assign_price);
+  }
+
+  if (!r.count(n, sizeof(Vec2) + 3 * sizeof(int) + sizeof(double))) return false;
+  std::vector<Candidate> cands((size_t)n);
+  for (Candidate& c : cands) {
+    r.mat(c.z);
+    r.pod(c.hits);
+    r.pod(c.age);
+    r.pod(c.meas);
+    r.pod(c.sigma_z);
+  }
+
+  if (!r.count(n, sizeof(Mat4))) return false;
+  std::vector<Mat4> sqrt_P((size_t)n);
+  for (Mat4& L : sqrt_P) r.mat(L);
+
+  ImmBank imm;
+  if (!imm.load_state(r) || !r.ok()) return false;
+  if (imm.size() != (cfg.motion == MotionModel::Imm ? tracks.size() : 0)) return false;
+
+  // The image must come from a tracker configured like this one.
+  std::vector<uint8_t> mine, theirs;
+  {
+    StateWriter wm(mine);
+    save_config(wm, cfg_);
+    StateWriter wt(theirs);
+    save_config(wt, cfg);
+  }
+  if (mine != theirs) return false;
+  if (sqrt_P.size() != (sqrt_form() ? tracks.size() : 0)) return false;
+
+  next_id_ = next_id;
+  scan_ = scan;
+  tracks_ = std::move(tracks);
+  info_ = std::move(info);
+  cands_ = std::move(cands);
+  sqrt_P_ = std::move(sqrt_P);
+  imm_ = std::move(imm);
+  frame_open_ = false;
+  last_innovs_.assign(tracks_.size(), Vec2::Zero());
+  last_S_.assign(tracks_.size(), Mat2::Zero());
+  return true;
+}
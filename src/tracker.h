@@ -2,7 +2,32 @@
 #include <vector>
 #include <cstdint>
 #include <numeric>
+#include <limits>
+#include <memory>
+#include <unordered_map>
 #include "kalman.h"
+#include "spatial_grid.h"
+#include "hungarian.h"
+#include "gate_clusters.h"
+#include "thread_pool.h"
+#include "tracker_stats.h"
+#include "murty.h"
+#include "jpda.h"
+#include "imm.h"
+#include "kalman_sqrt.h"
+#include "polar.h"
+
+class StateWriter;
+class StateReader;
+
+// Track-to-measurement assignment over the gated pairs.
+enum class AssocMethod {
+  Greedy,    // cheapest pairs first
+  Hungarian, // optimal: clustered sparse solver, or dense (cluster_assignment off)
+  Auction,   // eps-optimal auction per cluster, prices warm-started per track
+  Mht,       // multiple hypotheses: k best global assignments (Murty), N-scan pruning
+  Jpda,      // joint probabilistic: every gated measurement, weighted per cluster
+};
 
 // Track lifecycle config
 struct TrackerConfig {
@@ -10,40 +35,161 @@ struct TrackerConfig {
   double gate_maha2 = 9.21;
 
   int max_misses = 8;
+  // Also drop a track once its position standard deviation (RMS over x and
+  // y) exceeds this many sigma_z; 0 = off. Keeps coasting tracks from
+  // growing gates wide enough to live on clutter, which JPDA's weighted
+  // updates otherwise allow.
+  double max_pos_sigma = 0.0;
 
   // M-of-N confirmation
   int confirm_M = 3;
-  int confirm_N = 5;
+  int confirm_N = 5; // clamped to [1, 64]
 
   // Track initiation (anti-clutter)
   double init_gate_dist = 12.0;
   int init_required_hits = 2;
   int init_max_age = 2;
   double init_vel_sigma = 40.0;
+  double init_acc_sigma = 10.0; // constant-acceleration models (TrackerND)
+  // Find candidates through a grid of init_gate_dist cells instead of
+  // scanning the whole candidate list per unassigned measurement.
+  bool use_init_grid = true;
 
   // Association strategy
-  bool use_hungarian = true;
+  AssocMethod assoc = AssocMethod::Hungarian;
+  // Hungarian: split gated pairs into connected clusters and solve each
+  // sparsely instead of one dense T x M matrix.
+  bool cluster_assignment = true;
+  // Auction: epsilon schedule, and whether each cluster starts from the
+  // prices its tracks paid last scan with a shortened schedule. Off by
+  // default: measurements are new objects every scan, so the old prices
+  // rarely sit near the new equilibrium (see README, Auction Association).
+  AuctionParams auction;
+  bool auction_warm_start = false;
+  // Detection / clutter model of the MHT hypothesis scores and the JPDA
+  // event weights (likelihood ratios against "all clutter").
+  double p_detect = 0.9;
+  double clutter_density = 1e-4; // false alarms per m^2 per scan
+  // MHT: global hypotheses kept per scan, and depth after which all of them
+  // must agree with the best one.
+  int mht_hypotheses = 8;
+  int mht_n_scan = 3;
+  // JPDA: exact enumeration limits per cluster; larger clusters fall back to
+  // the Fitzgerald approximation (see jpda.h).
+  JpdaParams jpda;
+
+  // Motion model. IMM runs with greedy, Hungarian and auction association;
+  // MHT and JPDA keep one CV filter per track.
+  MotionModel motion = MotionModel::Cv;
+  ImmParams imm;
+
+  // Covariance form of the measurement update (Joseph or SquareRoot for long
+  // runs). With CV motion and greedy, Hungarian or auction association,
+  // SquareRoot keeps a Cholesky factor per track through predict and update;
+  // MHT refactors P at each update, and JPDA and IMM ignore the setting.
+  CovUpdate cov_update = CovUpdate::Standard;
+
+  // Worker threads for predict, gating, cluster solves and update (1 = serial).
+  // Output is identical for any value.
+  int num_threads = 1;
+
+  // Gating: query a uniform grid over measurements with each track's gate
+  // bounding box instead of testing every track x measurement pair.
+  bool use_gating_grid = true;
+  double grid_cell_size = 0.0; // meters, <= 0 = auto
+};
+
+// Checkpoint record of a config (checkpoint.h), field by field. Holds every
+// field except num_threads, which does not change the output.
+void save_config(StateWriter& w, const TrackerConfig& c);
+
+inline int popcount64(uint64_t v) {
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_popcountll(v);
+#else
+  int n = 0;
+  for (; v; v &= v - 1) ++n;
+  return n;
+#endif
+}
+
+// M-of-N hit history as a bit window: bit 0 is the latest scan, bit k the scan
+// k steps ago; only the low N bits (N <= 64) are kept.
+struct HitWindow {
+  uint64_t bits = 0;
+
+  static uint64_t mask(int n) { return n >= 64 ? ~0ull : ((1ull << n) - 1ull); }
+
+  void push(bool hit, int n) { bits = ((bits << 1) | (hit ? 1ull : 0ull)) & mask(n); }
+  // A new track's window: its candidate's hits fill the oldest slots.
+  void seed(int hits, int n) { for (int i = 0; i < n && i < hits; ++i) bits |= 1ull << (n - 1 - i); }
+  int count() const { return popcount64(bits); }
 };
 
+// Hot per-track state: everything predict, gating, update and pruning touch
+// each scan. Identity and diagnostics live in TrackInfo, a parallel array.
 struct Track {
-  uint32_t id = 0;
   KalmanCV2D kf;
 
   int age = 0;
   int misses = 0;
 
+  HitWindow hits;
   bool confirmed = false;
+
+  Track(const KalmanCV2D& model, const Vec2& z_init);
+  int hits_in_window() const { return hits.count(); }
+};
+
+// Cold per-track data, indexed like tracks().
+struct TrackInfo {
+  uint32_t id = 0;
+  double last_maha2 = 0.0; // Mahalanobis distance of this scan's association, 0 if none
+  double assign_price = 0.0; // auction price paid this scan (next scan's warm start)
+};
+
+// Per-track gating data, computed once per scan right after predict and
+// shared by gating, both association strategies, the grid query and the update.
+struct GateCacheEntry {
+  InnovCov ic;                 // S = HPH^T + R and S^-1
+  double log_det_S = 0.0;
+  Vec2 center = Vec2::Zero();  // predicted position
+  Vec2 half = Vec2::Zero();    // half extents of the gate ellipse bounding box
+};
+
+// MHT track state after one scan of one hypothesis branch. Nodes are
+// immutable once built and shared: hypotheses that agree on a track point to
+// the same node, and a branch only allocates the nodes it changes (copy on
+// write). parent links reach back mht_n_scan scans and are cut below that,
+// where every hypothesis agrees.
+struct MhtTrackNode {
+  Track trk;
+  uint32_t id = 0;
+  int scan = 0;            // scan that produced this node
+  int meas = -1;           // measurement of that scan, -1 = missed or born
   double last_maha2 = 0.0;
+  Vec2 innov = Vec2::Zero();
+  Mat2 S = Mat2::Zero();
+  std::shared_ptr<MhtTrackNode> parent;
 
-  // hit history for M-of-N
-  std::vector<uint8_t> hit_hist;
+  explicit MhtTrackNode(const Track& t) : trk(t) {}
+};
 
-  Track(uint32_t id_, const KalmanCV2D& model, const Vec2& z_init, int confirm_N);
-  int hits_in_window() const {
-    int s = 0;
-    for (uint8_t v : hit_hist) s += (v ? 1 : 0);
-    return s;
-  }
+struct MhtHypothesis {
+  double score = 0.0; // -log likelihood ratio, relative to the best hypothesis
+  std::vector<std::shared_ptr<MhtTrackNode>> tracks;
+};
+
+// Counters of the last MHT scan.
+struct MhtScanInfo {
+  int hypotheses = 0;          // kept after pruning
+  int unique_tracks = 0;       // distinct nodes predicted and gated
+  int clusters = 0;            // distinct k-best problems solved
+  int cluster_reuse = 0;       // clusters shared with an earlier hypothesis
+  uint64_t augmentations = 0;  // shortest augmenting paths (Murty)
+  int merged = 0;              // hypotheses identical to a better one
+  int n_scan_pruned = 0;       // hypotheses dropped by N-scan pruning
+  int nodes_created = 0;
 };
 
 struct AssocResult {
@@ -51,42 +197,343 @@ struct AssocResult {
   std::vector<int> meas_to_track; // size = meas
 };
 
+// Track ti, measurement mi inside the gate at squared Mahalanobis distance m2.
+struct GatedPair {
+  int ti;
+  int mi;
+  double m2;
+};
+
+// Scan steps that do not depend on the state model, shared by
+// MultiTargetTracker and TrackerND. The assign_* functions record each pair
+// in ar (reset to -1 by the caller) and its distance in info[ti].last_maha2.
+
+// Cheapest pairs first; sorts gated by m2.
+void assign_greedy(std::vector<GatedPair>& gated, AssocResult& ar, std::vector<TrackInfo>& info);
+// CSR cost graph of the gated pairs, T tracks x M measurements.
+void build_sparse_cost(const std::vector<GatedPair>& gated, int T, int M, SparseCost& g);
+// Applies a track -> measurement solution over g (clustered Hungarian, auction).
+void assign_sparse(const SparseCost& g, const std::vector<int>& assign, AssocResult& ar,
+                   std::vector<TrackInfo>& info);
+// Dense Hungarian over the T x M matrix, gated-out cells at a prohibitive
+// cost; pairs the solver puts on such cells are left unassigned.
+void assign_dense(const std::vector<GatedPair>& gated, int T, int M, std::vector<double>& cost,
+                  HungarianScratch& ws, std::vector<int>& assign, AssocResult& ar,
+                  std::vector<TrackInfo>& info);
+
+// Initiation: index of the closest candidate not yet used this scan within
+// gate_dist of z, or -1; ties go to the lowest (oldest) index. With grid,
+// built at scan start over the first two axes of the candidates with cells
+// of gate_dist, only its hits are searched; otherwise candidates
+// [0, num_indexed). Cand::z has the type of z.
+template <typename Cand, typename P>
+int nearest_candidate(const std::vector<Cand>& cands, const std::vector<char>& used, const P& z,
+                      double gate_dist, int num_indexed, const PointGrid* grid, std::vector<int>& hits) {
+  const double gate2 = gate_dist * gate_dist;
+  int best_ci = -1;
+  double best_d2 = std::numeric_limits<double>::infinity();
+  auto consider = [&](int ci) {
+    if (used[ci]) return;
+    const double d2 = (z - cands[ci].z).squaredNorm();
+    if (d2 <= gate2 && (d2 < best_d2 || (d2 == best_d2 && ci < best_ci))) {
+      best_d2 = d2;
+      best_ci = ci;
+    }
+  };
+
+  if (!grid) {
+    for (int ci = 0; ci < num_indexed; ++ci) consider(ci);
+    return best_ci;
+  }
+  const Vec2 p(z(0), z(1));
+  const Vec2 g(gate_dist, gate_dist);
+  hits.clear();
+  grid->query(p - g, p + g, hits);
+  for (int ci : hits) consider(ci);
+  return best_ci;
+}
+
 class MultiTargetTracker {
 public:
-  explicit MultiTargetTracker(TrackerConfig cfg) : cfg_(cfg) {}
+  explicit MultiTargetTracker(TrackerConfig cfg);
 
-  void step(const std::vector<Vec2>& measurements, double dt, double sigma_a, double sigma_z);
+  // Owns its worker pool (ThreadPool::run is not reentrant), so not copyable.
+  MultiTargetTracker(const MultiTargetTracker&) = delete;
+  MultiTargetTracker& operator=(const MultiTargetTracker&) = delete;
+
+  void step(MeasSpan measurements, double dt, double sigma_a, double sigma_z);
 
   const std::vector<Track>& tracks() const { return tracks_; }
+  const std::vector<TrackInfo>& track_info() const { return info_; }
   const std::vector<Vec2>& last_innovations() const { return last_innovs_; }
   const std::vector<Mat2>& last_S() const { return last_S_; }
 
+  // Gating + association against the current (predicted) tracks.
+  // step() calls this after predict; exposed for benchmarks.
+  // The result is reused storage, valid until the next call.
+  const AssocResult& associate(MeasSpan meas);
+
+  // Out-of-sequence scan, taken lag > 0 seconds before the tracks' current
+  // time, with noise sigma_z: bounded retrodiction. Tracks are gated at their
+  // retrodicted positions, matched (Hungarian) and updated in place through
+  // the state / old-measurement cross covariance. Lifecycle is untouched: no
+  // hits, misses or new tracks. Returns the number of tracks updated, or -1
+  // in MHT and IMM modes, which do not take late scans.
+  int update_oosm(MeasSpan meas, double lag, double sigma_z);
+
+  // Multi-sensor frames (SensorFusion): several scans share one lifecycle
+  // tick. update_scan() predicts, associates and updates the tracks with one
+  // scan and lets its unassigned measurements hit initiation candidates, but
+  // leaves hit windows, miss counts, ages and the track set alone. end_frame()
+  // then ticks once for every scan since the last tick: each track's hit
+  // window takes one slot, a hit if any scan of the frame hit it, and misses
+  // and age count frames; candidates take at most one hit per frame and age, promote,
+  // confirm and prune once. end_frame() with no open frame does nothing.
+  // update_scan() returns false (nothing done) in MHT mode, whose hypotheses
+  // step per scan. Do not mix with step() inside a frame.
+  bool update_scan(MeasSpan measurements, double dt, double sigma_a, double sigma_z);
+  void end_frame();
+
+  // step() for one scan of polar detections (range, azimuth, range rate)
+  // from the sensor of model: gated in measurement space, with the range-rate
+  // pre-gate, and updated by the model's EKF or UKF. Detections are
+  // converted to Cartesian once, for the gating grid and the candidate
+  // search; tracks start from polar_init(). Greedy, Hungarian and auction
+  // association with CV motion; returns false (nothing done) in other modes.
+  bool step_polar(const std::vector<PolarMeas>& meas, double dt, double sigma_a, const PolarModel& model);
+
+  // Number of track x measurement Mahalanobis tests in the last association.
+  uint64_t last_pairs_evaluated() const { return pairs_evaluated_; }
+
+  // Result of the last association (indices as of that association).
+  const AssocResult& last_association() const { return assoc_; }
+
+  // Bids placed by the last auction association (0 for other methods).
+  uint64_t last_auction_bids() const { return auction_bids_; }
+
+  // MHT mode: hypotheses after the last scan, best first (tracks() mirrors
+  // the best one), and that scan's counters.
+  const std::vector<MhtHypothesis>& hypotheses() const { return hyps_; }
+  const MhtScanInfo& last_mht() const { return mht_info_; }
+
+  // JPDA mode: cluster counters of the last association.
+  const JpdaInfo& last_jpda() const { return jpda_info_; }
+
+  // IMM mode: per-model states and mode probabilities, indexed like tracks().
+  const ImmBank& imm() const { return imm_; }
+
+  // Pending initiation candidates (unassigned detections not yet promoted).
+  size_t num_candidates() const { return cands_.size(); }
+
+  // Gate cache of the last association, indexed like tracks() at that time.
+  const std::vector<GateCacheEntry>& gate_cache() const { return gate_cache_; }
+
+  // Per-stage timings and per-scan counts accumulated since construction or
+  // reset_stats(). Always empty when built with RADAR_STATS=0.
+  const TrackerStats& stats() const;
+  void reset_stats();
+
+  // Checkpoint image (checkpoint.h) of everything the next scan reads:
+  // config, track states and hit windows, ids, auction prices, initiation
+  // candidates, square-root factors and the IMM bank. Scratch and stats are
+  // left out. A tracker restored with load_state() continues bit-identically
+  // to the one saved. save_state() returns false (nothing written) in MHT
+  // mode, whose hypothesis trees are not serialized. load_state() returns
+  // false, leaving the tracker unchanged, on a malformed image or one saved
+  // with a config other than this tracker's (num_threads aside, since output
+  // does not depend on it).
+  bool save_state(StateWriter& w) const;
+  bool load_state(StateReader& r);
+
 private:
+  // Where a gating chunk's pairs landed in its worker's buffer.
+  struct ChunkSpan {
+    int worker = 0;
+    size_t begin = 0;
+    size_t end = 0;
+    uint64_t pairs = 0;
+  };
+
   struct Candidate {
     Vec2 z = Vec2::Zero();
     int hits = 0;
     int age = 0;
+    int meas = -1; // measurement that last hit it, this scan only
+    double sigma_z = 0.0; // noise of that measurement, for the track's P
   };
 
+  static constexpr int kTrackGrain = 256; // tracks per chunk for per-track stages
+  static constexpr int kGateGrain = 64;   // tracks per gating chunk
+
   TrackerConfig cfg_;
   uint32_t next_id_ = 1;
 
+  std::unique_ptr<ThreadPool> pool_; // num_threads > 1 only
+
   std::vector<Track> tracks_;
+  std::vector<TrackInfo> info_;
+  ImmBank imm_; // motion == Imm only; tracks_[i].kf holds the combined estimate
+  std::vector<Mat4> sqrt_P_; // sqrt_form() only: per track, L with kf.P = L L^T
   std::vector<Vec2> last_innovs_;
   std::vector<Mat2> last_S_;
 
   // anti-clutter initiation candidates
   std::vector<Candidate> cands_;
 
-  double maha2_for(const Track& t, const Vec2& z, Mat2* out_S, Vec2* out_innov);
+  // gating scratch (reused across scans)
+  PointGrid meas_grid_;
+  std::vector<std::vector<int>> grid_hits_;        // per worker
+  std::vector<std::vector<GatedPair>> worker_gated_; // per worker
+  std::vector<ChunkSpan> chunk_spans_;               // per gating chunk
+  std::vector<GatedPair> gated_;
+  std::vector<GateCacheEntry> gate_cache_; // per track, from build_gate_cache()
+  std::vector<Mat4x2> oosm_cross_;         // per track, from build_oosm_gate_cache()
+  std::vector<PolarGate> polar_gate_;      // per track, from build_polar_gate_cache()
+  std::vector<Vec2> polar_pos_;            // per detection, Cartesian (step_polar)
+  const PolarMeas* polar_meas_ = nullptr;  // set during step_polar(): gating and initiation
+  const PolarModel* polar_model_ = nullptr;
+  SparseCost sparse_cost_;
+  uint64_t pairs_evaluated_ = 0;
+  uint64_t auction_bids_ = 0;
+
+  // association / initiation scratch: every per-scan buffer lives here and
+  // keeps its capacity, so a warm step() does not touch the allocator
+  AssocResult assoc_;
+  AssignWorkspace assign_ws_;
+  std::vector<int> assign_;
+  std::vector<double> dense_cost_;     // T x M, row-major (cluster_assignment off)
+  HungarianScratch dense_ws_;
+  std::vector<char> cand_used_;
+  std::vector<char> cand_frame_hit_; // per candidate: hit in the open frame
+  std::vector<char> frame_hit_;      // per track: hit in the open frame
+  bool frame_open_ = false;
+  double frame_dt_ = 0.0;      // of the frame's last scan, for promoted tracks
+  double frame_sigma_a_ = 0.0;
+  std::vector<Vec2> cand_pos_;  // candidate positions at scan start
+  PointGrid cand_grid_;         // index over cand_pos_
+  std::vector<int> cand_hits_;
+  std::vector<int> born_meas_;  // measurement of each track initiated this scan
+  std::vector<double> price_in_;   // per track, auction warm start
+  std::vector<double> price_out_;  // per track, auction result
+
+  // JPDA: likelihood ratio per sparse_cost_ edge, and the marginals
+  SparseCost jpda_g_;
+  std::vector<double> jpda_beta_;   // per sparse_cost_ edge
+  std::vector<double> jpda_beta0_;  // per track: no measurement is its own
+  std::vector<double> jpda_meas_beta_; // per measurement: highest beta so far
+  JpdaInfo jpda_info_;
 
-  AssocResult associate(const std::vector<Vec2>& meas);
-  AssocResult associate_greedy(const std::vector<Vec2>& meas);
-  AssocResult associate_hungarian(const std::vector<Vec2>& meas);
+  // MHT state and per-scan scratch (see mht.cpp)
+  struct MhtCluster {
+    std::vector<int> rows; // distinct-node indices, ascending
+    std::vector<int> cols; // measurement indices, ascending
+    KBestAssignment kbest;
+    double delta = 0.0;    // cost(1) - cost(0)
+  };
+  struct MhtCombo {
+    double score;
+    int hyp;
+    int pos;    // branching cluster changed last, -1 = all at their best
+    int idx;    // solution index at pos
+    int parent; // combo holding the indices below pos
+  };
+  std::vector<MhtHypothesis> hyps_;
+  std::vector<MhtHypothesis> next_hyps_;
+  MhtScanInfo mht_info_;
+  int scan_ = 0;
+  std::vector<std::shared_ptr<MhtTrackNode>> mht_nodes_; // distinct nodes = rows of tracks_
+  std::vector<std::vector<int>> mht_rows_;               // per hypothesis: node per track
+  std::vector<double> mht_m2_;                           // per sparse_cost_ edge
+  std::vector<double> mht_miss_;                         // per cluster row
+  std::vector<MhtCluster> mht_clusters_;                 // pool; first mht_num_clusters_ live
+  int mht_num_clusters_ = 0;
+  std::vector<std::vector<int>> mht_hyp_clusters_;       // per hypothesis, by delta
+  std::vector<int> mht_branching_;                       // per hypothesis: clusters with 2+ solutions
+  std::vector<double> mht_base_;                         // per hypothesis: cost with every cluster at its best
+  std::vector<MhtCombo> mht_combos_;
+  std::vector<int> mht_heap_;
+  std::vector<int> mht_selected_;
+  std::vector<int> mht_sol_idx_;
+  std::vector<int> mht_meas_of_;                         // per node, chosen measurement
+  std::vector<int> mht_sorted_, mht_tmp_rows_, mht_tmp_cols_;
+  std::unordered_map<const MhtTrackNode*, int> mht_node_index_;
+  std::unordered_multimap<uint64_t, int> mht_cluster_index_; // row-set hash -> cluster
+  std::unordered_map<uint64_t, std::shared_ptr<MhtTrackNode>> mht_children_; // (node, meas) -> child
+  SparseCost mht_sub_;
+  GateClusters mht_gc_;
 
-  void initiate_from_unassigned_candidates(const std::vector<Vec2>& meas,
+  TrackerStatsStore stats_;
+
+  // Few FMAs per pair: innovation against the cached center and S^-1.
+  static double maha2_for(const GateCacheEntry& g, const Vec2& z) {
+    return maha2(g.ic, Vec2(z(0) - g.center(0), z(1) - g.center(1)));
+  }
+
+  template <typename Fn>
+  void parallel_for(int n, int grain, Fn&& fn) {
+    if (pool_) pool_->parallel_for(n, grain, fn);
+    else if (n > 0) fn(0, n, 0);
+  }
+
+  void build_gate_cache();
+  // Gate cache at the positions retrodicted lag seconds back, and the cross
+  // covariance of each track's state with such a measurement (update_oosm).
+  void build_oosm_gate_cache(double lag, double sigma_z);
+  // associate() on the gate cache built for lag (0 = current time).
+  const AssocResult& associate_at(MeasSpan meas, double lag, double sigma_z);
+  // Gate cache of polar_model_: the measurement-space prediction in
+  // polar_gate_, and a Cartesian box holding each gate for the grid.
+  void build_polar_gate_cache();
+  void gate_range(MeasSpan meas, int begin, int end,
+                  std::vector<int>& hits, std::vector<GatedPair>& out, uint64_t& pairs) const;
+  // gate_range() with maha2_of(ti, mi) as the pair test against gate2; a
+  // negative result rejects the pair before it counts as a test.
+  template <typename Maha2>
+  void gate_range_with(MeasSpan meas, int begin, int end, double gate2, Maha2&& maha2_of,
+                       std::vector<int>& hits, std::vector<GatedPair>& out, uint64_t& pairs) const;
+
+  // Fills gated_ with every pair inside the gate, ordered by (ti, mi).
+  void gate(MeasSpan meas);
+  void associate_hungarian(MeasSpan meas);
+  void associate_auction(MeasSpan meas);
+  void associate_jpda(MeasSpan meas);
+  // Weighted update of track ti from all its gated measurements.
+  void update_jpda(int ti, MeasSpan meas);
+
+  // Matches the unassigned measurements of a scan to candidates (new ones
+  // for the rest). In a frame, hits are counted once per frame.
+  void match_candidates(MeasSpan meas, const AssocResult& ar, double sigma_z, bool frame);
+  // Ages the candidates not in hit, drops the stale and promotes the mature.
+  void promote_candidates(double dt, double sigma_a, const std::vector<char>& hit);
+  void initiate_from_unassigned_candidates(MeasSpan meas,
                                           const AssocResult& ar,
                                           double dt, double sigma_a, double sigma_z);
 
+  bool track_lost(const Track& t) const {
+    if (t.misses > cfg_.max_misses) return true;
+    const double limit = cfg_.max_pos_sigma * t.kf.sigma_z;
+    return cfg_.max_pos_sigma > 0.0 && t.kf.P(0,0) + t.kf.P(1,1) > 2.0 * limit * limit;
+  }
   void prune_and_confirm();
+  // Steps 4) and 5) of a scan: initiation from the unassigned measurements,
+  // then confirmation and pruning. With ar null (end_frame) the candidates
+  // were matched during the frame and only age and promote.
+  void finish_scan(MeasSpan meas, const AssocResult* ar, double dt, double sigma_a, double sigma_z);
+  // Step 3): updates the associated tracks; tick = slide hit windows and
+  // count misses (step), otherwise note hits in frame_hit_ (update_scan).
+  void update_assigned(MeasSpan meas, const AssocResult& ar, double sigma_z, bool tick);
+
+  // Square-root covariance carried per track in sqrt_P_ (see cov_update).
+  bool sqrt_form() const {
+    return cfg_.cov_update == CovUpdate::SquareRoot && cfg_.motion == MotionModel::Cv &&
+           cfg_.assoc != AssocMethod::Mht && cfg_.assoc != AssocMethod::Jpda;
+  }
+
+  // tick = age the tracks by one scan (step); frames age in end_frame().
+  void predict_all(double dt, double sigma_a, double sigma_z, bool tick);
+
+  // MHT step (mht.cpp): replaces associate / update / prune of step().
+  void step_mht(MeasSpan meas, double dt, double sigma_a, double sigma_z);
+  int mht_cluster(const std::vector<int>& rows, const std::vector<int>& cols);
+  void mht_n_scan_prune();
 };
\ No newline at end of file
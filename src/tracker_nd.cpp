@@ -0,0 +1,228 @@
+#include "tracker_nd.h"
+#include "scratch.h"
+#include <algorithm>
+#include <cmath>
+
+template <typename Model>
+TrackerND<Model>::TrackerND(TrackerConfig cfg) : cfg_(cfg), ok_(supports(cfg)) {
+  cfg_.confirm_N = std::min(std::max(cfg_.confirm_N, 1), 64);
+}
+
+template <typename Model>
+bool TrackerND<Model>::supports(const TrackerConfig& cfg) {
+  return (cfg.assoc == AssocMethod::Greedy || cfg.assoc == AssocMethod::Hungarian) &&
+         cfg.motion == MotionModel::Cv && cfg.cov_update != CovUpdate::SquareRoot;
+}
+
+template <typename Model>
+void TrackerND<Model>::build_gate_cache() {
+  scratch_resize(gate_cache_, tracks_.size());
+  for (size_t ti = 0; ti < tracks_.size(); ++ti) {
+    const Filter& kf = tracks_[ti].kf;
+    GateEntryN<M>& g = gate_cache_[ti];
+    g.ic = kf.innovation_cov();
+    for (int a = 0; a < M; ++a) {
+      // Same widening as MultiTargetTracker: boundary pairs survive rounding.
+      g.center(a) = kf.x(a);
+      g.half(a) = std::sqrt(cfg_.gate_maha2 * g.ic.S(a,a)) * (1.0 + 1e-9) + 1e-9;
+    }
+  }
+}
+
+template <typename Model>
+void TrackerND<Model>::gate(const std::vector<Meas>& meas) {
+  gated_.clear();
+  pairs_evaluated_ = 0;
+
+  const int T = (int)tracks_.size();
+  const int Mn = (int)meas.size();
+  if (T == 0 || Mn == 0) return;
+
+  auto test = [&](int ti, int mi) {
+    const GateEntryN<M>& g = gate_cache_[ti];
+    const double m2 = maha2(g.ic, Meas(meas[mi] - g.center));
+    pairs_evaluated_++;
+    if (m2 <= cfg_.gate_maha2) gated_.push_back({ti, mi, m2});
+  };
+
+  if (!cfg_.use_gating_grid) {
+    for (int ti = 0; ti < T; ++ti) for (int mi = 0; mi < Mn; ++mi) test(ti, mi);
+    return;
+  }
+
+  scratch_resize(meas_xy_, meas.size());
+  for (size_t mi = 0; mi < meas.size(); ++mi) meas_xy_[mi] = xy(meas[mi]);
+  double cell = cfg_.grid_cell_size;
+  if (!(cell > 0.0)) {
+    // Auto: about one gate width per cell, as in MultiTargetTracker.
+    double sum = 0.0;
+    for (const auto& g : gate_cache_) sum += g.half(0) + g.half(1);
+    cell = sum / (double)T;
+  }
+  meas_grid_.build(meas_xy_, cell);
+
+  for (int ti = 0; ti < T; ++ti) {
+    const GateEntryN<M>& g = gate_cache_[ti];
+    const Vec2 c = xy(g.center);
+    const Vec2 h = xy(g.half);
+    grid_hits_.clear();
+    meas_grid_.query(c - h, c + h, grid_hits_);
+    std::sort(grid_hits_.begin(), grid_hits_.end());
+
+    for (int mi : grid_hits_) {
+      bool inside = true;
+      for (int a = 0; a < M; ++a) inside = inside && std::abs(meas[mi](a) - g.center(a)) <= g.half(a);
+      if (inside) test(ti, mi);
+    }
+  }
+}
+
+template <typename Model>
+void TrackerND<Model>::associate(const std::vector<Meas>& meas) {
+  const int T = (int)tracks_.size();
+  const int Mn = (int)meas.size();
+  scratch_assign(assoc_.track_to_meas, tracks_.size(), -1);
+  scratch_assign(assoc_.meas_to_track, meas.size(), -1);
+  build_gate_cache();
+  gate(meas);
+  if (T == 0 || Mn == 0) return;
+
+  if (cfg_.assoc == AssocMethod::Greedy) {
+    assign_greedy(gated_, assoc_, info_);
+  } else if (cfg_.cluster_assignment) {
+    build_sparse_cost(gated_, T, Mn, sparse_cost_);
+    clustered_min_cost(sparse_cost_, assign_ws_, assign_);
+    assign_sparse(sparse_cost_, assign_, assoc_, info_);
+  } else {
+    assign_dense(gated_, T, Mn, dense_cost_, dense_ws_, assign_, assoc_, info_);
+  }
+}
+
+template <typename Model>
+void TrackerND<Model>::initiate(const std::vector<Meas>& meas, double dt, double sigma_a, double sigma_z) {
+  // Candidates made this scan are never searched.
+  const int num_indexed = (int)cands_.size();
+  scratch_assign(cand_used_, cands_.size(), 0);
+  if (cfg_.use_init_grid) {
+    scratch_resize(cand_xy_, cands_.size());
+    for (size_t ci = 0; ci < cands_.size(); ++ci) cand_xy_[ci] = xy(cands_[ci].z);
+    cand_grid_.build(cand_xy_, cfg_.init_gate_dist);
+  }
+
+  for (int mi = 0; mi < (int)meas.size(); ++mi) {
+    if (assoc_.meas_to_track[mi] != -1) continue;
+    const Meas& z = meas[mi];
+    const int best_ci = nearest_candidate(cands_, cand_used_, z, cfg_.init_gate_dist, num_indexed,
+                                          cfg_.use_init_grid ? &cand_grid_ : nullptr, cand_hits_);
+
+    if (best_ci != -1) {
+      cand_used_[best_ci] = 1;
+      cands_[best_ci].z = z;
+      cands_[best_ci].hits += 1;
+      cands_[best_ci].age = 0;
+    } else {
+      Candidate c;
+      c.z = z;
+      c.hits = 1;
+      cands_.push_back(c);
+      cand_used_.push_back(1);
+    }
+  }
+
+  const double var_d[3] = {sigma_z * sigma_z, cfg_.init_vel_sigma * cfg_.init_vel_sigma,
+                           cfg_.init_acc_sigma * cfg_.init_acc_sigma};
+  size_t w = 0;
+  for (size_t ci = 0; ci < cands_.size(); ++ci) {
+    Candidate c = cands_[ci];
+    if (!cand_used_[ci]) c.age += 1;
+    if (c.age > cfg_.init_max_age) continue;
+
+    if (c.hits >= cfg_.init_required_hits) {
+      Track t;
+      t.kf = Filter(dt, sigma_a, sigma_z);
+      t.kf.x.setZero();
+      t.kf.x.template head<M>() = c.z;
+      t.kf.P.setZero();
+      for (int i = 0; i < Filter::N; ++i) t.kf.P(i,i) = var_d[i / M];
+      t.age = 1;
+
+      t.hits.seed(c.hits, cfg_.confirm_N);
+      t.confirmed = (t.hits_in_window() >= cfg_.confirm_M);
+      tracks_.push_back(t);
+      TrackInfo info;
+      info.id = next_id_++;
+      info_.push_back(info);
+    } else {
+      cands_[w++] = c;
+    }
+  }
+  cands_.resize(w);
+}
+
+template <typename Model>
+bool TrackerND<Model>::track_lost(const Track& t) const {
+  if (t.misses > cfg_.max_misses) return true;
+  if (!(cfg_.max_pos_sigma > 0.0)) return false;
+  const double limit = cfg_.max_pos_sigma * t.kf.sigma_z;
+  double trace = 0.0;
+  for (int a = 0; a < M; ++a) trace += t.kf.P(a,a);
+  return trace > M * limit * limit;
+}
+
+template <typename Model>
+void TrackerND<Model>::prune_and_confirm() {
+  size_t w = 0;
+  for (size_t r = 0; r < tracks_.size(); ++r) {
+    tracks_[r].confirmed = (tracks_[r].hits_in_window() >= cfg_.confirm_M);
+    if (track_lost(tracks_[r])) continue;
+    if (w != r) {
+      tracks_[w] = tracks_[r];
+      info_[w] = info_[r];
+    }
+    ++w;
+  }
+  tracks_.resize(w);
+  info_.resize(w);
+}
+
+template <typename Model>
+bool TrackerND<Model>::step(const std::vector<Meas>& meas, double dt, double sigma_a, double sigma_z) {
+  if (!ok_) return false;
+
+  // 1) predict all
+  for (size_t ti = 0; ti < tracks_.size(); ++ti) {
+    Track& t = tracks_[ti];
+    t.kf.dt = dt;
+    t.kf.sigma_a = sigma_a;
+    t.kf.sigma_z = sigma_z;
+    t.kf.predict();
+    t.age += 1;
+    info_[ti].last_maha2 = 0.0;
+  }
+
+  // 2) gate cache + association
+  associate(meas);
+
+  // 3) update associated tracks
+  for (size_t ti = 0; ti < tracks_.size(); ++ti) {
+    Track& t = tracks_[ti];
+    const int mi = assoc_.track_to_meas[ti];
+    t.hits.push(mi != -1, cfg_.confirm_N);
+    if (mi == -1) {
+      t.misses += 1;
+      continue;
+    }
+    t.kf.update_pos(meas[(size_t)mi], gate_cache_[ti].ic, cfg_.cov_update);
+    t.misses = 0;
+  }
+
+  // 4) initiate via candidates, 5) confirm + prune
+  initiate(meas, dt, sigma_a, sigma_z);
+  prune_and_confirm();
+  return true;
+}
+
+template class TrackerND<CV2>;
+template class TrackerND<CV3>;
+template class TrackerND<CA2>;
+template class TrackerND<CA3>;
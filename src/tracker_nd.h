@@ -0,0 +1,110 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include "kalman_nd.h"
+#include "tracker.h"
+
+// Per-track gating data of TrackerND: GateCacheEntry for M axes.
+template <int M>
+struct GateEntryN {
+  InnovCovN<M> ic;
+  VecN<M> center = VecN<M>::Zero(); // predicted position
+  VecN<M> half = VecN<M>::Zero();   // half extents of the gate ellipsoid's bounding box
+};
+
+template <typename Model>
+struct TrackND {
+  KalmanND<Model> kf;
+
+  int age = 0;
+  int misses = 0;
+
+  HitWindow hits;
+  bool confirmed = false;
+
+  int hits_in_window() const { return hits.count(); }
+};
+
+// MultiTargetTracker's scan for any KinematicModel (3D CV / CA for air
+// targets): predict, gate, greedy or Hungarian association, update,
+// candidate initiation, M-of-N confirmation and pruning, driven by the same
+// TrackerConfig. gate_maha2 is a chi-square threshold with M dof (11.34 at
+// 99% in 3D). The gating grid indexes measurements by their first two axes
+// and box-tests every axis before the Mahalanobis test.
+//
+// Serial. Association, the assignment solvers and candidate matching are
+// the shared scan steps of tracker.h, so they are MultiTargetTracker's own
+// code. Auction, MHT, JPDA, IMM, the square-root form, polar detections and
+// late scans stay with MultiTargetTracker, whose 2D CV kernels are
+// hand-scheduled; a config asking for one of them is rejected (ok() false,
+// step() returns false and does nothing). Instantiated in tracker_nd.cpp for
+// CV2, CV3, CA2 and CA3.
+template <typename Model>
+class TrackerND {
+public:
+  static constexpr int M = Model::M;
+  static_assert(M >= 2, "the gating grid indexes the first two axes");
+  using Filter = KalmanND<Model>;
+  using Meas = VecN<M>;
+  using Track = TrackND<Model>;
+
+  explicit TrackerND(TrackerConfig cfg);
+
+  // Greedy or Hungarian association, CV motion, any covariance form but
+  // SquareRoot.
+  static bool supports(const TrackerConfig& cfg);
+  bool ok() const { return ok_; }
+
+  bool step(const std::vector<Meas>& meas, double dt, double sigma_a, double sigma_z);
+
+  const std::vector<Track>& tracks() const { return tracks_; }
+  const std::vector<TrackInfo>& track_info() const { return info_; }
+  const AssocResult& last_association() const { return assoc_; }
+  uint64_t last_pairs_evaluated() const { return pairs_evaluated_; }
+  size_t num_candidates() const { return cands_.size(); }
+
+private:
+  struct Candidate {
+    Meas z = Meas::Zero();
+    int hits = 0;
+    int age = 0;
+  };
+
+  TrackerConfig cfg_;
+  bool ok_ = false;
+  uint32_t next_id_ = 1;
+
+  std::vector<Track> tracks_;
+  std::vector<TrackInfo> info_;
+  std::vector<Candidate> cands_;
+
+  // per-scan scratch, kept across scans
+  std::vector<GateEntryN<M>> gate_cache_;
+  std::vector<Vec2> meas_xy_; // first two axes of each measurement
+  PointGrid meas_grid_;
+  std::vector<int> grid_hits_;
+  std::vector<GatedPair> gated_;
+  uint64_t pairs_evaluated_ = 0;
+  AssocResult assoc_;
+  SparseCost sparse_cost_;
+  AssignWorkspace assign_ws_;
+  std::vector<int> assign_;
+  std::vector<double> dense_cost_;
+  HungarianScratch dense_ws_;
+  std::vector<char> cand_used_;
+  std::vector<Vec2> cand_xy_;
+  PointGrid cand_grid_;
+  std::vector<int> cand_hits_;
+
+  static Vec2 xy(const Meas& p) { return Vec2(p(0), p(1)); }
+
+  void build_gate_cache();
+  void gate(const std::vector<Meas>& meas);
+  void associate(const std::vector<Meas>& meas);
+  void initiate(const std::vector<Meas>& meas, double dt, double sigma_a, double sigma_z);
+  bool track_lost(const Track& t) const;
+  void prune_and_confirm();
+};
+
+using TrackerCV3D = TrackerND<CV3>;
+using TrackerCA3D = TrackerND<CA3>;
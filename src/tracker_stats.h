@@ -0,0 +1,88 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include "latency_hist.h"
+
+// Per-stage instrumentation of MultiTargetTracker::step, switched at compile
+// time (CMake option RADAR_STATS). With RADAR_STATS=0 the tracker holds an
+// empty TrackerStatsStore and the hooks below (StatsClock::lap, record) are
+// empty inline functions, so nothing is measured or stored.
+#ifndef RADAR_STATS
+#define RADAR_STATS 0
+#endif
+
+enum class TrackerStage : int {
+  Predict,  // KF predict of all tracks
+  Gating,   // gate cache, grid build and Mahalanobis tests
+  Assign,   // assignment over the gated pairs (MHT: k-best and hypothesis selection; JPDA: marginals)
+  Update,   // KF update and hit windows (MHT: child track nodes)
+  Initiate, // candidate matching and promotion
+  Prune,    // confirmation and track removal
+  Retrodict, // out-of-sequence scans: retrodicted gating, assignment and update
+  Step,     // whole step()
+  Count
+};
+
+inline const char* stage_name(TrackerStage s) {
+  switch (s) {
+    case TrackerStage::Predict: return "predict";
+    case TrackerStage::Gating: return "gating";
+    case TrackerStage::Assign: return "assign";
+    case TrackerStage::Update: return "update";
+    case TrackerStage::Initiate: return "initiate";
+    case TrackerStage::Prune: return "prune";
+    case TrackerStage::Retrodict: return "retrodict";
+    case TrackerStage::Step: return "step";
+    default: return "?";
+  }
+}
+
+// Stage histograms hold nanoseconds; the count histograms reuse the same
+// log-linear buckets for plain values.
+struct TrackerStats {
+  static constexpr int kStages = (int)TrackerStage::Count;
+  static constexpr bool kEnabled = RADAR_STATS != 0;
+
+  std::array<LatencyHistogram, kStages> stage_ns;
+  LatencyHistogram pairs;        // Mahalanobis tests per scan
+  LatencyHistogram gated;        // pairs inside the gate per scan
+  LatencyHistogram cluster_rows; // tracks per assignment cluster (clustered Hungarian)
+  LatencyHistogram candidates;   // initiation candidates alive after each scan
+  LatencyHistogram tracks;       // tracks after each scan
+
+  const LatencyHistogram& stage(TrackerStage s) const { return stage_ns[(int)s]; }
+  void clear() { *this = TrackerStats{}; }
+};
+
+#if RADAR_STATS
+// What the tracker records into: the stats themselves.
+using TrackerStatsStore = TrackerStats;
+
+// Stage stopwatch: lap() records the time since the previous lap.
+struct StatsClock {
+  using clock = std::chrono::steady_clock;
+  clock::time_point t = clock::now();
+
+  void restart() { t = clock::now(); }
+  void lap(TrackerStatsStore& s, TrackerStage stage) {
+    const clock::time_point now = clock::now();
+    s.stage_ns[(int)stage].record((uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(now - t).count());
+    t = now;
+  }
+};
+#else
+// Same hooks as above, all empty: no clock reads, no counters.
+struct NullHistogram {
+  void record(uint64_t) {}
+};
+
+struct TrackerStatsStore {
+  NullHistogram pairs, gated, cluster_rows, candidates, tracks;
+};
+
+struct StatsClock {
+  void restart() {}
+  void lap(TrackerStatsStore&, TrackerStage) {}
+};
+#endif
@@ -0,0 +1,120 @@
+#!/usr/bin/env python3
+"""Reader / converter for the binary columnar logs (--log_format bin).
+
+    import binlog
+    cols = binlog.read_table("out/tracks.bin")   # dict: column name -> numpy array
+
+    python tools/binlog.py --in out              # writes out/*.csv next to out/*.bin
+
+Raw blocks (--log_compress 0) are returned as zero-copy views into a
+numpy memmap of the file when the file holds a single block.
+"""
+import argparse
+import csv
+import os
+
+import numpy as np
+
+MAGIC = b"RTBLOG1\0"
+DTYPES = {0: np.dtype("<i4"), 1: np.dtype("<u4"), 2: np.dtype("<f8"), 3: np.dtype("u1")}
+TABLES = ("truth", "meas", "tracks", "residuals")
+
+
+def _pad8(n):
+    return (n + 7) & ~7
+
+
+def _decode(payload, n, dt):
+    # Inverse of codec 1: zero suppression -> byte shuffle -> delta / XOR.
+    w = dt.itemsize
+    length = n * w
+    nbm = (length + 7) // 8
+    mask = np.unpackbits(payload[:nbm])[:length].astype(bool)
+    shuffled = np.zeros(length, dtype=np.uint8)
+    shuffled[mask] = payload[nbm:nbm + int(mask.sum())]
+    raw = np.ascontiguousarray(shuffled.reshape(w, n).T)
+    if dt.kind == "f":
+        bits = np.bitwise_xor.accumulate(raw.view("<u8").ravel())
+        return bits.view(dt)
+    udt = np.dtype("<u%d" % w) if w > 1 else np.dtype("u1")
+    return np.cumsum(raw.view(udt).ravel(), dtype=udt).view(dt)
+
+
+def read_table(path):
+    buf = np.memmap(path, dtype=np.uint8, mode="r")
+    if bytes(buf[:8]) != MAGIC:
+        raise ValueError(f"{path}: not a binary log")
+    ncols = int(buf[8:12].view("<u4")[0])
+    pos = 12
+    names, dtypes = [], []
+    for _ in range(ncols):
+        t, ln = int(buf[pos]), int(buf[pos + 1])
+        names.append(bytes(buf[pos + 2:pos + 2 + ln]).decode())
+        dtypes.append(DTYPES[t])
+        pos += 2 + ln
+    pos = _pad8(pos)
+
+    parts = [[] for _ in range(ncols)]
+    while pos < len(buf):
+        n, codec = (int(v) for v in buf[pos:pos + 8].view("<u4"))
+        pos += 8
+        for c in range(ncols):
+            nbytes = int(buf[pos:pos + 4].view("<u4")[0])
+            payload = buf[pos + 8:pos + 8 + nbytes]
+            if codec == 0:
+                parts[c].append(payload.view(dtypes[c]))
+            else:
+                parts[c].append(_decode(payload, n, dtypes[c]))
+            pos += 8 + _pad8(nbytes)
+
+    out = {}
+    for c, name in enumerate(names):
+        if not parts[c]:
+            out[name] = np.zeros(0, dtype=dtypes[c])
+        elif len(parts[c]) == 1:
+            out[name] = parts[c][0]
+        else:
+            out[name] = np.concatenate(parts[c])
+    return out
+
+
+def iter_rows(indir, table):
+    """Rows of <table>.csv, or of <table>.bin if there is no CSV, as dicts of strings."""
+    csv_path = os.path.join(indir, table + ".csv")
+    if os.path.isfile(csv_path):
+        with open(csv_path, "r", newline="") as f:
+            yield from csv.DictReader(f)
+        return
+    bin_path = os.path.join(indir, table + ".bin")
+    if not os.path.isfile(bin_path):
+        raise SystemExit(f"Missing: {csv_path} (or {bin_path})")
+    cols = read_table(bin_path)
+    names = list(cols.keys())
+    for values in zip(*(cols[k].tolist() for k in names)):
+        yield {k: repr(v) for k, v in zip(names, values)}
+
+
+def convert(indir):
+    for table in TABLES:
+        bin_path = os.path.join(indir, table + ".bin")
+        if not os.path.isfile(bin_path):
+            continue
+        cols = read_table(bin_path)
+        names = list(cols.keys())
+        csv_path = os.path.join(indir, table + ".csv")
+        with open(csv_path, "w", newline="") as f:
+            f.write(",".join(names) + "\n")
+            for values in zip(*(cols[k].tolist() for k in names)):
+                f.write(",".join(repr(v) for v in values) + "\n")
+        print(f"Wrote: {csv_path}")
+
+
+def main():
+    ap = argparse.ArgumentParser()
+    ap.add_argument("--in", dest="indir", required=True, help="Run output directory containing *.bin logs")
+    args = ap.parse_args()
+    convert(args.indir)
+
+
+if __name__ == "__main__":
+    main()
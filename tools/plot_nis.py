@@ -1,12 +1,13 @@
 #!/usr/bin/env python3
 import argparse
-import csv
 import os
 from collections import defaultdict
 
 import numpy as np
 import matplotlib.pyplot as plt
 
+from binlog import iter_rows
+
 
 def nis_2d(innov_x, innov_y, S00, S01, S10, S11):
     # NIS = v^T S^{-1} v, with v = [innov_x, innov_y]
@@ -24,25 +25,23 @@ def nis_2d(innov_x, innov_y, S00, S01, S10, S11):
     return v0 * (inv00 * v0 + inv01 * v1) + v1 * (inv10 * v0 + inv11 * v1)
 
 
-def read_residuals(path):
-    # residuals.csv: step,track_id,innov_x,innov_y,S00,S01,S10,S11
+def read_residuals(indir):
+    # residuals.csv (or residuals.bin): step,track_id,innov_x,innov_y,S00,S01,S10,S11
     by_track = defaultdict(list)
-    with open(path, "r", newline="") as f:
-        r = csv.DictReader(f)
-        for row in r:
-            step = int(row["step"])
-            tid = int(row["track_id"])
-            ix = float(row["innov_x"])
-            iy = float(row["innov_y"])
-            S00 = float(row["S00"])
-            S01 = float(row["S01"])
-            S10 = float(row["S10"])
-            S11 = float(row["S11"])
-            nis = nis_2d(ix, iy, S00, S01, S10, S11)
-            # ignore rows with zero S (uninitialized) or nan
-            if not np.isfinite(nis):
-                continue
-            by_track[tid].append((step, nis))
+    for row in iter_rows(indir, "residuals"):
+        step = int(row["step"])
+        tid = int(row["track_id"])
+        ix = float(row["innov_x"])
+        iy = float(row["innov_y"])
+        S00 = float(row["S00"])
+        S01 = float(row["S01"])
+        S10 = float(row["S10"])
+        S11 = float(row["S11"])
+        nis = nis_2d(ix, iy, S00, S01, S10, S11)
+        # ignore rows with zero S (uninitialized) or nan
+        if not np.isfinite(nis):
+            continue
+        by_track[tid].append((step, nis))
     for tid in list(by_track.keys()):
         by_track[tid].sort(key=lambda t: t[0])
     return by_track
@@ -50,17 +49,13 @@ def read_residuals(path):
 
 def main():
     ap = argparse.ArgumentParser()
-    ap.add_argument("--in", dest="indir", required=True, help="Run output directory containing residuals.csv")
+    ap.add_argument("--in", dest="indir", required=True, help="Run output directory containing residuals.csv or residuals.bin")
     ap.add_argument("--out", dest="outpath", default=None, help="Output PNG path (default: plots/nis_<indir>.png)")
     ap.add_argument("--title", dest="title", default=None, help="Plot title override")
     args = ap.parse_args()
 
     indir = args.indir
-    resid_path = os.path.join(indir, "residuals.csv")
-    if not os.path.isfile(resid_path):
-        raise SystemExit(f"Missing: {resid_path}")
-
-    by_track = read_residuals(resid_path)
+    by_track = read_residuals(indir)
 
     base = os.path.basename(os.path.normpath(indir))
     outpath = args.outpath or os.path.join("plots", f"nis_{base}.png")
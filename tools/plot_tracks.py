@@ -1,45 +1,42 @@
 #!/usr/bin/env python3
 import argparse
-import csv
 import os
 from collections import defaultdict
 
 import numpy as np
 import matplotlib.pyplot as plt
 
+from binlog import iter_rows
 
-def read_truth(path):
-    # truth.csv: step,true_id,x,y,vx,vy
+
+def read_truth(indir):
+    # truth.csv (or truth.bin): step,true_id,x,y,vx,vy
     by_id = defaultdict(list)
-    with open(path, "r", newline="") as f:
-        r = csv.DictReader(f)
-        for row in r:
-            tid = int(row["true_id"])
-            step = int(row["step"])
-            x = float(row["x"])
-            y = float(row["y"])
-            by_id[tid].append((step, x, y))
+    for row in iter_rows(indir, "truth"):
+        tid = int(row["true_id"])
+        step = int(row["step"])
+        x = float(row["x"])
+        y = float(row["y"])
+        by_id[tid].append((step, x, y))
     # sort by step
     for tid in list(by_id.keys()):
         by_id[tid].sort(key=lambda t: t[0])
     return by_id
 
 
-def read_tracks(path):
-    # tracks.csv header:
+def read_tracks(indir):
+    # tracks.csv (or tracks.bin) header:
     # step,track_id,confirmed,x,y,vx,vy,misses,maha2,hits_window
     by_id = defaultdict(list)
-    with open(path, "r", newline="") as f:
-        r = csv.DictReader(f)
-        for row in r:
-            tid = int(row["track_id"])
-            step = int(row["step"])
-            x = float(row["x"])
-            y = float(row["y"])
-            confirmed = int(row["confirmed"])
-            misses = int(row["misses"])
-            maha2 = float(row["maha2"])
-            by_id[tid].append((step, x, y, confirmed, misses, maha2))
+    for row in iter_rows(indir, "tracks"):
+        tid = int(row["track_id"])
+        step = int(row["step"])
+        x = float(row["x"])
+        y = float(row["y"])
+        confirmed = int(row["confirmed"])
+        misses = int(row["misses"])
+        maha2 = float(row["maha2"])
+        by_id[tid].append((step, x, y, confirmed, misses, maha2))
     for tid in list(by_id.keys()):
         by_id[tid].sort(key=lambda t: t[0])
     return by_id
@@ -47,22 +44,14 @@ def read_tracks(path):
 
 def main():
     ap = argparse.ArgumentParser()
-    ap.add_argument("--in", dest="indir", required=True, help="Run output directory containing truth.csv and tracks.csv")
+    ap.add_argument("--in", dest="indir", required=True, help="Run output directory containing truth/tracks logs (.csv or .bin)")
     ap.add_argument("--out", dest="outpath", default=None, help="Output PNG path (default: plots/tracks_<indir>.png)")
     ap.add_argument("--title", dest="title", default=None, help="Plot title override")
     args = ap.parse_args()
 
     indir = args.indir
-    truth_path = os.path.join(indir, "truth.csv")
-    tracks_path = os.path.join(indir, "tracks.csv")
-
-    if not os.path.isfile(truth_path):
-        raise SystemExit(f"Missing: {truth_path}")
-    if not os.path.isfile(tracks_path):
-        raise SystemExit(f"Missing: {tracks_path}")
-
-    truth = read_truth(truth_path)
-    tracks = read_tracks(tracks_path)
+    truth = read_truth(indir)
+    tracks = read_tracks(indir)
 
     # Choose output name
     base = os.path.basename(os.path.normpath(indir))